@@ -3,9 +3,22 @@
 // Input structs for vertex and pixel shader
 struct VS_INPUT
 {
+#ifdef QUANTIZED_VERTICES
+	// See VertexQuantization.h
+	float4 mPos : POSITION;
+	float2 mNormal : NORMAL0;
+#else
 	float3 mPos : POSITION;
 	float3 mNormal : NORMAL0;
+#endif
 	float2 mTex : TEXCOORD0;
+#ifdef INSTANCED
+	// Rows of the instance's world transform
+	float4 mWorld0 : WORLD0;
+	float4 mWorld1 : WORLD1;
+	float4 mWorld2 : WORLD2;
+	float4 mWorld3 : WORLD3;
+#endif
 };
 
 struct PS_INPUT
@@ -21,8 +34,22 @@ PS_INPUT VS(VS_INPUT input)
 {
 	PS_INPUT output;
 
+#ifdef QUANTIZED_VERTICES
+	float3 inPos = DequantizePosition(input.mPos.xyz);
+	float3 inNormal = DecodeOctahedral(input.mNormal);
+#else
+	float3 inPos = input.mPos;
+	float3 inNormal = input.mNormal;
+#endif
+
+#ifdef INSTANCED
+	float4x4 worldTransform = float4x4(input.mWorld0, input.mWorld1, input.mWorld2, input.mWorld3);
+#else
+	float4x4 worldTransform = mWorldTransform;
+#endif
+
 	// outPos = inPos * worldTransform * viewProjection
-	output.mPos = mul(mul(float4(input.mPos, 1.0f), mWorldTransform), mViewProjection);
+	output.mPos = mul(mul(float4(inPos, 1.0f), worldTransform), mViewProjection);
 
 	output.mTex = input.mTex;
 
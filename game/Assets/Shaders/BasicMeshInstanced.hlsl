@@ -0,0 +1,3 @@
+// Reads world transforms from the per-instance vertex buffer
+#define INSTANCED
+#include "BasicMesh.hlsl"
@@ -0,0 +1,3 @@
+// Reads the quantized vertex format from VertexQuantization.h
+#define QUANTIZED_VERTICES
+#include "BasicMesh.hlsl"
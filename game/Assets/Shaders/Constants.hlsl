@@ -1,17 +1,6 @@
 // We want to use row major matrices
 #pragma pack_matrix(row_major)
 
-struct PointLightData
-{
-	float3 mDiffuseColor;
-	float3 mSpecularColor;
-	float3 mPosition;
-	float mSpecularPower;
-	float mInnerRadius;
-	float mOuterRadius;
-	bool mEnabled;
-};
-
 // Per-camera constants
 cbuffer PerCameraConstants : register(b0)
 {
@@ -23,17 +12,89 @@ cbuffer PerCameraConstants : register(b0)
 cbuffer PerObjectConstants : register(b1)
 {
 	float4x4 mWorldTransform;
+	float3 mPositionScale;
+	float3 mPositionOffset;
 }
 
 // Lighting constants
+// The lights are split into clusters, see LightClusters.h
 cbuffer LightingConstants : register(b2)
 {
-	PointLightData mPointLights[8];
 	float3 mAmbientLight;
+	uint mTileSize;
+	uint mNumTilesX;
+	uint mNumTilesY;
+	uint mNumSlices;
+	float mSliceScale;
+	float mSliceBias;
+}
+
+// Turns a quantized (unorm) position back into model space
+float3 DequantizePosition(float3 pos)
+{
+	return pos * mPositionScale + mPositionOffset;
+}
+
+// Turns an octahedral encoded normal back into a unit vector
+float3 DecodeOctahedral(float2 encoded)
+{
+	float3 n = float3(encoded.x, encoded.y, 1.0f - abs(encoded.x) - abs(encoded.y));
+	if (n.z < 0.0f)
+	{
+		n.xy = (1.0f - abs(n.yx)) * (n.xy >= 0.0f ? 1.0f : -1.0f);
+	}
+	return normalize(n);
 }
 
 // For sampling the texture
 SamplerState DefaultSampler : register(s0);
 
 // Texture
-Texture2D DiffuseTexture : register(t0);
\ No newline at end of file
+Texture2D DiffuseTexture : register(t0);
+
+// Point lights, 4 float4s each (laid out like PointLightData.h)
+Buffer<float4> PointLights : register(t1);
+// For each cluster, where its lights start in LightIndices and how many there are
+Buffer<uint2> LightClusters : register(t2);
+Buffer<uint> LightIndices : register(t3);
+
+// Diffuse and specular light from the point lights in this pixel's cluster
+// pixelPos is SV_POSITION.xy, and viewDepth is the view space z
+float3 ComputePointLighting(float2 pixelPos, float viewDepth, float3 worldPos, float3 worldNormal)
+{
+	uint x = min(uint(pixelPos.x) / mTileSize, mNumTilesX - 1);
+	uint y = min(uint(pixelPos.y) / mTileSize, mNumTilesY - 1);
+	int slice = clamp(int(log(max(viewDepth, 0.0001f)) * mSliceScale + mSliceBias), 0, int(mNumSlices) - 1);
+	uint2 cluster = LightClusters[(slice * mNumTilesY + y) * mNumTilesX + x];
+
+	float3 V = normalize(mWorldCameraPosition - worldPos);
+	float3 light = float3(0.0f, 0.0f, 0.0f);
+	for (uint i = 0; i < cluster.y; i++)
+	{
+		uint index = LightIndices[cluster.x + i] * 4;
+		float3 diffuseColor = PointLights[index].xyz;
+		float3 specularColor = PointLights[index + 1].xyz;
+		float3 position = PointLights[index + 2].xyz;
+		float specularPower = PointLights[index + 2].w;
+		float2 radii = PointLights[index + 3].xy;
+
+		// Compute the normalized L and R vectors.
+		float3 L = normalize(position - worldPos);
+		float3 R = reflect(-L, worldNormal);
+
+		// if (N dot L) > 0, light should affect this pixel
+		float NdotL = dot(worldNormal, L);
+		if (NdotL > 0)
+		{
+			// Smooth falloff
+			float falloff = lerp(1.0f, 0.0f, smoothstep(radii.x, radii.y, distance(position, worldPos)));
+
+			// Diffuse light
+			light += diffuseColor * (NdotL * falloff);
+
+			// Specular light
+			light += specularColor * (pow(max(0.0f, dot(R, V)), specularPower) * falloff);
+		}
+	}
+	return light;
+}
\ No newline at end of file
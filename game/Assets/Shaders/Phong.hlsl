@@ -3,9 +3,22 @@
 // Input structs for vertex and pixel shader
 struct VS_INPUT
 {
+#ifdef QUANTIZED_VERTICES
+	// See VertexQuantization.h
+	float4 mPos : POSITION;
+	float2 mNormal : NORMAL0;
+#else
 	float3 mPos : POSITION;
 	float3 mNormal : NORMAL0;
+#endif
 	float2 mTex : TEXCOORD0;
+#ifdef INSTANCED
+	// Rows of the instance's world transform
+	float4 mWorld0 : WORLD0;
+	float4 mWorld1 : WORLD1;
+	float4 mWorld2 : WORLD2;
+	float4 mWorld3 : WORLD3;
+#endif
 };
 
 struct PS_INPUT
@@ -14,6 +27,8 @@ struct PS_INPUT
 	float2 mTex: TEXCOORD0;
 	float3 mWorldNormal : NORMAL0;
 	float3 mWorldPos : POSITION;
+	// View space depth, for finding the light cluster
+	float mViewDepth : TEXCOORD1;
 };
 
 //--------------------------------------------------------------------------------------
@@ -23,14 +38,29 @@ PS_INPUT VS(VS_INPUT input)
 {
 	PS_INPUT output;
 
+#ifdef QUANTIZED_VERTICES
+	float3 inPos = DequantizePosition(input.mPos.xyz);
+	float3 inNormal = DecodeOctahedral(input.mNormal);
+#else
+	float3 inPos = input.mPos;
+	float3 inNormal = input.mNormal;
+#endif
+
+#ifdef INSTANCED
+	float4x4 worldTransform = float4x4(input.mWorld0, input.mWorld1, input.mWorld2, input.mWorld3);
+#else
+	float4x4 worldTransform = mWorldTransform;
+#endif
+
 	// world space position
-	output.mWorldPos = mul(float4(input.mPos, 1.0f), mWorldTransform).xyz;
+	output.mWorldPos = mul(float4(inPos, 1.0f), worldTransform).xyz;
 
 	// normalized device space position
 	output.mPos = mul(float4(output.mWorldPos, 1.0f), mViewProjection);
+	output.mViewDepth = output.mPos.w;
 
 	// world space normal
-	output.mWorldNormal = mul(float4(input.mNormal, 0.0f), mWorldTransform).xyz;
+	output.mWorldNormal = mul(float4(inNormal, 0.0f), worldTransform).xyz;
 
 	// texture coordinates
 	output.mTex = input.mTex;
@@ -50,35 +80,8 @@ float4 PS(PS_INPUT input) : SV_Target
 
 	// Phong Lighting Equation
 	// I = ambient + sumOfAllLights(diffuse * (N dot L) + specular * (R dot V) ^ a)
-	float3 Phong = mAmbientLight;
-	for(int i = 0; i < 8; i++)
-	{
-		// If point light isn't enabled, skip it
-		if (!mPointLights[i].mEnabled) continue;
-
-		// Compute the normalized L and V vectors.
-		float3 L = normalize(mPointLights[i].mPosition - input.mWorldPos);
-		float3 V = normalize(mWorldCameraPosition - input.mWorldPos);
-		float3 R = reflect(-L, input.mWorldNormal);
-
-		// if (N dot L) > 0, light should affect this pixel
-		float NdotL = dot(input.mWorldNormal, L);
-		if (NdotL > 0)
-		{
-			// Smooth falloff
-			float falloff = lerp(1.0f, 0.0f, smoothstep(
-				mPointLights[i].mInnerRadius,
-				mPointLights[i].mOuterRadius,
-				distance(mPointLights[i].mPosition, input.mWorldPos)
-			));
-
-			// Diffuse light
-			Phong += mPointLights[i].mDiffuseColor * (NdotL * falloff);
-
-			// Specular light
-			Phong += mPointLights[i].mSpecularColor * (pow(max(0.0f, dot(R, V)), mPointLights[i].mSpecularPower) * falloff);
-		}
-	}
+	float3 Phong = mAmbientLight + ComputePointLighting(input.mPos.xy, input.mViewDepth,
+		input.mWorldPos, input.mWorldNormal);
 
 	// Clamp Phong lighting to [0.0f, 1.0f]
 	Phong = saturate(Phong);
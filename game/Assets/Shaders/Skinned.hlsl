@@ -9,8 +9,14 @@ cbuffer MatrixPalette : register(b3)
 // Input structs for vertex and pixel shader
 struct VS_INPUT
 {
+#ifdef QUANTIZED_VERTICES
+	// See VertexQuantization.h
+	float4 mPos : POSITION;
+	float2 mNormal : NORMAL0;
+#else
 	float3 mPos : POSITION;
 	float3 mNormal : NORMAL0;
+#endif
 	uint4 mBones : BONES;
 	float4 mWeights : WEIGHTS;
 	float2 mTex : TEXCOORD0;
@@ -22,6 +28,8 @@ struct PS_INPUT
 	float2 mTex: TEXCOORD0;
 	float3 mWorldNormal : NORMAL0;
 	float3 mWorldPos : POSITION;
+	// View space depth, for finding the light cluster
+	float mViewDepth : TEXCOORD1;
 };
 
 //--------------------------------------------------------------------------------------
@@ -31,8 +39,16 @@ PS_INPUT VS(VS_INPUT input)
 {
 	PS_INPUT output;
 
+#ifdef QUANTIZED_VERTICES
+	float3 inPos = DequantizePosition(input.mPos.xyz);
+	float3 inNormal = DecodeOctahedral(input.mNormal);
+#else
+	float3 inPos = input.mPos;
+	float3 inNormal = input.mNormal;
+#endif
+
 	// skinning
-	float4 position = float4(input.mPos, 1.0f);
+	float4 position = float4(inPos, 1.0f);
 	float4 skin = input.mWeights.x * mul(position, mMatrixPalette[input.mBones.x]);
 	skin = skin + input.mWeights.y * mul(position, mMatrixPalette[input.mBones.y]);
 	skin = skin + input.mWeights.z * mul(position, mMatrixPalette[input.mBones.z]);
@@ -43,9 +59,10 @@ PS_INPUT VS(VS_INPUT input)
 
 	// normalized device space position
 	output.mPos = mul(float4(output.mWorldPos, 1.0f), mViewProjection);
+	output.mViewDepth = output.mPos.w;
 
 	// world space normal
-	output.mWorldNormal = mul(float4(input.mNormal, 0.0f), mWorldTransform).xyz;
+	output.mWorldNormal = mul(float4(inNormal, 0.0f), mWorldTransform).xyz;
 
 	// texture coordinates
 	output.mTex = input.mTex;
@@ -65,35 +82,8 @@ float4 PS(PS_INPUT input) : SV_Target
 
 // Phong Lighting Equation
 // I = ambient + sumOfAllLights(diffuse * (N dot L) + specular * (R dot V) ^ a)
-float3 Phong = mAmbientLight;
-for (int i = 0; i < 8; i++)
-{
-	// If point light isn't enabled, skip it
-	if (!mPointLights[i].mEnabled) continue;
-
-	// Compute the normalized L and V vectors.
-	float3 L = normalize(mPointLights[i].mPosition - input.mWorldPos);
-	float3 V = normalize(mWorldCameraPosition - input.mWorldPos);
-	float3 R = reflect(-L, input.mWorldNormal);
-
-	// if (N dot L) > 0, light should affect this pixel
-	float NdotL = dot(input.mWorldNormal, L);
-	if (NdotL > 0)
-	{
-		// Smooth falloff
-		float falloff = lerp(1.0f, 0.0f, smoothstep(
-			mPointLights[i].mInnerRadius,
-			mPointLights[i].mOuterRadius,
-			distance(mPointLights[i].mPosition, input.mWorldPos)
-		));
-
-		// Diffuse light
-		Phong += mPointLights[i].mDiffuseColor * (NdotL * falloff);
-
-		// Specular light
-		Phong += mPointLights[i].mSpecularColor * (pow(max(0.0f, dot(R, V)), mPointLights[i].mSpecularPower) * falloff);
-	}
-}
+float3 Phong = mAmbientLight + ComputePointLighting(input.mPos.xy, input.mViewDepth,
+	input.mWorldPos, input.mWorldNormal);
 
 // Clamp Phong lighting to [0.0f, 1.0f]
 Phong = saturate(Phong);
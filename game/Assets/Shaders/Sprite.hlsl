@@ -5,12 +5,14 @@ struct VS_INPUT
 {
 	float3 mPos : POSITION;
 	float2 mTex : TEXCOORD0;
+	float4 mColor : COLOR0;
 };
 
 struct PS_INPUT
 {
 	float4 mPos : SV_POSITION;
 	float2 mTex: TEXCOORD0;
+	float4 mColor : COLOR0;
 };
 
 //--------------------------------------------------------------------------------------
@@ -24,6 +26,7 @@ PS_INPUT VS(VS_INPUT input)
 	output.mPos = mul(mul(float4(input.mPos, 1.0f), mWorldTransform), mViewProjection);
 	
 	output.mTex = input.mTex;
+	output.mColor = input.mColor;
 
 	return output;
 }
@@ -34,6 +37,6 @@ PS_INPUT VS(VS_INPUT input)
 //--------------------------------------------------------------------------------------
 float4 PS(PS_INPUT input) : SV_Target
 {
-	// Return color sampled from texture
-	return DiffuseTexture.Sample(DefaultSampler, input.mTex);
+	// Return color sampled from texture, tinted by the vertex color
+	return DiffuseTexture.Sample(DefaultSampler, input.mTex) * input.mColor;
 }
@@ -8,6 +8,9 @@ Actor::Actor(Game& game)
 	,mScale(1.0f)
 	,mIsAlive(true)
 	,mIsPaused(false)
+	,mTransformDirty(false)
+	,mTransformQueued(false)
+	,mWorldIndex(-1)
 {
 
 }
@@ -15,6 +18,10 @@ Actor::Actor(Game& game)
 Actor::~Actor()
 {
 	mGame.GetGameTimers().ClearAllTimers(this);
+	if (mTransformQueued)
+	{
+		mGame.GetWorld().CancelTransformUpdate(this);
+	}
 	RemoveAllChildren();
 	RemoveAllComponents();
 }
@@ -75,7 +82,7 @@ void Actor::AddChild(ActorPtr child)
 	mChildren.emplace(child);
 	child->mParent = this;
 	// Force the child to compute their transform matrix
-	child->ComputeWorldTransform();
+	child->MarkTransformDirty();
 }
 
 void Actor::RemoveChild(ActorPtr child)
@@ -87,12 +94,22 @@ void Actor::RemoveChild(ActorPtr child)
 		mChildren.erase(iter);
 	}
 	child->mParent = nullptr;
+	child->MarkTransformDirty();
+}
+
+void Actor::SetIsAlive(bool isAlive)
+{
+	if (mIsAlive && !isAlive)
+	{
+		mGame.GetWorld().DestroyActor(ThisPtr());
+	}
+	mIsAlive = isAlive;
 }
 
 Vector3 Actor::GetForward() const
 {
 	// Following Unreal coordinate system so X is forward
-	return mWorldTransform.GetXAxis();
+	return GetWorldTransform().GetXAxis();
 }
 
 ComponentPtr Actor::GetComponentFromType(const TypeInfo* type)
@@ -139,26 +156,59 @@ void Actor::SetProperties(const rapidjson::Value& properties)
 		SetScale(scale);
 }
 
-void Actor::ComputeWorldTransform()
+void Actor::MarkTransformDirty()
+{
+	// If we're already dirty, so are all of our children
+	if (mTransformDirty)
+	{
+		return;
+	}
+
+	mTransformDirty = true;
+	if (!mTransformQueued)
+	{
+		mTransformQueued = true;
+		mGame.GetWorld().QueueTransformUpdate(this);
+	}
+
+	for (auto& child : mChildren)
+	{
+		child->MarkTransformDirty();
+	}
+}
+
+void Actor::ComputeWorldTransform() const
 {
-	// NOTE: Computing this recursively is not the most efficient
-	// but it's the simplest to write!
-	mWorldTransform = Matrix4::CreateScale(mScale) *
-		Matrix4::CreateFromQuaternion(mRotation) *
-		Matrix4::CreateTranslation(mPosition);
+	// Same as Scale * Rotation * Translation, but without
+	// building and multiplying three separate matrices
+	mWorldTransform = Matrix4::CreateFromQuaternion(mRotation);
+	for (int i = 0; i < 3; i++)
+	{
+		mWorldTransform.mat[i][0] *= mScale;
+		mWorldTransform.mat[i][1] *= mScale;
+		mWorldTransform.mat[i][2] *= mScale;
+	}
+	mWorldTransform.mat[3][0] = mPosition.x;
+	mWorldTransform.mat[3][1] = mPosition.y;
+	mWorldTransform.mat[3][2] = mPosition.z;
 
 	// No parent is the base case
 	if (mParent)
 	{
 		// My transform * Parent's transform
+		// (this pulls the parent up to date first if needed)
 		mWorldTransform *= mParent->GetWorldTransform();
 	}
 
-	// Tell my children to recompute
-	for (auto& child : mChildren)
-	{
-		child->ComputeWorldTransform();
-	}
+	mTransformDirty = false;
+}
+
+void Actor::NotifyUpdatedTransform()
+{
+	mTransformQueued = false;
+
+	// Make sure the matrix is current before anyone looks at it
+	GetWorldTransform();
 
 	// Notify my components that my transform has updated
 	for (auto& comp : mPreTickComponents)
@@ -46,20 +46,31 @@ public:
 	void AddChild(ActorPtr child);
 	void RemoveChild(ActorPtr child);
 
-	void SetPosition(const Vector3& pos) { mPosition = pos; ComputeWorldTransform(); }
+	void SetPosition(const Vector3& pos) { mPosition = pos; MarkTransformDirty(); }
 	const Vector3& GetPosition() const { return mPosition; }
 
-	void SetScale(float scale) { mScale = scale; ComputeWorldTransform(); }
+	void SetScale(float scale) { mScale = scale; MarkTransformDirty(); }
 	float GetScale() const { return mScale; }
 
-	void SetRotation(const Quaternion& rotation) { mRotation = rotation; ComputeWorldTransform(); }
+	void SetRotation(const Quaternion& rotation) { mRotation = rotation; MarkTransformDirty(); }
 	const Quaternion& GetRotation() const { return mRotation; }
 
-	const Matrix4& GetWorldTransform() { return mWorldTransform; }
+	// The world transform is recomputed lazily, so this is
+	// always up to date even before World's transform pass
+	const Matrix4& GetWorldTransform() const
+	{
+		if (mTransformDirty)
+		{
+			ComputeWorldTransform();
+		}
+		return mWorldTransform;
+	}
 
 	Vector3 GetForward() const;
 
-	void SetIsAlive(bool isAlive) { mIsAlive = isAlive; }
+	// Marking an actor as dead queues it to be destroyed
+	// at the end of the current frame
+	void SetIsAlive(bool isAlive);
 	bool IsAlive() const { return mIsAlive; }
 
 	void SetIsPaused(bool isPaused) { mIsPaused = isPaused; }
@@ -90,9 +101,16 @@ public:
 
 	void SetProperties(const rapidjson::Value& properties) override;
 protected:
+	// Flags this Actor and its children as needing a new world transform,
+	// and queues them for World's once-per-frame transform pass
+	void MarkTransformDirty();
+
 	// Recomputes the world transform based on this Actor's position/scale/rotation,
 	// as well as any parent Actors
-	void ComputeWorldTransform();
+	void ComputeWorldTransform() const;
+
+	// Called by World's transform pass, notifies components once per frame
+	void NotifyUpdatedTransform();
 
 	Game& mGame;
 
@@ -104,13 +122,22 @@ protected:
 	// a circular reference (would be more correct to use a weak_ptr)
 	Actor* mParent;
 private:
-	Matrix4 mWorldTransform;
+	// Mutable so the lazy update can happen behind the const accessors
+	mutable Matrix4 mWorldTransform;
 	Vector3 mPosition;
 	Quaternion mRotation;
 	float mScale;
 
 	bool mIsAlive;
 	bool mIsPaused;
+
+	// World transform needs recomputing (if set, so is every child's)
+	mutable bool mTransformDirty;
+	// Waiting in World's transform pass for OnUpdatedTransform
+	bool mTransformQueued;
+
+	// Slot in World's actor list, or -1 if World doesn't own us
+	int mWorldIndex;
 private:
 	void TickInternal(float deltaTime);
 	void RemoveAllComponents();
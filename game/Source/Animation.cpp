@@ -1,6 +1,12 @@
 #include "ITPEnginePCH.h"
 #include <SDL/SDL_log.h>
 
+namespace
+{
+	// Bump this whenever the cooked layout (or the parsing) changes
+	const uint32_t kCookedAnimVersion = 1;
+}
+
 Animation::Animation(class Game& game)
 	:Asset(game)
 {
@@ -9,7 +15,7 @@ Animation::Animation(class Game& game)
 
 bool Animation::Load(const char* fileName, class AssetCache* cache)
 {
-	std::ifstream file(fileName);
+	std::ifstream file(fileName, std::ios::binary);
 	if (!file.is_open())
 	{
 		SDL_Log("File not found: Animation %s", fileName);
@@ -19,6 +25,39 @@ bool Animation::Load(const char* fileName, class AssetCache* cache)
 	std::stringstream fileStream;
 	fileStream << file.rdbuf();
 	std::string contents = fileStream.str();
+
+	// Try the cooked version first
+	AssetDiskCache& diskCache = cache->GetDiskCache();
+	uint64_t sourceHash = AssetDiskCache::HashContents(contents.data(), contents.size());
+	std::vector<char> cooked;
+	bool uncooked = false;
+	if (diskCache.Load("itpanim", kCookedAnimVersion, sourceHash, cooked))
+	{
+		CookedReader reader(cooked);
+		uncooked = Uncook(reader);
+		if (!uncooked)
+		{
+			SDL_Log("Animation %s: cooked data is corrupt, reparsing", fileName);
+		}
+	}
+
+	if (!uncooked)
+	{
+		if (!ParseJson(fileName, contents))
+		{
+			return false;
+		}
+
+		CookedWriter writer;
+		Cook(writer);
+		diskCache.Store("itpanim", kCookedAnimVersion, sourceHash, writer.GetData());
+	}
+
+	return true;
+}
+
+bool Animation::ParseJson(const char* fileName, const std::string& contents)
+{
 	rapidjson::StringStream jsonStr(contents.c_str());
 	rapidjson::Document doc;
 	doc.ParseStream(jsonStr);
@@ -62,6 +101,7 @@ bool Animation::Load(const char* fileName, class AssetCache* cache)
 	mLength = length.GetDouble();
 	mNumBones = bonecount.GetUint();
 
+	mTracks.clear();
 	mTracks.resize(mNumBones);
 
 	const rapidjson::Value& tracks = sequence["tracks"];
@@ -124,6 +164,40 @@ bool Animation::Load(const char* fileName, class AssetCache* cache)
 	return true;
 }
 
+void Animation::Cook(CookedWriter& writer) const
+{
+	writer.Write(static_cast<uint32_t>(mNumBones));
+	writer.Write(static_cast<uint32_t>(mNumFrames));
+	writer.Write(mLength);
+	for (const auto& track : mTracks)
+	{
+		writer.WriteArray(track);
+	}
+}
+
+bool Animation::Uncook(CookedReader& reader)
+{
+	uint32_t numBones = 0;
+	uint32_t numFrames = 0;
+	if (!reader.Read(numBones) || !reader.Read(numFrames) || !reader.Read(mLength))
+	{
+		return false;
+	}
+
+	mNumBones = numBones;
+	mNumFrames = numFrames;
+	mTracks.resize(mNumBones);
+	for (auto& track : mTracks)
+	{
+		if (!reader.ReadArray(track))
+		{
+			return false;
+		}
+	}
+
+	return reader.IsAtEnd();
+}
+
 void Animation::GetGlobalPoseAtTime(std::vector<SimdMatrix4>& outPoses, SkeletonPtr inSkeleton, float inTime)
 {
 	float durationPerFrame = mLength / static_cast<float> (mNumFrames - 1);
@@ -138,15 +212,13 @@ void Animation::GetGlobalPoseAtTime(std::vector<SimdMatrix4>& outPoses, Skeleton
 	outPoses.emplace_back(Interpolate(mTracks[0][frame], mTracks[0][frame + 1], f).ToSimdMatrix());
 
 	// Global pose for all other elements
-	std::vector<SimdMatrix4> globalInvBindPoses = inSkeleton->GetGlobalInvBindPoses();
+	const std::vector<SimdMatrix4>& globalBindPoses = inSkeleton->GetGlobalBindPoses();
 	for (unsigned int i = 1; i < mNumBones; ++i)
 	{
 		// If bone doesn't change during the course of the animation, use global bind pose
 		if (mTracks[i].empty())
 		{
-			SimdMatrix4 bindPoseMatrix = globalInvBindPoses[i];
-			bindPoseMatrix.Invert();
-			outPoses.emplace_back(bindPoseMatrix);
+			outPoses.emplace_back(globalBindPoses[i]);
 			continue;
 		}
 
@@ -181,15 +253,13 @@ void Animation::GetBlendedGlobalPoseAtTime(std::vector<SimdMatrix4>& outPoses, S
 		Interpolate(mTracks[0][clipB_frame], mTracks[0][clipB_frame + 1], clipB_f), blendFactor).ToSimdMatrix());
 
 	// Global pose for all other elements
-	std::vector<SimdMatrix4> globalInvBindPoses = inSkeleton->GetGlobalInvBindPoses();
+	const std::vector<SimdMatrix4>& globalBindPoses = inSkeleton->GetGlobalBindPoses();
 	for (unsigned int i = 1; i < mNumBones; ++i)
 	{
 		// If bone doesn't change during the course of the animation, use global bind pose
 		if (mTracks[i].empty())
 		{
-			SimdMatrix4 bindPoseMatrix = globalInvBindPoses[i];
-			bindPoseMatrix.Invert();
-			outPoses.emplace_back(bindPoseMatrix);
+			outPoses.emplace_back(globalBindPoses[i]);
 			continue;
 		}
 
@@ -203,4 +273,14 @@ void Animation::GetBlendedGlobalPoseAtTime(std::vector<SimdMatrix4>& outPoses, S
 		globalPoseMatrix.Mul(outPoses[inSkeleton->GetBone(i).mParent]);
 		outPoses.emplace_back(globalPoseMatrix);
 	}
-}
\ No newline at end of file
+}
+
+size_t Animation::GetMemorySize() const
+{
+	size_t size = sizeof(Animation) + mTracks.capacity() * sizeof(std::vector<BoneTransform>);
+	for (const auto& track : mTracks)
+	{
+		size += track.capacity() * sizeof(BoneTransform);
+	}
+	return size;
+}
@@ -2,6 +2,7 @@
 #include "Asset.h"
 #include "BoneTransform.h"
 #include <vector>
+#include <string>
 #include "Skeleton.h"
 
 class Animation : public Asset
@@ -11,6 +12,7 @@ public:
 	Animation(class Game& game);
 
 	bool Load(const char* fileName, class AssetCache* cache) override;
+	size_t GetMemorySize() const override;
 
 	size_t GetNumBones() const { return mNumBones; }
 	size_t GetNumFrames() const { return mNumFrames; }
@@ -22,6 +24,11 @@ public:
 	void GetGlobalPoseAtTime(std::vector<SimdMatrix4>& outPoses, SkeletonPtr inSkeleton, float inTime);
 	void GetBlendedGlobalPoseAtTime(std::vector<SimdMatrix4>& outPoses, SkeletonPtr inSkeleton, std::shared_ptr<Animation> inPrevAnim, float inTime, float inPrevTime, float inBlendTime);
 private:
+	// Parses the json version of the file
+	bool ParseJson(const char* fileName, const std::string& contents);
+	void Cook(class CookedWriter& writer) const;
+	bool Uncook(class CookedReader& reader);
+
 	// Number of bones for the animation
 	size_t mNumBones;
 
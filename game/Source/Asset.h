@@ -13,6 +13,10 @@ class Asset : public std::enable_shared_from_this<Asset>
 public:
 	Asset(class Game& game);
 	virtual ~Asset();
+
+	// Approximate number of bytes this asset is holding on to
+	// (CPU and GPU), used by AssetCache for its memory budget
+	virtual size_t GetMemorySize() const { return 0; }
 protected:
 	// Change the access level to the protected
 	using std::enable_shared_from_this<Asset>::shared_from_this;
@@ -1,13 +1,139 @@
 #include "ITPEnginePCH.h"
+#include <cstring>
 
 AssetCache::AssetCache(Game& game, const char* rootDirectory)
-	:mGame(game)
+	:mDiskCache("Cooked/")
+	,mGame(game)
 	,mRoot(rootDirectory)
 {
+	mStats.mHits = 0;
+	mStats.mMisses = 0;
+	mStats.mEvictions = 0;
+	mStats.mTotalBytes = 0;
+	mStats.mBudget = 0;
+}
+
+void AssetCache::SetMemoryBudget(size_t bytes)
+{
+	mStats.mBudget = bytes;
+	EnforceBudget();
+}
+
+void AssetCache::EnforceBudget()
+{
+	if (mStats.mBudget > 0 && mStats.mTotalBytes > mStats.mBudget)
+	{
+		EvictDownTo(mStats.mBudget);
+	}
+}
+
+void AssetCache::Trim()
+{
+	EvictDownTo(0);
+}
+
+void AssetCache::ResetCounters()
+{
+	mStats.mHits = 0;
+	mStats.mMisses = 0;
+	mStats.mEvictions = 0;
+}
 
+void AssetCache::LogStats() const
+{
+	SDL_Log("AssetCache: %u assets, %u KB (budget %u KB), %u hits, %u misses, %u evictions",
+		static_cast<unsigned>(mAssetMap.Size()),
+		static_cast<unsigned>(mStats.mTotalBytes / 1024),
+		static_cast<unsigned>(mStats.mBudget / 1024),
+		static_cast<unsigned>(mStats.mHits),
+		static_cast<unsigned>(mStats.mMisses),
+		static_cast<unsigned>(mStats.mEvictions));
+	for (const auto& type : mTypeStats)
+	{
+		SDL_Log("  %s: %u assets, %u KB", type.mTypeName,
+			static_cast<unsigned>(type.mCount),
+			static_cast<unsigned>(type.mBytes / 1024));
+	}
 }
 
 void AssetCache::Clear()
 {
-	mAssetMap.clear();
+	mAssetMap.Clear();
+	mLruList.clear();
+	mTypeStats.clear();
+	mStats.mTotalBytes = 0;
+}
+
+void AssetCache::AddEntry(AssetId id, AssetPtr asset, const char* typeName)
+{
+	Entry& entry = mAssetMap.Insert(id);
+	entry.mAsset = asset;
+	entry.mTypeName = typeName;
+	entry.mBytes = asset->GetMemorySize();
+
+	mLruList.push_front(id);
+	entry.mLruIter = mLruList.begin();
+
+	TypeStats& type = FindTypeStats(typeName);
+	type.mCount++;
+	type.mBytes += entry.mBytes;
+	mStats.mTotalBytes += entry.mBytes;
+}
+
+void AssetCache::Touch(Entry& entry)
+{
+	mLruList.splice(mLruList.begin(), mLruList, entry.mLruIter);
+}
+
+void AssetCache::EvictDownTo(size_t targetBytes)
+{
+	// Evicting an asset (say a mesh) can release the only other
+	// reference to another asset (its textures), so keep making
+	// passes until nothing else can go
+	bool evicted = true;
+	while (evicted && mStats.mTotalBytes > targetBytes)
+	{
+		evicted = false;
+		auto iter = mLruList.end();
+		while (iter != mLruList.begin() && mStats.mTotalBytes > targetBytes)
+		{
+			--iter;
+			AssetId id = *iter;
+			Entry& entry = *mAssetMap.Find(id);
+			if (entry.mAsset.use_count() > 1)
+			{
+				// Still in use
+				continue;
+			}
+
+			TypeStats& type = FindTypeStats(entry.mTypeName);
+			type.mCount--;
+			type.mBytes -= entry.mBytes;
+			mStats.mTotalBytes -= entry.mBytes;
+			mStats.mEvictions++;
+
+			iter = mLruList.erase(iter);
+			mAssetMap.Erase(id);
+			evicted = true;
+		}
+	}
+}
+
+AssetCache::TypeStats& AssetCache::FindTypeStats(const char* typeName)
+{
+	// There's only a handful of asset types, so a linear search is fine
+	for (auto& type : mTypeStats)
+	{
+		if (strcmp(type.mTypeName, typeName) == 0)
+		{
+			return type;
+		}
+	}
+
+	TypeStats type;
+	type.mTypeName = typeName;
+	type.mCount = 0;
+	type.mBytes = 0;
+	mTypeStats.push_back(type);
+	return mTypeStats.back();
 }
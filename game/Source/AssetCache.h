@@ -3,53 +3,131 @@
 // file is only loaded once at most.
 // Generally, you will call the Load function on the AssetCache
 // member in Game
+// Assets live in one of two tiers:
+// - In use: something other than the cache holds a pointer to it
+// - Cached: only the cache holds it, so it can be evicted
+// Whenever the total size goes over the memory budget, cached
+// assets are evicted in least recently used order.
+// Assets are keyed by AssetId (a hash of the path relative to the
+// root), so a cache hit doesn't build or copy any strings.
 
 #pragma once
 #include "Asset.h"
+#include "AssetId.h"
+#include "FlatHashMap.h"
+#include "AssetDiskCache.h"
 #include <string>
-#include <unordered_map>
+#include <list>
+#include <vector>
 
 class Game;
 
 class AssetCache
 {
 public:
+	// Memory stats for one type of asset
+	struct TypeStats
+	{
+		const char* mTypeName;
+		size_t mCount;
+		size_t mBytes;
+	};
+
+	struct Stats
+	{
+		size_t mHits;
+		size_t mMisses;
+		size_t mEvictions;
+		size_t mTotalBytes;
+		size_t mBudget;
+	};
+
 	AssetCache(Game& game, const char* rootDirectory);
 
 	// Template magics to load an arbitrary Asset into the cache
 	// Generally will be used like:
 	// assetCache.Load<AssetClass>("path/file.name")
 	template <typename T>
-	std::shared_ptr<T> Load(const char* fileName)
+	std::shared_ptr<T> Load(const AssetPath& assetPath)
 	{
-		std::string path(mRoot);
-		path += fileName;
-		auto iter = mAssetMap.find(path);
+		Entry* entry = mAssetMap.Find(assetPath.mId);
 
-		if (iter != mAssetMap.end())
+		if (entry)
 		{
-			return std::static_pointer_cast<T>(iter->second);
+			mStats.mHits++;
+			Touch(*entry);
+			return std::static_pointer_cast<T>(entry->mAsset);
 		}
 		else
 		{
+			// Only need the full path if we actually have to load it
+			mStats.mMisses++;
+			std::string path(mRoot);
+			path += assetPath.mName;
 			std::shared_ptr<T> asset = T::StaticLoad(path.c_str(), this, mGame);
 			if (asset)
 			{
-				mAssetMap.emplace(path, asset);
+				AddEntry(assetPath.mId, asset, T::StaticTypeName());
+				// The new asset is still referenced here, so it's safe
+				EnforceBudget();
 			}
 			return asset;
 		}
 	}
 
+	template <typename T>
+	std::shared_ptr<T> Load(const char* fileName)
+	{
+		return Load<T>(AssetPath(fileName));
+	}
+
 	template <typename T>
 	std::shared_ptr<T> Load(const std::string& fileName)
 	{
 		return Load<T>(fileName.c_str());
 	}
-	
+
+	// Budget (in bytes) for all the assets in the cache
+	// 0 means there is no budget
+	void SetMemoryBudget(size_t bytes);
+	size_t GetMemoryBudget() const { return mStats.mBudget; }
+
+	// Evicts cached assets until the cache is under budget
+	void EnforceBudget();
+	// Evicts every asset that's only referenced by the cache
+	void Trim();
+
+	// Cooked versions of assets, shared between runs
+	AssetDiskCache& GetDiskCache() { return mDiskCache; }
+
+	const Stats& GetStats() const { return mStats; }
+	const std::vector<TypeStats>& GetTypeStats() const { return mTypeStats; }
+	void ResetCounters();
+	void LogStats() const;
+
 	void Clear();
 private:
-	std::unordered_map<std::string, AssetPtr> mAssetMap;
+	struct Entry
+	{
+		AssetPtr mAsset;
+		const char* mTypeName;
+		size_t mBytes;
+		// Position in mLruList
+		std::list<AssetId>::iterator mLruIter;
+	};
+
+	void AddEntry(AssetId id, AssetPtr asset, const char* typeName);
+	void Touch(Entry& entry);
+	// Evicts cached assets (oldest first) until total size <= targetBytes
+	void EvictDownTo(size_t targetBytes);
+	TypeStats& FindTypeStats(const char* typeName);
+
+	FlatHashMap<Entry> mAssetMap;
+	// Keys of mAssetMap, most recently used at the front
+	std::list<AssetId> mLruList;
+	std::vector<TypeStats> mTypeStats;
+	Stats mStats;
+	AssetDiskCache mDiskCache;
 	Game& mGame;
 	const char* mRoot;
 };
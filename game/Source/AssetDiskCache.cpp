@@ -0,0 +1,145 @@
+#include "ITPEnginePCH.h"
+#include "AssetDiskCache.h"
+#include "AssetId.h"
+
+namespace
+{
+	// "ITPC"
+	const uint32_t kCookedMagic = 0x43505449;
+}
+
+AssetDiskCache::AssetDiskCache(const char* directory)
+	:mDirectory(directory)
+	,mEnabled(true)
+	,mCreatedDirectory(false)
+{
+
+}
+
+uint64_t AssetDiskCache::HashContents(const void* data, size_t size)
+{
+	// Same 64-bit FNV-1a as the asset IDs, minus the path normalizing
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	uint64_t hash = AssetIdHelper::kFnvOffset;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= AssetIdHelper::kFnvPrime;
+	}
+	return hash;
+}
+
+bool AssetDiskCache::Load(const char* typeName, uint32_t version, uint64_t sourceHash,
+	std::vector<char>& outData)
+{
+	if (!mEnabled)
+	{
+		return false;
+	}
+
+	uint64_t typeHash = HashAssetPath(typeName);
+	std::string path = GetEntryPath(typeHash, version, sourceHash);
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	// Make sure this really is the entry we wanted
+	Header header;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+		header.mMagic != kCookedMagic ||
+		header.mVersion != version ||
+		header.mTypeHash != typeHash ||
+		header.mSourceHash != sourceHash)
+	{
+		SDL_Log("Ignoring invalid cooked asset %s", path.c_str());
+		return false;
+	}
+
+	outData.resize(static_cast<size_t>(header.mDataSize));
+	if (!outData.empty() && !file.read(outData.data(), outData.size()))
+	{
+		SDL_Log("Cooked asset %s is truncated", path.c_str());
+		outData.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool AssetDiskCache::Store(const char* typeName, uint32_t version, uint64_t sourceHash,
+	const std::vector<char>& data)
+{
+	if (!mEnabled)
+	{
+		return false;
+	}
+
+	if (!mCreatedDirectory)
+	{
+		// Fails harmlessly if it already exists
+		CreateDirectoryA(mDirectory.c_str(), nullptr);
+		mCreatedDirectory = true;
+	}
+
+	Header header;
+	header.mMagic = kCookedMagic;
+	header.mVersion = version;
+	header.mTypeHash = HashAssetPath(typeName);
+	header.mSourceHash = sourceHash;
+	header.mDataSize = data.size();
+
+	std::string path = GetEntryPath(header.mTypeHash, version, sourceHash);
+
+	// Write to a file only this process knows about, then move it
+	// into place, so other processes never see a partial entry
+	std::string tempPath = path;
+	tempPath += ".";
+	tempPath += std::to_string(GetCurrentProcessId());
+	tempPath += ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			SDL_Log("Failed to create cooked asset %s", tempPath.c_str());
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		if (!data.empty())
+		{
+			file.write(data.data(), data.size());
+		}
+
+		if (!file)
+		{
+			SDL_Log("Failed to write cooked asset %s", tempPath.c_str());
+			file.close();
+			DeleteFileA(tempPath.c_str());
+			return false;
+		}
+	}
+
+	if (!MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+	{
+		// Most likely another process has it open, which means it
+		// already wrote the same entry
+		DeleteFileA(tempPath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+std::string AssetDiskCache::GetEntryPath(uint64_t typeHash, uint32_t version, uint64_t sourceHash) const
+{
+	// Mix everything that identifies the entry into the file name
+	uint64_t key = sourceHash;
+	key ^= typeHash + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2);
+	key ^= version + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2);
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.cooked", static_cast<unsigned long long>(key));
+	return mDirectory + name;
+}
@@ -0,0 +1,151 @@
+// AssetDiskCache.h
+// Content-addressed cache of "cooked" assets on disk.
+// Loaders that parse text formats (meshes, animations, skeletons)
+// write out a binary version of the result, keyed by a hash of the
+// source file's contents, the asset type and the loader's version.
+// Any later process that loads the same source file reads the
+// binary back instead of parsing it again. Editing the source file
+// (or bumping the loader version) changes the key, so stale entries
+// are never used.
+
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Appends plain data to a byte buffer
+class CookedWriter
+{
+public:
+	template <typename T>
+	void Write(const T& value)
+	{
+		WriteBytes(&value, sizeof(T));
+	}
+
+	// Writes the element count followed by the elements
+	template <typename T>
+	void WriteArray(const std::vector<T>& values)
+	{
+		Write(static_cast<uint32_t>(values.size()));
+		if (!values.empty())
+		{
+			WriteBytes(values.data(), values.size() * sizeof(T));
+		}
+	}
+
+	void WriteString(const std::string& str)
+	{
+		Write(static_cast<uint32_t>(str.size()));
+		WriteBytes(str.data(), str.size());
+	}
+
+	void WriteBytes(const void* data, size_t size)
+	{
+		const char* bytes = static_cast<const char*>(data);
+		mData.insert(mData.end(), bytes, bytes + size);
+	}
+
+	const std::vector<char>& GetData() const { return mData; }
+private:
+	std::vector<char> mData;
+};
+
+// Reads back what CookedWriter wrote
+// Every function returns false if it would read past the end
+class CookedReader
+{
+public:
+	CookedReader(const std::vector<char>& data)
+		:mData(data.data())
+		,mSize(data.size())
+		,mPos(0)
+	{ }
+
+	template <typename T>
+	bool Read(T& value)
+	{
+		return ReadBytes(&value, sizeof(T));
+	}
+
+	template <typename T>
+	bool ReadArray(std::vector<T>& values)
+	{
+		uint32_t count = 0;
+		if (!Read(count) || (mSize - mPos) / sizeof(T) < count)
+		{
+			return false;
+		}
+		values.resize(count);
+		return count == 0 || ReadBytes(values.data(), count * sizeof(T));
+	}
+
+	bool ReadString(std::string& str)
+	{
+		uint32_t length = 0;
+		if (!Read(length) || mSize - mPos < length)
+		{
+			return false;
+		}
+		str.assign(mData + mPos, length);
+		mPos += length;
+		return true;
+	}
+
+	bool ReadBytes(void* out, size_t size)
+	{
+		if (mSize - mPos < size)
+		{
+			return false;
+		}
+		memcpy(out, mData + mPos, size);
+		mPos += size;
+		return true;
+	}
+
+	bool IsAtEnd() const { return mPos == mSize; }
+private:
+	const char* mData;
+	size_t mSize;
+	size_t mPos;
+};
+
+class AssetDiskCache
+{
+public:
+	AssetDiskCache(const char* directory);
+
+	// Hash used to identify the source file
+	static uint64_t HashContents(const void* data, size_t size);
+
+	// Reads the cooked data for this source, if there is any
+	// typeName identifies the kind of asset (eg. "itpmesh")
+	// version is the loader's cooked format version
+	bool Load(const char* typeName, uint32_t version, uint64_t sourceHash,
+		std::vector<char>& outData);
+
+	// Saves cooked data for this source. Safe to call from several
+	// processes at once; whoever finishes last wins, and the
+	// contents are the same anyways.
+	bool Store(const char* typeName, uint32_t version, uint64_t sourceHash,
+		const std::vector<char>& data);
+
+	void SetEnabled(bool enabled) { mEnabled = enabled; }
+	bool IsEnabled() const { return mEnabled; }
+private:
+	struct Header
+	{
+		uint32_t mMagic;
+		uint32_t mVersion;
+		uint64_t mTypeHash;
+		uint64_t mSourceHash;
+		uint64_t mDataSize;
+	};
+
+	std::string GetEntryPath(uint64_t typeHash, uint32_t version, uint64_t sourceHash) const;
+
+	std::string mDirectory;
+	bool mEnabled;
+	bool mCreatedDirectory;
+};
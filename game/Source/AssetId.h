@@ -0,0 +1,74 @@
+// AssetId.h
+// 64-bit IDs for asset paths, so the AssetCache can look assets up
+// without building or hashing std::strings.
+// The ID is the FNV-1a hash of the path after normalizing it
+// (lower case, forward slashes), so "Meshes\Cube.itpmesh" and
+// "meshes/cube.itpmesh" are the same asset.
+//
+// For literal paths, ASSET_PATH("Meshes/Cube.itpmesh") computes
+// the ID at compile time:
+// cache.Load<Mesh>(ASSET_PATH("Meshes/Cube.itpmesh"));
+
+#pragma once
+#include <cstdint>
+#include <type_traits>
+
+typedef uint64_t AssetId;
+
+namespace AssetIdHelper
+{
+	const AssetId kFnvOffset = 14695981039346656037ULL;
+	const AssetId kFnvPrime = 1099511628211ULL;
+
+	constexpr char Normalize(char c)
+	{
+		return (c == '\\') ? '/' :
+			((c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c);
+	}
+
+	constexpr AssetId Hash(const char* str, AssetId hash)
+	{
+		return (*str == 0) ? hash :
+			Hash(str + 1, (hash ^ static_cast<unsigned char>(Normalize(*str))) * kFnvPrime);
+	}
+}
+
+// Usable in constant expressions
+constexpr AssetId MakeAssetId(const char* path)
+{
+	return AssetIdHelper::Hash(path, AssetIdHelper::kFnvOffset);
+}
+
+// Same result as MakeAssetId, but loops instead of recursing,
+// for paths that are only known at runtime
+inline AssetId HashAssetPath(const char* path)
+{
+	AssetId hash = AssetIdHelper::kFnvOffset;
+	for (; *path != 0; ++path)
+	{
+		hash ^= static_cast<unsigned char>(AssetIdHelper::Normalize(*path));
+		hash *= AssetIdHelper::kFnvPrime;
+	}
+	return hash;
+}
+
+// A path along with its precomputed ID
+struct AssetPath
+{
+	AssetPath(AssetId id, const char* name)
+		:mId(id)
+		,mName(name)
+	{ }
+
+	explicit AssetPath(const char* name)
+		:mId(HashAssetPath(name))
+		,mName(name)
+	{ }
+
+	AssetId mId;
+	const char* mName;
+};
+
+// Forces the hash to happen at compile time
+#define ASSET_ID(path) (std::integral_constant<AssetId, MakeAssetId(path)>::value)
+#define ASSET_PATH(path) AssetPath(ASSET_ID(path), path)
@@ -40,13 +40,14 @@ void BoxComponent::OnUpdatedTransform()
 {
 	// Update the world space box from our owning component
 
-	// Scale the box by the owner's scale, as well as the scale vector
-	mWorldSpaceBounds.mMin = mModelSpaceBounds.mMin * mOwner.GetScale() * mScale;
-	mWorldSpaceBounds.mMax = mModelSpaceBounds.mMax * mOwner.GetScale() * mScale;
+	// Scale the box by the scale vector
+	Collision::AxisAlignedBox scaledBounds;
+	scaledBounds.mMin = mModelSpaceBounds.mMin * mScale;
+	scaledBounds.mMax = mModelSpaceBounds.mMax * mScale;
 
-	// Translate by owner's translation
-	mWorldSpaceBounds.mMin += mOwner.GetPosition();
-	mWorldSpaceBounds.mMax += mOwner.GetPosition();
+	// Then bound it after the owner's full world transform, so
+	// rotated (and attached) actors get correct bounds
+	mWorldSpaceBounds = Collision::TransformBox(scaledBounds, mOwner.GetWorldTransform());
 }
 
 void BoxComponent::SetProperties(const rapidjson::Value& properties)
@@ -140,4 +140,263 @@ namespace Collision
 		return true;
 	}
 
+AxisAlignedBox TransformBox(const AxisAlignedBox& box, const Matrix4& mat)
+{
+	AxisAlignedBox retVal;
+	TransformBoxes(&box, &retVal, 1, mat);
+	return retVal;
+}
+
+void TransformBoxes(const AxisAlignedBox* in, AxisAlignedBox* out, size_t count, const Matrix4& mat)
+{
+	// Work in center/extents form: the center transforms like any point,
+	// and the new extents are the old ones times the absolute upper 3x3
+#if MATH_SSE
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	const __m128 half = _mm_set_ps1(0.5f);
+	__m128 r0 = _mm_loadu_ps(mat.mat[0]);
+	__m128 r1 = _mm_loadu_ps(mat.mat[1]);
+	__m128 r2 = _mm_loadu_ps(mat.mat[2]);
+	__m128 r3 = _mm_loadu_ps(mat.mat[3]);
+	__m128 abs0 = _mm_and_ps(r0, absMask);
+	__m128 abs1 = _mm_and_ps(r1, absMask);
+	__m128 abs2 = _mm_and_ps(r2, absMask);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const AxisAlignedBox& box = in[i];
+		__m128 boxMin = _mm_setr_ps(box.mMin.x, box.mMin.y, box.mMin.z, 0.0f);
+		__m128 boxMax = _mm_setr_ps(box.mMax.x, box.mMax.y, box.mMax.z, 0.0f);
+		__m128 center = _mm_mul_ps(_mm_add_ps(boxMin, boxMax), half);
+		__m128 extents = _mm_mul_ps(_mm_sub_ps(boxMax, boxMin), half);
+
+		__m128 newCenter = Simd::MulAdd(Simd::Splat<0>(center), r0, r3);
+		newCenter = Simd::MulAdd(Simd::Splat<1>(center), r1, newCenter);
+		newCenter = Simd::MulAdd(Simd::Splat<2>(center), r2, newCenter);
+
+		__m128 newExtents = _mm_mul_ps(Simd::Splat<0>(extents), abs0);
+		newExtents = Simd::MulAdd(Simd::Splat<1>(extents), abs1, newExtents);
+		newExtents = Simd::MulAdd(Simd::Splat<2>(extents), abs2, newExtents);
+
+		out[i].mMin = Vector3(_mm_sub_ps(newCenter, newExtents));
+		out[i].mMax = Vector3(_mm_add_ps(newCenter, newExtents));
+	}
+#else
+	const float (&m)[4][4] = mat.mat;
+	for (size_t i = 0; i < count; i++)
+	{
+		const AxisAlignedBox& box = in[i];
+		Vector3 center = (box.mMin + box.mMax) * 0.5f;
+		Vector3 extents = (box.mMax - box.mMin) * 0.5f;
+
+		Vector3 newCenter = Transform(center, mat);
+		Vector3 newExtents;
+		newExtents.x = extents.x * Math::Abs(m[0][0]) + extents.y * Math::Abs(m[1][0]) + extents.z * Math::Abs(m[2][0]);
+		newExtents.y = extents.x * Math::Abs(m[0][1]) + extents.y * Math::Abs(m[1][1]) + extents.z * Math::Abs(m[2][1]);
+		newExtents.z = extents.x * Math::Abs(m[0][2]) + extents.y * Math::Abs(m[1][2]) + extents.z * Math::Abs(m[2][2]);
+
+		out[i].mMin = newCenter - newExtents;
+		out[i].mMax = newCenter + newExtents;
+	}
+#endif
+}
+
+void TransformBoxes(const BoxStreams& in, const Matrix4* transforms, BoxStreams& out)
+{
+	size_t count = in.Size();
+	out.Resize(count);
+
+	// Same math as above, but every box has its own matrix. Transposing
+	// the rows of four matrices gives one register per matrix entry, with
+	// that entry for all four boxes in it.
+	size_t i = 0;
+#if MATH_SSE
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+	for (; i + 4 <= count; i += 4)
+	{
+		// m[r][c] holds mat.mat[r][c] of boxes i to i + 3
+		__m128 m[4][4];
+		for (int r = 0; r < 4; r++)
+		{
+			m[r][0] = _mm_loadu_ps(transforms[i].mat[r]);
+			m[r][1] = _mm_loadu_ps(transforms[i + 1].mat[r]);
+			m[r][2] = _mm_loadu_ps(transforms[i + 2].mat[r]);
+			m[r][3] = _mm_loadu_ps(transforms[i + 3].mat[r]);
+			_MM_TRANSPOSE4_PS(m[r][0], m[r][1], m[r][2], m[r][3]);
+		}
+
+		__m128 cx = _mm_loadu_ps(&in.mCenterX[i]);
+		__m128 cy = _mm_loadu_ps(&in.mCenterY[i]);
+		__m128 cz = _mm_loadu_ps(&in.mCenterZ[i]);
+		__m128 ex = _mm_loadu_ps(&in.mExtentX[i]);
+		__m128 ey = _mm_loadu_ps(&in.mExtentY[i]);
+		__m128 ez = _mm_loadu_ps(&in.mExtentZ[i]);
+
+		__m128 newCenter[3];
+		__m128 newExtent[3];
+		for (int c = 0; c < 3; c++)
+		{
+			newCenter[c] = Simd::MulAdd(cx, m[0][c], m[3][c]);
+			newCenter[c] = Simd::MulAdd(cy, m[1][c], newCenter[c]);
+			newCenter[c] = Simd::MulAdd(cz, m[2][c], newCenter[c]);
+
+			newExtent[c] = _mm_mul_ps(ex, _mm_and_ps(m[0][c], absMask));
+			newExtent[c] = Simd::MulAdd(ey, _mm_and_ps(m[1][c], absMask), newExtent[c]);
+			newExtent[c] = Simd::MulAdd(ez, _mm_and_ps(m[2][c], absMask), newExtent[c]);
+		}
+
+		_mm_storeu_ps(&out.mCenterX[i], newCenter[0]);
+		_mm_storeu_ps(&out.mCenterY[i], newCenter[1]);
+		_mm_storeu_ps(&out.mCenterZ[i], newCenter[2]);
+		_mm_storeu_ps(&out.mExtentX[i], newExtent[0]);
+		_mm_storeu_ps(&out.mExtentY[i], newExtent[1]);
+		_mm_storeu_ps(&out.mExtentZ[i], newExtent[2]);
+	}
+#endif
+
+	// Leftovers (or everything, without SSE) one at a time
+	for (; i < count; i++)
+	{
+		const float (&m)[4][4] = transforms[i].mat;
+		float cx = in.mCenterX[i];
+		float cy = in.mCenterY[i];
+		float cz = in.mCenterZ[i];
+		float ex = in.mExtentX[i];
+		float ey = in.mExtentY[i];
+		float ez = in.mExtentZ[i];
+
+		out.mCenterX[i] = cx * m[0][0] + cy * m[1][0] + cz * m[2][0] + m[3][0];
+		out.mCenterY[i] = cx * m[0][1] + cy * m[1][1] + cz * m[2][1] + m[3][1];
+		out.mCenterZ[i] = cx * m[0][2] + cy * m[1][2] + cz * m[2][2] + m[3][2];
+		out.mExtentX[i] = ex * Math::Abs(m[0][0]) + ey * Math::Abs(m[1][0]) + ez * Math::Abs(m[2][0]);
+		out.mExtentY[i] = ex * Math::Abs(m[0][1]) + ey * Math::Abs(m[1][1]) + ez * Math::Abs(m[2][1]);
+		out.mExtentZ[i] = ex * Math::Abs(m[0][2]) + ey * Math::Abs(m[1][2]) + ez * Math::Abs(m[2][2]);
+	}
+}
+
+void Frustum::ExtractFromMatrix(const Matrix4& viewProj)
+{
+	// With row vectors, clip space component j is the point dotted with
+	// column j, so each plane is a sum or difference of two columns
+	const float (&m)[4][4] = viewProj.mat;
+	float planes[6][4];
+	for (int i = 0; i < 4; i++)
+	{
+		// Left: x >= -w, right: x <= w
+		planes[0][i] = m[i][3] + m[i][0];
+		planes[1][i] = m[i][3] - m[i][0];
+		// Bottom: y >= -w, top: y <= w
+		planes[2][i] = m[i][3] + m[i][1];
+		planes[3][i] = m[i][3] - m[i][1];
+		// Near: z >= 0, far: z <= w
+		planes[4][i] = m[i][2];
+		planes[5][i] = m[i][3] - m[i][2];
+	}
+
+	for (int p = 0; p < 6; p++)
+	{
+		Vector3 normal(planes[p][0], planes[p][1], planes[p][2]);
+		float length = normal.Length();
+		float invLength = length > 0.0f ? 1.0f / length : 0.0f;
+		mNormals[p] = normal * invLength;
+		mDistances[p] = planes[p][3] * invLength;
+	}
+}
+
+void BoxStreams::Clear()
+{
+	mCenterX.clear();
+	mCenterY.clear();
+	mCenterZ.clear();
+	mExtentX.clear();
+	mExtentY.clear();
+	mExtentZ.clear();
+}
+
+void BoxStreams::Resize(size_t count)
+{
+	mCenterX.resize(count);
+	mCenterY.resize(count);
+	mCenterZ.resize(count);
+	mExtentX.resize(count);
+	mExtentY.resize(count);
+	mExtentZ.resize(count);
+}
+
+void BoxStreams::Add(const AxisAlignedBox& box)
+{
+	mCenterX.push_back((box.mMin.x + box.mMax.x) * 0.5f);
+	mCenterY.push_back((box.mMin.y + box.mMax.y) * 0.5f);
+	mCenterZ.push_back((box.mMin.z + box.mMax.z) * 0.5f);
+	mExtentX.push_back((box.mMax.x - box.mMin.x) * 0.5f);
+	mExtentY.push_back((box.mMax.y - box.mMin.y) * 0.5f);
+	mExtentZ.push_back((box.mMax.z - box.mMin.z) * 0.5f);
+}
+
+size_t CullBoxes(const Frustum& frustum, const BoxStreams& boxes, std::vector<uint8_t>& outVisible)
+{
+	size_t count = boxes.Size();
+	outVisible.resize(count);
+	size_t numVisible = 0;
+
+	// A box is outside a plane if even its corner furthest along the
+	// normal is behind it: dot(n, center) + d + dot(|n|, extents) < 0
+	size_t i = 0;
+#if MATH_SSE
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 cx = _mm_loadu_ps(&boxes.mCenterX[i]);
+		__m128 cy = _mm_loadu_ps(&boxes.mCenterY[i]);
+		__m128 cz = _mm_loadu_ps(&boxes.mCenterZ[i]);
+		__m128 ex = _mm_loadu_ps(&boxes.mExtentX[i]);
+		__m128 ey = _mm_loadu_ps(&boxes.mExtentY[i]);
+		__m128 ez = _mm_loadu_ps(&boxes.mExtentZ[i]);
+
+		__m128 outside = _mm_setzero_ps();
+		for (int p = 0; p < 6; p++)
+		{
+			const Vector3& n = frustum.mNormals[p];
+			__m128 dist = Simd::MulAdd(cx, _mm_set_ps1(n.x), _mm_set_ps1(frustum.mDistances[p]));
+			dist = Simd::MulAdd(cy, _mm_set_ps1(n.y), dist);
+			dist = Simd::MulAdd(cz, _mm_set_ps1(n.z), dist);
+			dist = Simd::MulAdd(ex, _mm_set_ps1(Math::Abs(n.x)), dist);
+			dist = Simd::MulAdd(ey, _mm_set_ps1(Math::Abs(n.y)), dist);
+			dist = Simd::MulAdd(ez, _mm_set_ps1(Math::Abs(n.z)), dist);
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_setzero_ps()));
+		}
+
+		int outsideMask = _mm_movemask_ps(outside);
+		for (size_t j = 0; j < 4; j++)
+		{
+			uint8_t visible = (outsideMask & (1 << j)) ? 0 : 1;
+			outVisible[i + j] = visible;
+			numVisible += visible;
+		}
+	}
+#endif
+
+	// Leftovers (or everything, without SSE) one at a time
+	for (; i < count; i++)
+	{
+		uint8_t visible = 1;
+		for (int p = 0; p < 6; p++)
+		{
+			const Vector3& n = frustum.mNormals[p];
+			float dist = n.x * boxes.mCenterX[i] + n.y * boxes.mCenterY[i] + n.z * boxes.mCenterZ[i] +
+				frustum.mDistances[p] +
+				Math::Abs(n.x) * boxes.mExtentX[i] + Math::Abs(n.y) * boxes.mExtentY[i] +
+				Math::Abs(n.z) * boxes.mExtentZ[i];
+			if (dist < 0.0f)
+			{
+				visible = 0;
+				break;
+			}
+		}
+		outVisible[i] = visible;
+		numVisible += visible;
+	}
+
+	return numVisible;
+}
+
 } // namespace
@@ -1,5 +1,6 @@
 #pragma once
 #include "Math.h"
+#include <vector>
 
 // Put this in a separate namespace to avoid conflicts
 namespace Collision
@@ -47,9 +48,55 @@ namespace Collision
 		}
 	};
 
+	// The six planes of a camera's view volume
+	// The normals point inward, so a point is inside when
+	// Dot(mNormals[i], point) + mDistances[i] >= 0 for every plane
+	struct Frustum
+	{
+		Vector3 mNormals[6];
+		float mDistances[6];
+
+		// Pulls the planes out of a view * projection matrix
+		// (row vectors, with D3D's 0 to 1 depth range)
+		void ExtractFromMatrix(const Matrix4& viewProj);
+	};
+
+	// Boxes in center/extents form with one array per component,
+	// so they can be tested four at a time
+	struct BoxStreams
+	{
+		std::vector<float> mCenterX;
+		std::vector<float> mCenterY;
+		std::vector<float> mCenterZ;
+		std::vector<float> mExtentX;
+		std::vector<float> mExtentY;
+		std::vector<float> mExtentZ;
+
+		void Clear();
+		void Resize(size_t count);
+		void Add(const AxisAlignedBox& box);
+		size_t Size() const { return mCenterX.size(); }
+	};
+
 	// Helper functions for a variety of intersections
 	bool Intersects(const Sphere& a, const Sphere& b);
 	bool Intersects(const AxisAlignedBox& a, const AxisAlignedBox& b);
 
 	bool SegmentCast(const LineSegment& segment, const AxisAlignedBox& box, Vector3& outPoint);
+
+	// Returns the axis-aligned box that bounds box after it's transformed
+	// by mat (Arvo's method, so it's correct under rotation)
+	AxisAlignedBox TransformBox(const AxisAlignedBox& box, const Matrix4& mat);
+
+	// Same as above for count boxes at once (in may equal out)
+	void TransformBoxes(const AxisAlignedBox* in, AxisAlignedBox* out, size_t count, const Matrix4& mat);
+
+	// Transforms box i of in by transforms[i], four boxes at a time
+	// out is resized to match, and may be the same as in
+	void TransformBoxes(const BoxStreams& in, const Matrix4* transforms, BoxStreams& out);
+
+	// Sets outVisible[i] to 1 if box i is at least partly inside the
+	// frustum (conservatively, so a box near a corner may pass) and 0 if not
+	// Returns how many boxes are visible
+	size_t CullBoxes(const Frustum& frustum, const BoxStreams& boxes, std::vector<uint8_t>& outVisible);
 }
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "ITPEnginePCH.h"
+#include "SelfTest.h"
+
+namespace
+{
+	const int kNumBoxes = 1001;
+
+	Collision::AxisAlignedBox RandomBox()
+	{
+		Vector3 center = Random::GetVector(Vector3(-50.0f, -50.0f, -50.0f), Vector3(50.0f, 50.0f, 50.0f));
+		Vector3 extents = Random::GetVector(Vector3(0.1f, 0.1f, 0.1f), Vector3(10.0f, 10.0f, 10.0f));
+		Collision::AxisAlignedBox box;
+		box.mMin = center - extents;
+		box.mMax = center + extents;
+		return box;
+	}
+
+	Matrix4 RandomTransform()
+	{
+		Vector3 axis = Random::GetVector(Vector3(-1.0f, -1.0f, -1.0f), Vector3(1.0f, 1.0f, 1.0f));
+		if (axis.LengthSq() < 0.01f)
+		{
+			axis = Vector3::UnitZ;
+		}
+		axis.Normalize();
+		Quaternion rotation(axis, Random::GetFloatRange(-Math::Pi, Math::Pi));
+		Vector3 scale = Random::GetVector(Vector3(0.25f, 0.25f, 0.25f), Vector3(4.0f, 4.0f, 4.0f));
+		Vector3 translation = Random::GetVector(Vector3(-100.0f, -100.0f, -100.0f), Vector3(100.0f, 100.0f, 100.0f));
+		return Matrix4::CreateScale(scale) * Matrix4::CreateFromQuaternion(rotation) *
+			Matrix4::CreateTranslation(translation);
+	}
+
+	// Brute force version of CullBoxes' test: a box is outside if all
+	// eight of its corners are behind the same plane. Sets nearEdge if
+	// the answer depends on float rounding.
+	bool IsBoxVisible(const Collision::Frustum& frustum, const Collision::AxisAlignedBox& box, bool& nearEdge)
+	{
+		nearEdge = false;
+		for (int p = 0; p < 6; p++)
+		{
+			float maxDist = -FLT_MAX;
+			for (int corner = 0; corner < 8; corner++)
+			{
+				Vector3 point((corner & 1) ? box.mMax.x : box.mMin.x,
+					(corner & 2) ? box.mMax.y : box.mMin.y,
+					(corner & 4) ? box.mMax.z : box.mMin.z);
+				maxDist = max(maxDist, Dot(frustum.mNormals[p], point) + frustum.mDistances[p]);
+			}
+
+			nearEdge |= Math::Abs(maxDist) < 1e-2f;
+			if (maxDist < 0.0f)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+void SelfTest::RunCollisionTests()
+{
+	// The BoxStreams version of TransformBoxes gives the same boxes as
+	// TransformBox, including the leftovers past the last group of four
+	std::vector<Collision::AxisAlignedBox> boxes;
+	std::vector<Matrix4> transforms;
+	Collision::BoxStreams local;
+	for (int i = 0; i < kNumBoxes; i++)
+	{
+		boxes.push_back(RandomBox());
+		transforms.push_back(RandomTransform());
+		local.Add(boxes.back());
+	}
+
+	Collision::BoxStreams world;
+	Collision::TransformBoxes(local, transforms.data(), world);
+	bool streamsMatch = world.Size() == boxes.size();
+	for (size_t i = 0; i < boxes.size() && streamsMatch; i++)
+	{
+		Collision::AxisAlignedBox expected = Collision::TransformBox(boxes[i], transforms[i]);
+		Vector3 center = (expected.mMin + expected.mMax) * 0.5f;
+		Vector3 extents = (expected.mMax - expected.mMin) * 0.5f;
+		streamsMatch &= IsNear(world.mCenterX[i], center.x, 1e-3f) &&
+			IsNear(world.mCenterY[i], center.y, 1e-3f) &&
+			IsNear(world.mCenterZ[i], center.z, 1e-3f) &&
+			IsNear(world.mExtentX[i], extents.x, 1e-3f) &&
+			IsNear(world.mExtentY[i], extents.y, 1e-3f) &&
+			IsNear(world.mExtentZ[i], extents.z, 1e-3f);
+	}
+	SELF_CHECK(streamsMatch);
+
+	// Transforming in place works too
+	Collision::TransformBoxes(local, transforms.data(), local);
+	bool inPlaceMatches = true;
+	for (size_t i = 0; i < boxes.size(); i++)
+	{
+		inPlaceMatches &= local.mCenterX[i] == world.mCenterX[i] &&
+			local.mExtentZ[i] == world.mExtentZ[i];
+	}
+	SELF_CHECK(inPlaceMatches);
+
+	// CullBoxes agrees with testing every corner, for boxes all around
+	// the camera (and a count that isn't a multiple of four)
+	Matrix4 view = Matrix4::CreateLookAt(Vector3::Zero, Vector3::UnitX, Vector3::UnitZ);
+	Matrix4 proj = Matrix4::CreatePerspectiveFOV(Math::ToRadians(70.0f), 1024.0f, 768.0f, 25.0f, 10000.0f);
+	Collision::Frustum frustum;
+	frustum.ExtractFromMatrix(view * proj);
+
+	Collision::BoxStreams cullBoxes;
+	boxes.clear();
+	for (int i = 0; i < kNumBoxes; i++)
+	{
+		Vector3 center = Random::GetVector(Vector3(-12000.0f, -12000.0f, -12000.0f), Vector3(12000.0f, 12000.0f, 12000.0f));
+		float extent = Random::GetFloatRange(1.0f, 2000.0f);
+		Collision::AxisAlignedBox box;
+		box.mMin = center - Vector3(extent, extent, extent);
+		box.mMax = center + Vector3(extent, extent, extent);
+		boxes.push_back(box);
+		cullBoxes.Add(box);
+	}
+
+	std::vector<uint8_t> visible;
+	size_t numVisible = Collision::CullBoxes(frustum, cullBoxes, visible);
+	bool cullMatches = visible.size() == boxes.size();
+	size_t expectedVisible = 0;
+	for (size_t i = 0; i < boxes.size() && cullMatches; i++)
+	{
+		bool nearEdge;
+		bool expected = IsBoxVisible(frustum, boxes[i], nearEdge);
+		expectedVisible += expected ? 1 : 0;
+		cullMatches &= nearEdge || (visible[i] != 0) == expected;
+	}
+	SELF_CHECK(cullMatches);
+	SELF_CHECK(numVisible == expectedVisible);
+	// Make sure both answers actually came up
+	SELF_CHECK(numVisible > 0 && numVisible < boxes.size());
+
+	// Straight ahead is in, behind the camera and past the far plane are out
+	Collision::AxisAlignedBox ahead;
+	ahead.mMin = Vector3(500.0f, -10.0f, -10.0f);
+	ahead.mMax = Vector3(520.0f, 10.0f, 10.0f);
+	Collision::AxisAlignedBox behind;
+	behind.mMin = Vector3(-520.0f, -10.0f, -10.0f);
+	behind.mMax = Vector3(-500.0f, 10.0f, 10.0f);
+	Collision::AxisAlignedBox tooFar;
+	tooFar.mMin = Vector3(10500.0f, -10.0f, -10.0f);
+	tooFar.mMax = Vector3(10520.0f, 10.0f, 10.0f);
+	cullBoxes.Clear();
+	cullBoxes.Add(ahead);
+	cullBoxes.Add(behind);
+	cullBoxes.Add(tooFar);
+	SELF_CHECK(Collision::CullBoxes(frustum, cullBoxes, visible) == 1);
+	SELF_CHECK(visible[0] == 1 && visible[1] == 0 && visible[2] == 0);
+}
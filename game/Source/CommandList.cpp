@@ -0,0 +1,91 @@
+#include "ITPEnginePCH.h"
+#include "CommandList.h"
+
+CommandList::CommandList()
+	:mShader(nullptr)
+	,mTexture(nullptr)
+	,mVertexArray(nullptr)
+	,mInstanced(false)
+{
+
+}
+
+void CommandList::Clear()
+{
+	mCommands.clear();
+	mShader = nullptr;
+	mTexture = nullptr;
+	mVertexArray = nullptr;
+	mInstanced = false;
+}
+
+CommandList::Command& CommandList::Add(EType type, void* object)
+{
+	mCommands.emplace_back();
+	Command& command = mCommands.back();
+	command.mType = type;
+	command.mObject = object;
+	return command;
+}
+
+void CommandList::SetShader(Shader* shader)
+{
+	if (shader != mShader)
+	{
+		Add(ET_SetShader, shader);
+		mShader = shader;
+	}
+}
+
+void CommandList::SetTexture(Texture* texture)
+{
+	if (texture != mTexture)
+	{
+		Add(ET_SetTexture, texture);
+		mTexture = texture;
+	}
+}
+
+void CommandList::SetVertexArray(VertexArray* vertexArray, bool instanced)
+{
+	if (vertexArray != mVertexArray || instanced != mInstanced)
+	{
+		Add(ET_SetVertexArray, vertexArray);
+		if (instanced)
+		{
+			Add(ET_SetInstanceStream, nullptr);
+		}
+		mVertexArray = vertexArray;
+		mInstanced = instanced;
+	}
+}
+
+void CommandList::SetConstantRange(uint32_t slot, uint32_t firstConstant, uint32_t numConstants)
+{
+	Command& command = Add(ET_SetConstantRange, nullptr);
+	command.mArgs[0] = slot;
+	command.mArgs[1] = firstConstant;
+	command.mArgs[2] = numConstants;
+}
+
+void CommandList::UploadObjectConstants(uint32_t sortedIndex)
+{
+	Command& command = Add(ET_UploadObjectConstants, nullptr);
+	command.mArgs[0] = sortedIndex;
+}
+
+void CommandList::DrawIndexed(uint32_t indexCount, uint32_t startIndex)
+{
+	Command& command = Add(ET_DrawIndexed, nullptr);
+	command.mArgs[0] = indexCount;
+	command.mArgs[1] = startIndex;
+}
+
+void CommandList::DrawIndexedInstanced(uint32_t indexCount, uint32_t startIndex, uint32_t instanceCount, uint32_t firstInstance)
+{
+	Command& command = Add(ET_DrawIndexedInstanced, nullptr);
+	command.mArgs[0] = indexCount;
+	command.mArgs[1] = startIndex;
+	command.mArgs[2] = instanceCount;
+	command.mArgs[3] = firstInstance;
+}
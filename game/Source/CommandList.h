@@ -0,0 +1,68 @@
+// CommandList.h
+// A list of draw commands recorded ahead of time, so several threads
+// can each record part of a frame and the results are replayed in
+// order on the graphics driver afterwards (see Renderer::ExecuteCommandList).
+// Recording doesn't touch the driver, and objects are only referenced
+// by pointer, so they have to stay alive until the list is replayed.
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+class CommandList
+{
+public:
+	enum EType
+	{
+		// mObject is a Shader
+		ET_SetShader,
+		// mObject is a Texture, bound to slot 0
+		ET_SetTexture,
+		// mObject is a VertexArray
+		ET_SetVertexArray,
+		// Switches the current vertex array to the instanced layout and
+		// binds the instance buffer
+		ET_SetInstanceStream,
+		// Binds part of the frame's constant buffer
+		// mArgs = slot, first constant, number of constants
+		ET_SetConstantRange,
+		// Uploads the current shader's per object constants (and palette)
+		// mArgs = which RenderQueue::GetSorted command they're for
+		ET_UploadObjectConstants,
+		// mArgs = index count, start index
+		ET_DrawIndexed,
+		// mArgs = index count, start index, instance count, first instance
+		ET_DrawIndexedInstanced,
+	};
+
+	struct Command
+	{
+		EType mType;
+		uint32_t mArgs[4];
+		void* mObject;
+	};
+
+	CommandList();
+
+	void Clear();
+
+	// These skip any shader, texture or vertex array that's already set
+	// earlier in this list
+	void SetShader(class Shader* shader);
+	void SetTexture(class Texture* texture);
+	void SetVertexArray(class VertexArray* vertexArray, bool instanced);
+	void SetConstantRange(uint32_t slot, uint32_t firstConstant, uint32_t numConstants);
+	void UploadObjectConstants(uint32_t sortedIndex);
+	void DrawIndexed(uint32_t indexCount, uint32_t startIndex);
+	void DrawIndexedInstanced(uint32_t indexCount, uint32_t startIndex, uint32_t instanceCount, uint32_t firstInstance);
+
+	const std::vector<Command>& GetCommands() const { return mCommands; }
+private:
+	Command& Add(EType type, void* object);
+
+	std::vector<Command> mCommands;
+	class Shader* mShader;
+	class Texture* mTexture;
+	class VertexArray* mVertexArray;
+	bool mInstanced;
+};
@@ -0,0 +1,120 @@
+#include "ITPEnginePCH.h"
+#include "SelfTest.h"
+#include "CommandList.h"
+#include "JobSystem.h"
+
+namespace
+{
+	const uint32_t kNumDraws = 5000;
+	const uint32_t kDrawsPerList = 128;
+
+	// Recording only stores the pointers, so these never get used
+	template <typename T>
+	T* FakePointer(uintptr_t id)
+	{
+		return reinterpret_cast<T*>(0x1000 + id * 16);
+	}
+
+	// Records draws [first, last) the way Renderer::RecordBatches does,
+	// with state that changes at different rates
+	void RecordDraws(CommandList& list, uint32_t first, uint32_t last)
+	{
+		for (uint32_t i = first; i < last; i++)
+		{
+			list.SetShader(FakePointer<Shader>(i / 1000));
+			list.SetTexture(FakePointer<Texture>(i / 100));
+			list.SetVertexArray(FakePointer<VertexArray>(i / 10), (i / 50) % 2 == 1);
+			list.SetConstantRange(1, i * 16, 16);
+			list.UploadObjectConstants(i);
+			list.DrawIndexed(36, i * 3);
+		}
+	}
+
+	bool SameCommand(const CommandList::Command& a, const CommandList::Command& b)
+	{
+		return a.mType == b.mType && a.mObject == b.mObject &&
+			memcmp(a.mArgs, b.mArgs, sizeof(a.mArgs)) == 0;
+	}
+}
+
+void SelfTest::RunCommandListTests()
+{
+	// Redundant state is only skipped within a list
+	CommandList list;
+	list.SetShader(FakePointer<Shader>(1));
+	list.SetShader(FakePointer<Shader>(1));
+	list.SetTexture(FakePointer<Texture>(2));
+	list.SetTexture(FakePointer<Texture>(2));
+	list.SetVertexArray(FakePointer<VertexArray>(3), false);
+	list.SetVertexArray(FakePointer<VertexArray>(3), false);
+	SELF_CHECK(list.GetCommands().size() == 3);
+
+	// Switching the same vertex array to instanced binds it again, with
+	// the instance stream
+	list.SetVertexArray(FakePointer<VertexArray>(3), true);
+	list.SetVertexArray(FakePointer<VertexArray>(3), true);
+	SELF_CHECK(list.GetCommands().size() == 5);
+	SELF_CHECK(list.GetCommands()[3].mType == CommandList::ET_SetVertexArray);
+	SELF_CHECK(list.GetCommands()[4].mType == CommandList::ET_SetInstanceStream);
+
+	// Arguments land in the documented slots
+	list.SetConstantRange(2, 64, 16);
+	list.UploadObjectConstants(7);
+	list.DrawIndexedInstanced(36, 12, 5, 40);
+	const std::vector<CommandList::Command>& commands = list.GetCommands();
+	SELF_CHECK(commands.size() == 8);
+	SELF_CHECK(commands[5].mType == CommandList::ET_SetConstantRange &&
+		commands[5].mArgs[0] == 2 && commands[5].mArgs[1] == 64 && commands[5].mArgs[2] == 16);
+	SELF_CHECK(commands[6].mType == CommandList::ET_UploadObjectConstants && commands[6].mArgs[0] == 7);
+	SELF_CHECK(commands[7].mType == CommandList::ET_DrawIndexedInstanced &&
+		commands[7].mArgs[0] == 36 && commands[7].mArgs[1] == 12 &&
+		commands[7].mArgs[2] == 5 && commands[7].mArgs[3] == 40);
+
+	// Clear forgets the state too, so a reused list sets it again
+	list.Clear();
+	list.SetShader(FakePointer<Shader>(1));
+	SELF_CHECK(list.GetCommands().size() == 1);
+
+	// Recording lists in parallel gives the same commands, in the same
+	// order, as recording each of them on this thread
+	uint32_t numLists = (kNumDraws + kDrawsPerList - 1) / kDrawsPerList;
+	std::vector<CommandList> expected(numLists);
+	for (uint32_t l = 0; l < numLists; l++)
+	{
+		RecordDraws(expected[l], l * kDrawsPerList, min(kNumDraws, (l + 1) * kDrawsPerList));
+	}
+
+	JobSystem jobs;
+	jobs.Init(3);
+	std::vector<CommandList> lists(numLists);
+	// Record twice, so the second pass reuses cleared lists like the renderer does
+	for (int pass = 0; pass < 2; pass++)
+	{
+		jobs.ParallelFor(numLists, 1, [&lists](size_t firstList, size_t lastList)
+		{
+			for (size_t l = firstList; l < lastList; l++)
+			{
+				uint32_t first = static_cast<uint32_t>(l) * kDrawsPerList;
+				lists[l].Clear();
+				RecordDraws(lists[l], first, min(kNumDraws, first + kDrawsPerList));
+			}
+		});
+	}
+	jobs.Shutdown();
+
+	bool parallelMatches = true;
+	size_t numDraws = 0;
+	for (uint32_t l = 0; l < numLists; l++)
+	{
+		const std::vector<CommandList::Command>& actual = lists[l].GetCommands();
+		const std::vector<CommandList::Command>& reference = expected[l].GetCommands();
+		parallelMatches &= actual.size() == reference.size();
+		for (size_t i = 0; i < actual.size() && parallelMatches; i++)
+		{
+			parallelMatches &= SameCommand(actual[i], reference[i]);
+			numDraws += actual[i].mType == CommandList::ET_DrawIndexed ? 1 : 0;
+		}
+	}
+	SELF_CHECK(parallelMatches);
+	SELF_CHECK(numDraws == kNumDraws);
+}
@@ -1,49 +1,114 @@
 #pragma once
-#include <memory>
+#include <cstddef>
+#include <new>
+#include <type_traits>
 // Some C++11 template magic to help implement delegates
 
-// The base timer delegate struct is used simply
-// to wrap a function call that takes no parameters
-// and returns void
-template <typename ...Params>
-struct DelegateBase
-{
-	virtual ~DelegateBase() {}
-
-	// Function call operator
-	virtual void Execute(Params...) { }
-};
-
-// This templated class is where (some of) the magic happens.
-// We store a pointer to the templated type as well
-// as a pointer to the function we want to call
+// A Delegate wraps a call to a member function, a free function,
+// or a small lambda, with the given parameters and a void return.
+// Everything is stored inline in the Delegate itself, so creating,
+// copying and calling one never touches the heap, and calls go
+// through a plain function pointer rather than a virtual function.
 // (Don't worry if this code doesn't make sense...
 // basically, it's just a fancy function object)
-template <typename T, typename ...Params>
-struct Delegate : public DelegateBase<Params...>
+
+// Never defined -- a pointer to a member of an unknown class is
+// the largest kind of member function pointer on every compiler
+class DelegateUnknownClass;
+
+template <typename ...Params>
+class Delegate
 {
-	// This typedefs "FuncPtr" as a pointer to a
-	// member function of class T
-	typedef void (T::*FuncPtr)(Params...);
-
-	// Construct a timer delegate given an object
-	// and a pointer to a function
-	Delegate(T* obj, FuncPtr func)
-		:mObj(obj)
-		,mFunc(func)
+public:
+	// An empty delegate does nothing when executed
+	Delegate()
+		:mStub(nullptr)
 	{ }
 
-	// Call the function bound to this
-	virtual void Execute(Params... p) override
+	// Construct a delegate given an object
+	// and a pointer to a member function
+	template <typename T>
+	Delegate(T* obj, void (T::*func)(Params...))
+	{
+		BoundMember<T> bound;
+		bound.mObj = obj;
+		bound.mFunc = func;
+		Store(bound, &CallMember<T>);
+	}
+
+	// Construct a delegate from a free (or static) function
+	Delegate(void (*func)(Params...))
+	{
+		Store(func, &CallFunction);
+	}
+
+	// Construct a delegate from a lambda or other function object.
+	// It has to be small and trivially copyable, which covers
+	// lambdas capturing this and/or a few values.
+	template <typename Func, typename = typename std::enable_if<
+		!std::is_same<typename std::decay<Func>::type, Delegate>::value &&
+		!std::is_member_pointer<typename std::decay<Func>::type>::value>::type>
+	Delegate(Func func)
 	{
-		(mObj->*mFunc)(p...);
+		Store(func, &CallFunctor<Func>);
 	}
+
+	// Call the function bound to this (if any)
+	void Execute(Params... p) const
+	{
+		if (mStub)
+		{
+			mStub(&mStorage, p...);
+		}
+	}
+
+	bool IsBound() const { return mStub != nullptr; }
+	explicit operator bool() const { return IsBound(); }
+
+	void Unbind() { mStub = nullptr; }
 private:
-	T* mObj;
-	FuncPtr mFunc;
-};
+	typedef void (*StubPtr)(const void* storage, Params... p);
 
-template <typename T>
-using DelegateNoParams = Delegate<T>;
+	template <typename T>
+	struct BoundMember
+	{
+		T* mObj;
+		void (T::*mFunc)(Params...);
+	};
 
-using DelegateNoParamsPtr = std::shared_ptr<DelegateBase<>>;
+	// Enough room for an object pointer plus the largest member function pointer
+	static const size_t StorageSize = sizeof(void*) + sizeof(void (DelegateUnknownClass::*)());
+
+	template <typename T>
+	void Store(const T& value, StubPtr stub)
+	{
+		static_assert(sizeof(T) <= StorageSize, "Delegate target is too big to store inline");
+		static_assert(std::is_trivially_copyable<T>::value, "Delegate target must be trivially copyable");
+		new (&mStorage) T(value);
+		mStub = stub;
+	}
+
+	template <typename T>
+	static void CallMember(const void* storage, Params... p)
+	{
+		const BoundMember<T>* bound = static_cast<const BoundMember<T>*>(storage);
+		(bound->mObj->*bound->mFunc)(p...);
+	}
+
+	static void CallFunction(const void* storage, Params... p)
+	{
+		typedef void (*FuncPtr)(Params...);
+		(*static_cast<const FuncPtr*>(storage))(p...);
+	}
+
+	template <typename Func>
+	static void CallFunctor(const void* storage, Params... p)
+	{
+		// Allow mutable lambdas, but delegates are copied freely,
+		// so don't count on captured state sticking around
+		(*const_cast<Func*>(static_cast<const Func*>(storage)))(p...);
+	}
+
+	typename std::aligned_storage<StorageSize, alignof(double)>::type mStorage;
+	StubPtr mStub;
+};
@@ -27,3 +27,8 @@ void DrawComponent::Draw(class Renderer& render)
 {
 
 }
+
+bool DrawComponent::GetLocalBounds(Collision::AxisAlignedBox& outBounds)
+{
+	return false;
+}
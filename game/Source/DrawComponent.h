@@ -3,6 +3,7 @@
 
 #pragma once
 #include "Component.h"
+#include "CollisionHelpers.h"
 
 class DrawComponent : public Component
 {
@@ -15,6 +16,11 @@ public:
 	
 	virtual void Draw(class Renderer& render);
 
+	// Bounds in the owner's local space, for frustum culling. Renderer
+	// moves them into world space in one batch. Components that return
+	// false are always drawn.
+	virtual bool GetLocalBounds(Collision::AxisAlignedBox& outBounds);
+
 	void SetIsVisible(bool value) { mIsVisible = value; }
 	bool IsVisible() const { return mIsVisible; }
 private:
@@ -0,0 +1,36 @@
+#include "ITPEnginePCH.h"
+
+size_t EventBus::sNextTypeIndex = 0;
+
+EventBus::EventBus()
+{
+
+}
+
+EventBus::~EventBus()
+{
+
+}
+
+void EventBus::Dispatch()
+{
+	// Index loop, since a subscriber could create a brand new channel
+	for (size_t i = 0; i < mChannels.size(); i++)
+	{
+		if (mChannels[i])
+		{
+			mChannels[i]->Dispatch();
+		}
+	}
+}
+
+void EventBus::ClearQueues()
+{
+	for (auto& channel : mChannels)
+	{
+		if (channel)
+		{
+			channel->ClearQueue();
+		}
+	}
+}
@@ -0,0 +1,112 @@
+// EventBus.h
+// Typed, queued gameplay events. Anything can queue an event during
+// the frame, and Game dispatches every queue once per frame, one
+// event type at a time, to everyone subscribed to that type.
+
+#pragma once
+#include <memory>
+#include <vector>
+#include "MulticastDelegate.h"
+
+class EventBus
+{
+public:
+	EventBus();
+	~EventBus();
+
+	// Subscribes a member function to every event of EventType
+	// Usage: bus.Subscribe<TouchEvent>(this, &MyActor::OnTouch);
+	template <typename EventType, typename T>
+	DelegateHandle Subscribe(T* obj, void (T::*func)(const EventType&))
+	{
+		return GetChannel<EventType>().mSubscribers.Add(obj, func);
+	}
+
+	// Same as above, but with any delegate (such as a lambda)
+	template <typename EventType>
+	DelegateHandle Subscribe(const Delegate<const EventType&>& delegate)
+	{
+		return GetChannel<EventType>().mSubscribers.Add(delegate);
+	}
+
+	template <typename EventType>
+	void Unsubscribe(DelegateHandle handle)
+	{
+		GetChannel<EventType>().mSubscribers.Remove(handle);
+	}
+
+	// Queues an event, to be sent out at the next Dispatch
+	template <typename EventType>
+	void Queue(const EventType& event)
+	{
+		GetChannel<EventType>().mQueue.push_back(event);
+	}
+
+	// Sends out all queued events, grouped by type
+	// Events queued by a subscriber wait for the next Dispatch
+	void Dispatch();
+
+	// Drops any queued events without sending them
+	void ClearQueues();
+private:
+	struct ChannelBase
+	{
+		virtual ~ChannelBase() { }
+		virtual void Dispatch() = 0;
+		virtual void ClearQueue() = 0;
+	};
+
+	template <typename EventType>
+	struct Channel : public ChannelBase
+	{
+		void Dispatch() override
+		{
+			// Swap so that anything queued during dispatch goes to the next batch
+			mDispatching.swap(mQueue);
+			for (auto& event : mDispatching)
+			{
+				mSubscribers.Broadcast(event);
+			}
+			mDispatching.clear();
+		}
+
+		void ClearQueue() override
+		{
+			mQueue.clear();
+		}
+
+		MulticastDelegate<const EventType&> mSubscribers;
+		std::vector<EventType> mQueue;
+		std::vector<EventType> mDispatching;
+	};
+
+	template <typename EventType>
+	Channel<EventType>& GetChannel()
+	{
+		size_t index = TypeIndex<EventType>();
+		if (index >= mChannels.size())
+		{
+			mChannels.resize(index + 1);
+		}
+
+		if (!mChannels[index])
+		{
+			mChannels[index].reset(new Channel<EventType>());
+		}
+
+		return static_cast<Channel<EventType>&>(*mChannels[index]);
+	}
+
+	// Hands out a small, dense index per event type (we don't have RTTI)
+	template <typename EventType>
+	static size_t TypeIndex()
+	{
+		static const size_t sIndex = sNextTypeIndex++;
+		return sIndex;
+	}
+
+	static size_t sNextTypeIndex;
+
+	// Indexed by TypeIndex, may contain empty slots
+	std::vector<std::unique_ptr<ChannelBase>> mChannels;
+};
@@ -0,0 +1,159 @@
+// FlatHashMap.h
+// Open addressing hash map from 64-bit keys (which are expected to
+// already be hashes, like AssetId) to values.
+// Keys and values are kept in flat arrays and collisions are resolved
+// with linear probing, so a lookup is a few compares in a row of
+// memory and never allocates.
+// Key 0 is reserved to mark empty slots.
+
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include "DbgAssert.h"
+
+template <typename V>
+class FlatHashMap
+{
+public:
+	FlatHashMap()
+		:mSize(0)
+	{ }
+
+	// Returns nullptr if the key isn't in the map
+	V* Find(uint64_t key)
+	{
+		if (mSize == 0)
+		{
+			return nullptr;
+		}
+
+		size_t mask = mKeys.size() - 1;
+		for (size_t i = Home(key); ; i = (i + 1) & mask)
+		{
+			if (mKeys[i] == key)
+			{
+				return &mValues[i];
+			}
+			else if (mKeys[i] == 0)
+			{
+				return nullptr;
+			}
+		}
+	}
+
+	// Adds a default constructed value for the key, which must not
+	// already be in the map. The reference is only valid until the
+	// next Insert or Erase
+	V& Insert(uint64_t key)
+	{
+		DbgAssert(key != 0, "Key 0 is reserved by FlatHashMap");
+		if ((mSize + 1) * 4 > mKeys.size() * 3)
+		{
+			Grow();
+		}
+
+		size_t mask = mKeys.size() - 1;
+		size_t i = Home(key);
+		while (mKeys[i] != 0)
+		{
+			DbgAssert(mKeys[i] != key, "Key is already in FlatHashMap");
+			i = (i + 1) & mask;
+		}
+
+		mKeys[i] = key;
+		mSize++;
+		return mValues[i];
+	}
+
+	// Returns false if the key wasn't in the map
+	bool Erase(uint64_t key)
+	{
+		if (mSize == 0)
+		{
+			return false;
+		}
+
+		size_t mask = mKeys.size() - 1;
+		size_t i = Home(key);
+		while (mKeys[i] != key)
+		{
+			if (mKeys[i] == 0)
+			{
+				return false;
+			}
+			i = (i + 1) & mask;
+		}
+
+		// Shift any displaced entries after this one back, so there
+		// are never any holes in a probe sequence (no tombstones needed)
+		for (size_t j = (i + 1) & mask; mKeys[j] != 0; j = (j + 1) & mask)
+		{
+			size_t home = Home(mKeys[j]);
+			if (((j - home) & mask) >= ((j - i) & mask))
+			{
+				mKeys[i] = mKeys[j];
+				mValues[i] = std::move(mValues[j]);
+				i = j;
+			}
+		}
+
+		mKeys[i] = 0;
+		mValues[i] = V();
+		mSize--;
+		return true;
+	}
+
+	void Clear()
+	{
+		mKeys.clear();
+		mValues.clear();
+		mSize = 0;
+	}
+
+	size_t Size() const { return mSize; }
+
+	// Calls func(key, value) for every entry
+	template <typename Func>
+	void ForEach(Func func)
+	{
+		for (size_t i = 0; i < mKeys.size(); i++)
+		{
+			if (mKeys[i] != 0)
+			{
+				func(mKeys[i], mValues[i]);
+			}
+		}
+	}
+private:
+	size_t Home(uint64_t key) const
+	{
+		// Fold the high bits in, in case the low bits are poorly mixed
+		return static_cast<size_t>(key ^ (key >> 32)) & (mKeys.size() - 1);
+	}
+
+	void Grow()
+	{
+		std::vector<uint64_t> oldKeys;
+		std::vector<V> oldValues;
+		oldKeys.swap(mKeys);
+		oldValues.swap(mValues);
+
+		size_t capacity = oldKeys.empty() ? 64 : oldKeys.size() * 2;
+		mKeys.assign(capacity, 0);
+		mValues.resize(capacity);
+		mSize = 0;
+
+		for (size_t i = 0; i < oldKeys.size(); i++)
+		{
+			if (oldKeys[i] != 0)
+			{
+				Insert(oldKeys[i]) = std::move(oldValues[i]);
+			}
+		}
+	}
+
+	std::vector<uint64_t> mKeys;
+	std::vector<V> mValues;
+	size_t mSize;
+};
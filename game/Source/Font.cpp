@@ -3,6 +3,7 @@
 
 Font::Font(class Game& game)
 	:Asset(game)
+	,mFileSize(0)
 {
 
 }
@@ -39,6 +40,13 @@ bool Font::Load(const char* fileName, class AssetCache* cache)
 		mFontData.emplace(size, font);
 	}
 
+	SDL_RWops* file = SDL_RWFromFile(fileName, "rb");
+	if (file)
+	{
+		mFileSize = static_cast<size_t>(SDL_RWsize(file));
+		SDL_RWclose(file);
+	}
+
 	return true;
 }
 
@@ -52,3 +60,41 @@ TTF_Font* Font::GetFontData(int pointSize)
 
 	return nullptr;
 }
+
+GlyphAtlasPtr Font::GetGlyphAtlas(int pointSize)
+{
+	auto iter = mGlyphAtlases.find(pointSize);
+	if (iter != mGlyphAtlases.end())
+	{
+		return iter->second;
+	}
+
+	TTF_Font* font = GetFontData(pointSize);
+	if (!font)
+	{
+		return nullptr;
+	}
+
+	GlyphAtlasPtr atlas = std::make_shared<GlyphAtlas>();
+	if (!atlas->Build(mGame, font))
+	{
+		atlas.reset();
+	}
+	// Remember failures too, so they aren't retried every SetText
+	mGlyphAtlases.emplace(pointSize, atlas);
+	return atlas;
+}
+
+size_t Font::GetMemorySize() const
+{
+	// Rough estimate: every point size keeps its own face open
+	size_t size = sizeof(Font) + mFontData.size() * mFileSize;
+	for (auto& atlas : mGlyphAtlases)
+	{
+		if (atlas.second)
+		{
+			size += atlas.second->GetTexture()->GetMemorySize();
+		}
+	}
+	return size;
+}
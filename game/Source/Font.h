@@ -2,6 +2,7 @@
 #include "Asset.h"
 #include <unordered_map>
 #include <SDL/SDL_ttf.h>
+#include "GlyphAtlas.h"
 
 class Font : public Asset
 {
@@ -11,10 +12,16 @@ public:
 	virtual ~Font();
 
 	bool Load(const char* fileName, class AssetCache* cache) override;
+	size_t GetMemorySize() const override;
 
 	TTF_Font* GetFontData(int pointSize);
+	// Built the first time a point size is asked for. Null if the size is unsupported.
+	GlyphAtlasPtr GetGlyphAtlas(int pointSize);
 private:
 	std::unordered_map<int, TTF_Font*> mFontData;
+	std::unordered_map<int, GlyphAtlasPtr> mGlyphAtlases;
+	// Size of the font file on disk
+	size_t mFileSize;
 };
 
 DECL_PTR(Font);
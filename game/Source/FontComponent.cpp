@@ -4,6 +4,7 @@ IMPL_COMPONENT(FontComponent, DrawComponent, 100);
 
 FontComponent::FontComponent(Actor& owner)
 	:Super(owner)
+	,mWidth(0.0f)
 	,mAlignment(AlignLeft)
 {
 
@@ -11,68 +12,91 @@ FontComponent::FontComponent(Actor& owner)
 
 void FontComponent::Draw(class Renderer& render)
 {
-	if (mTexture)
+	if (mQuads.empty())
 	{
-		Matrix4 scaleMat = Matrix4::CreateScale(
-			static_cast<float>(mTexture->GetWidth()),
-			static_cast<float>(mTexture->GetHeight()),
-			1.0f);
-		Matrix4 worldTrans;
-		switch (mAlignment)
-		{
-		case AlignCenter:
-			worldTrans = scaleMat * mOwner.GetWorldTransform();
-			break;
-		case AlignRight:
-			worldTrans = scaleMat * Matrix4::CreateTranslation(
-				Vector3(mTexture->GetWidth() / -2.0f,
-				0.0f,
-				0.0f)) *
-				mOwner.GetWorldTransform();
-			break;
-		case AlignLeft:
-			worldTrans = scaleMat * Matrix4::CreateTranslation(
-				Vector3(mTexture->GetWidth() / 2.0f,
-				0.0f,
-				0.0f)) *
-				mOwner.GetWorldTransform();
-		default:
-			break;
-		}
-		render.DrawSprite(mTexture, worldTrans);
+		return;
+	}
+
+	// The glyphs are laid out around the center of the text
+	Matrix4 textTransform;
+	switch (mAlignment)
+	{
+	case AlignCenter:
+		textTransform = mOwner.GetWorldTransform();
+		break;
+	case AlignRight:
+		textTransform = Matrix4::CreateTranslation(Vector3(mWidth / -2.0f, 0.0f, 0.0f)) *
+			mOwner.GetWorldTransform();
+		break;
+	case AlignLeft:
+	default:
+		textTransform = Matrix4::CreateTranslation(Vector3(mWidth / 2.0f, 0.0f, 0.0f)) *
+			mOwner.GetWorldTransform();
+		break;
+	}
+
+	TexturePtr texture = mAtlas->GetTexture();
+	for (const auto& quad : mQuads)
+	{
+		render.DrawSprite(texture, quad.mTransform * textTransform, quad.mUVMin, quad.mUVMax, mColor);
 	}
 }
 
 void FontComponent::SetText(const std::string& text, const Vector3& color, int pointSize /*= 24*/)
 {
-	// Convert to SDL_Color
-	SDL_Color sdlColor;
-	sdlColor.r = static_cast<Uint8>(color.x * 255);
-	sdlColor.g = static_cast<Uint8>(color.y * 255);
-	sdlColor.b = static_cast<Uint8>(color.z * 255);
-	sdlColor.a = 255;
+	mQuads.clear();
+	mWidth = 0.0f;
+	mColor = color;
 
-	TTF_Font* font = mFont->GetFontData(pointSize);
-	if (font)
+	mAtlas = mFont->GetGlyphAtlas(pointSize);
+	if (!mAtlas)
 	{
-		SDL_Surface* surf = TTF_RenderText_Blended(font, text.c_str(), sdlColor);
-		if (surf != nullptr)
-		{
-			mTexture = Texture::CreateFromSurface(mOwner.GetGame(), surf);
-			SDL_FreeSurface(surf);
-		}
-		else
+		SDL_Log("Point size %d is unsupported", pointSize);
+		return;
+	}
+
+	// Find the extent of the text, the same way TTF_SizeText does
+	int penX = 0;
+	int left = 0;
+	int right = 0;
+	for (char c : text)
+	{
+		const GlyphAtlas::Glyph& glyph = mAtlas->GetGlyph(static_cast<unsigned char>(c));
+		if (glyph.mIsValid)
 		{
-			mTexture.reset();
+			left = min(left, penX + glyph.mOffsetX);
+			right = max(right, penX + glyph.mOffsetX + glyph.mWidth);
+			penX += glyph.mAdvance;
 		}
 	}
-	else
+	mWidth = static_cast<float>(right - left);
+	float centerX = (left + right) / 2.0f;
+
+	// Then place a quad per glyph, relative to the center
+	penX = 0;
+	for (char c : text)
 	{
-		SDL_Log("Point size %d is unsupported", pointSize);
+		const GlyphAtlas::Glyph& glyph = mAtlas->GetGlyph(static_cast<unsigned char>(c));
+		if (!glyph.mIsValid)
+		{
+			continue;
+		}
+
+		// Every glyph is a line tall, so they're all centered vertically
+		float glyphCenterX = penX + glyph.mOffsetX + glyph.mWidth / 2.0f - centerX;
+		GlyphQuad quad;
+		quad.mTransform = Matrix4::CreateScale(static_cast<float>(glyph.mWidth), static_cast<float>(glyph.mHeight), 1.0f) *
+			Matrix4::CreateTranslation(Vector3(glyphCenterX, 0.0f, 0.0f));
+		quad.mUVMin = glyph.mUVMin;
+		quad.mUVMax = glyph.mUVMax;
+		mQuads.push_back(quad);
+
+		penX += glyph.mAdvance;
 	}
 }
 
 void FontComponent::ClearText()
 {
-	mTexture.reset();
+	mQuads.clear();
+	mWidth = 0.0f;
 }
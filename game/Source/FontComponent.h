@@ -2,6 +2,7 @@
 #include "DrawComponent.h"
 #include "Texture.h"
 #include <string>
+#include <vector>
 #include "Math.h"
 #include "Font.h"
 
@@ -28,7 +29,21 @@ public:
 
 	void ClearText();
 private:
-	TexturePtr mTexture;
+	// One glyph of the laid out text
+	struct GlyphQuad
+	{
+		// Scales the sprite quad to the glyph, and places it relative
+		// to the center of the text
+		Matrix4 mTransform;
+		Vector2 mUVMin;
+		Vector2 mUVMax;
+	};
+
+	// SetText only lays the glyphs out, they're all in the font's atlas
+	GlyphAtlasPtr mAtlas;
+	std::vector<GlyphQuad> mQuads;
+	Vector3 mColor;
+	float mWidth;
 	FontPtr mFont;
 	Alignment mAlignment;
 };
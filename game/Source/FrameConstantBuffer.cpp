@@ -0,0 +1,65 @@
+#include "ITPEnginePCH.h"
+#include "FrameConstantBuffer.h"
+
+namespace
+{
+	const size_t kConstantSize = 16;
+	// Ranges have to start and end on a multiple of 16 constants
+	const size_t kAlignment = 16 * kConstantSize;
+	// Enough for a few hundred draws before it has to grow
+	const size_t kInitialCapacity = 64 * 1024;
+}
+
+FrameConstantBuffer::FrameConstantBuffer(GraphicsDriver& graphics)
+	:mGraphics(graphics)
+	,mCapacity(0)
+	,mOffset(0)
+	,mMapped(nullptr)
+{
+
+}
+
+size_t FrameConstantBuffer::GetAllocationSize(size_t size)
+{
+	return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+void FrameConstantBuffer::Begin(size_t size)
+{
+	DbgAssert(mMapped == nullptr, "FrameConstantBuffer::Begin called twice");
+
+	if (size > mCapacity)
+	{
+		mCapacity = max(max(size, mCapacity * 2), kInitialCapacity);
+		mBuffer = mGraphics.CreateGraphicsBuffer(nullptr, static_cast<int>(mCapacity),
+			EBF_ConstantBuffer, ECPUAF_CanWrite, EGBU_Dynamic);
+	}
+
+	mOffset = 0;
+	mMapped = mGraphics.MapBuffer<char>(mBuffer);
+}
+
+FrameConstantBuffer::Range FrameConstantBuffer::Reserve(size_t size)
+{
+	size_t allocSize = GetAllocationSize(size);
+	DbgAssert(mMapped != nullptr, "FrameConstantBuffer isn't mapped");
+	DbgAssert(mOffset + allocSize <= mCapacity, "FrameConstantBuffer is full");
+
+	Range range;
+	range.mFirstConstant = static_cast<uint32_t>(mOffset / kConstantSize);
+	range.mNumConstants = static_cast<uint32_t>(allocSize / kConstantSize);
+	mOffset += allocSize;
+	return range;
+}
+
+void FrameConstantBuffer::Write(const Range& range, const void* data, size_t size) const
+{
+	DbgAssert(size <= range.mNumConstants * kConstantSize, "Too much data for this range");
+	memcpy(mMapped + range.mFirstConstant * kConstantSize, data, size);
+}
+
+void FrameConstantBuffer::End()
+{
+	mGraphics.UnmapBuffer(mBuffer);
+	mMapped = nullptr;
+}
@@ -0,0 +1,45 @@
+// FrameConstantBuffer.h
+// One big constant buffer that the per draw constants for a whole
+// frame are packed into. It's mapped once per frame, and each draw
+// binds its own range of it (this needs D3D 11.1, see
+// GraphicsDriver::SupportsConstantBufferOffsets).
+
+#pragma once
+#include "GraphicsDriver.h"
+
+class FrameConstantBuffer
+{
+public:
+	// Where an allocation is, in shader constants (16 bytes each)
+	struct Range
+	{
+		uint32_t mFirstConstant;
+		uint32_t mNumConstants;
+	};
+
+	FrameConstantBuffer(GraphicsDriver& graphics);
+
+	// How much of the buffer an allocation of size bytes takes up
+	static size_t GetAllocationSize(size_t size);
+
+	// Grows the buffer if size bytes won't fit, then maps it. The old
+	// contents are discarded, so draws from the last frame that are
+	// still in flight keep their copy.
+	void Begin(size_t size);
+	// Takes the next range of the buffer, to be filled in with Write.
+	// Only valid between Begin and End. Reserving isn't thread safe, but
+	// different ranges can be written from different threads.
+	Range Reserve(size_t size);
+	void Write(const Range& range, const void* data, size_t size) const;
+	void End();
+	bool IsMapped() const { return mMapped != nullptr; }
+
+	GraphicsBufferPtr GetBuffer() const { return mBuffer; }
+	size_t GetCapacity() const { return mCapacity; }
+private:
+	GraphicsDriver& mGraphics;
+	GraphicsBufferPtr mBuffer;
+	size_t mCapacity;
+	size_t mOffset;
+	char* mMapped;
+};
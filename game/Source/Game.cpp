@@ -1,6 +1,7 @@
 #include "ITPEnginePCH.h"
 #include <SDL/SDL_mixer.h>
 #include "Player.h"
+#include "Hud.h"
 
 Game::Game()
 	:mRenderer(*this)
@@ -13,6 +14,8 @@ Game::Game()
 Game::~Game()
 {
 	mAssetCache.Clear();
+	// Queued events point at actors, so they can't outlive the world
+	mEventBus.ClearQueues();
 	mWorld.RemoveAllActors();
 	Mix_CloseAudio();
 	TTF_Quit();
@@ -52,6 +55,12 @@ bool Game::Init()
 	// Initialize RNG
 	Random::Init();
 
+	// Start up the worker threads
+	mJobSystem.Init();
+
+	// Assets that nothing is using get evicted past this
+	mAssetCache.SetMemoryBudget(256 * 1024 * 1024);
+
 	// Add input mappings
 	AddInputMappings();
 
@@ -83,6 +92,8 @@ void Game::StartGame()
 {
 	LevelLoader loader(*this);
 	loader.Load("Assets/Levels/default.itplevel");
+
+	Hud::Spawn(*this);
 }
 
 void Game::ProcessInput()
@@ -110,6 +121,9 @@ void Game::ProcessInput()
 			break;
 		}
 	}
+
+	// Fire all the action/axis delegates for this frame's keys in one go
+	mInput.DispatchInput();
 }
 
 void Game::HandleKeyPressed(int key)
@@ -134,6 +148,12 @@ void Game::Tick()
 
 	// Update physics world
 	mPhysWorld.Tick(deltaTime);
+
+	// Touch callbacks may have moved actors after the world's pass
+	mWorld.UpdateTransforms();
+
+	// Deliver the gameplay events queued up during this frame
+	mEventBus.Dispatch();
 }
 
 void Game::GenerateOutput()
@@ -148,4 +168,12 @@ void Game::AddInputMappings()
 
 	// Bind our quit function to "Quit" on release
 	mInput.BindAction("Quit", IE_Released, this, &Game::Quit);
+
+	mInput.BindAction("LogStats", IE_Pressed, this, &Game::LogStats);
+}
+
+void Game::LogStats()
+{
+	mAssetCache.LogStats();
+	mRenderer.LogStats();
 }
@@ -10,6 +10,8 @@
 #include "PhysWorld.h"
 #include "GameTimers.h"
 #include "InputManager.h"
+#include "EventBus.h"
+#include "JobSystem.h"
 
 class Game
 {
@@ -26,6 +28,8 @@ public:
 	PhysWorld& GetPhysWorld() { return mPhysWorld; }
 	GameTimerManager& GetGameTimers() { return mGameTimers; }
 	InputManager& GetInput() { return mInput; }
+	EventBus& GetEventBus() { return mEventBus; }
+	JobSystem& GetJobSystem() { return mJobSystem; }
 private:
 	void StartGame();
 	
@@ -38,6 +42,11 @@ private:
 
 	void AddInputMappings();
 
+	// Debug key, dumps the engine's stats to the log
+	void LogStats();
+
+	// Declared first so it's destroyed last
+	JobSystem mJobSystem;
 	Renderer mRenderer;
 	FrameTimer mTimer;
 	World mWorld;
@@ -45,6 +54,7 @@ private:
 	PhysWorld mPhysWorld;
 	GameTimerManager mGameTimers;
 	InputManager mInput;
+	EventBus mEventBus;
 
 	bool mShouldQuit;
 };
@@ -0,0 +1,24 @@
+// GameEvents.h
+// Gameplay events sent through Game's EventBus.
+// Actor pointers are safe to use during dispatch, since dead
+// actors aren't destroyed until the next World tick.
+
+#pragma once
+#include "Math.h"
+
+class Actor;
+
+// Two actors' collision components started touching
+// (also sent as Actor::BeginTouch on both actors)
+struct TouchEvent
+{
+	Actor* mFirst;
+	Actor* mSecond;
+};
+
+// The player was sent back to their respawn point
+struct RespawnEvent
+{
+	class Player* mPlayer;
+	Vector3 mPosition;
+};
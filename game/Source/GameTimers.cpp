@@ -1,140 +1,107 @@
 #include "ITPEnginePCH.h"
+#include <algorithm>
+#include <functional>
 
 GameTimerManager::GameTimerManager()
-	:mNextTimerId(0)
-	,mAreTimersTicking(false)
+	:mCurrentTime(0.0)
+	,mNextTimerId(0)
+	,mNextScheduleId(0)
 {
 
 }
 
 void GameTimerManager::Tick(float deltaTime)
 {
-	mAreTimersTicking = true;
-	
-	// Tick the active timers
-	for (auto& t : mActiveTimers)
+	mCurrentTime += deltaTime;
+
+	// Pull everything that's due off the heap before running any callbacks,
+	// so timers that are set (or re-armed) by a callback wait for the next tick
+	while (!mTimerHeap.empty() && mTimerHeap.front().mExpireTime <= mCurrentTime)
 	{
-		TimerInfo& timer = t.second;
-		if (timer.mStatus == Active)
-		{
-			timer.mRemainingTime -= deltaTime;
-			if (timer.mRemainingTime <= 0.0f)
-			{
-				// Trigger the timer
-				timer.mDelegate->Execute();
-				// Is this looping?
-				if (timer.mIsLooping)
-				{
-					timer.mRemainingTime += timer.mDuration;
-				}
-				else
-				{
-					timer.mStatus = Cleared;
-					mClearedTimers.push_back(timer.mHandle);
-				}
-			}
-		}
+		std::pop_heap(mTimerHeap.begin(), mTimerHeap.end(), std::greater<ScheduledTimer>());
+		mFiredTimers.push_back(mTimerHeap.back());
+		mTimerHeap.pop_back();
 	}
 
-	// Remove any ended timers
-	for (auto& h : mClearedTimers)
+	for (auto& fired : mFiredTimers)
 	{
-		auto iter = mActiveTimers.find(h);
-		if (iter != mActiveTimers.end())
+		// Skip anything cleared, paused or rescheduled since this was pushed
+		auto iter = mTimers.find(fired.mHandle);
+		if (iter == mTimers.end() || iter->second.mScheduleId != fired.mScheduleId)
 		{
-			RemoveFromObjMap(iter->second.mObj, h);
-			mActiveTimers.erase(h);
+			continue;
 		}
-	}
-	mClearedTimers.clear();
 
-	// Add any pending timers
-	for (auto& t : mPendingTimers)
-	{
-		TimerInfo& timer = t.second;
-		if (timer.mStatus == Pending)
+		// The callback may add or clear timers, so don't hold onto iter
+		TimerInfo& timer = iter->second;
+		TimerDelegate delegate = timer.mDelegate;
+
+		// Is this looping?
+		if (timer.mIsLooping)
 		{
-			timer.mStatus = Active;
+			timer.mExpireTime += timer.mDuration;
+			Schedule(timer);
+		}
+		else
+		{
+			RemoveFromObjMap(timer.mObj, timer.mHandle);
+			mTimers.erase(iter);
 		}
-		mActiveTimers.emplace(timer.mHandle, timer);
-	}
-	mPendingTimers.clear();
 
-	mAreTimersTicking = false;
+		// Trigger the timer
+		delegate.Execute();
+	}
+	mFiredTimers.clear();
 }
 
 void GameTimerManager::ClearTimer(const TimerHandle& handle)
 {
-	// Is this pending?
-	auto iter = mPendingTimers.find(handle);
-	if (iter != mPendingTimers.end())
+	auto iter = mTimers.find(handle);
+	if (iter != mTimers.end())
 	{
-		// We can just remove this from pending timers
+		// Its heap entry (if any) becomes stale and is skipped later
 		RemoveFromObjMap(iter->second.mObj, handle);
-		mPendingTimers.erase(iter);
-	}
-	else
-	{
-		iter = mActiveTimers.find(handle);
-		if (iter != mActiveTimers.end())
-		{
-			iter->second.mStatus = Cleared;
-			mClearedTimers.push_back(handle);
-		}
+		mTimers.erase(iter);
 	}
 }
 
 void GameTimerManager::PauseTimer(const TimerHandle& handle)
 {
-	// Is this pending?
-	auto iter = mPendingTimers.find(handle);
-	if (iter != mPendingTimers.end())
+	auto iter = mTimers.find(handle);
+	if (iter != mTimers.end() && iter->second.mStatus == Active)
 	{
-		iter->second.mStatus = Paused;
-	}
-	else
-	{
-		iter = mActiveTimers.find(handle);
-		if (iter != mActiveTimers.end())
-		{
-			iter->second.mStatus = Paused;
-		}
+		TimerInfo& timer = iter->second;
+		timer.mRemainingTime = static_cast<float>(timer.mExpireTime - mCurrentTime);
+		timer.mScheduleId = 0;
+		timer.mStatus = Paused;
 	}
 }
 
 void GameTimerManager::UnpauseTimer(const TimerHandle& handle)
 {
-	// Is this pending?
-	auto iter = mPendingTimers.find(handle);
-	if (iter != mPendingTimers.end())
+	auto iter = mTimers.find(handle);
+	if (iter != mTimers.end() && iter->second.mStatus == Paused)
 	{
-		iter->second.mStatus = Pending;
-	}
-	else
-	{
-		iter = mActiveTimers.find(handle);
-		if (iter != mActiveTimers.end())
-		{
-			iter->second.mStatus = Active;
-		}
+		TimerInfo& timer = iter->second;
+		timer.mExpireTime = mCurrentTime + timer.mRemainingTime;
+		timer.mStatus = Active;
+		Schedule(timer);
 	}
 }
 
 float GameTimerManager::GetRemainingTime(const TimerHandle& handle)
 {
-	// Is this pending?
-	auto iter = mPendingTimers.find(handle);
-	if (iter != mPendingTimers.end())
+	auto iter = mTimers.find(handle);
+	if (iter != mTimers.end())
 	{
-		return iter->second.mRemainingTime;
-	}
-	else
-	{
-		iter = mActiveTimers.find(handle);
-		if (iter != mActiveTimers.end())
+		if (iter->second.mStatus == Paused)
 		{
 			return iter->second.mRemainingTime;
 		}
+		else
+		{
+			return static_cast<float>(iter->second.mExpireTime - mCurrentTime);
+		}
 	}
 
 	// Unknown timer
@@ -143,18 +110,18 @@ float GameTimerManager::GetRemainingTime(const TimerHandle& handle)
 
 void GameTimerManager::AddTime(const TimerHandle& handle, float time)
 {
-	// Is this pending?
-	auto iter = mPendingTimers.find(handle);
-	if (iter != mPendingTimers.end())
-	{
-		iter->second.mRemainingTime += time;
-	}
-	else
+	auto iter = mTimers.find(handle);
+	if (iter != mTimers.end())
 	{
-		iter = mActiveTimers.find(handle);
-		if (iter != mActiveTimers.end())
+		TimerInfo& timer = iter->second;
+		if (timer.mStatus == Paused)
 		{
-			iter->second.mRemainingTime += time;
+			timer.mRemainingTime += time;
+		}
+		else
+		{
+			timer.mExpireTime += time;
+			Schedule(timer);
 		}
 	}
 }
@@ -166,14 +133,14 @@ void GameTimerManager::ClearAllTimers(Object* obj)
 	{
 		for (auto& t : iter->second)
 		{
-			ClearTimer(t);
+			mTimers.erase(t);
 		}
 
 		mObjToHandlesMap.erase(iter);
 	}
 }
 
-void GameTimerManager::SetTimerInternal(TimerHandle& outHandle, Object* obj, TimerDelegatePtr delegate, float duration, bool looping)
+void GameTimerManager::SetTimerInternal(TimerHandle& outHandle, Object* obj, const TimerDelegate& delegate, float duration, bool looping)
 {
 	outHandle.mValue = mNextTimerId;
 	
@@ -182,21 +149,14 @@ void GameTimerManager::SetTimerInternal(TimerHandle& outHandle, Object* obj, Tim
 	timer.mDelegate = delegate;
 	timer.mHandle = outHandle;
 	timer.mDuration = duration;
+	timer.mExpireTime = mCurrentTime + duration;
 	timer.mRemainingTime = duration;
+	timer.mScheduleId = 0;
+	timer.mStatus = Active;
 	timer.mIsLooping = looping;
 
-	if (mAreTimersTicking)
-	{
-		// Add to pending set
-		timer.mStatus = Pending;
-		mPendingTimers.emplace(outHandle, timer);
-	}
-	else
-	{
-		// Add to active set
-		timer.mStatus = Active;
-		mActiveTimers.emplace(outHandle, timer);
-	}
+	auto result = mTimers.emplace(outHandle, timer);
+	Schedule(result.first->second);
 
 	// Add to the timers associated with this object
 	AddToObjMap(obj, outHandle);
@@ -204,6 +164,42 @@ void GameTimerManager::SetTimerInternal(TimerHandle& outHandle, Object* obj, Tim
 	mNextTimerId++;
 }
 
+void GameTimerManager::Schedule(TimerInfo& timer)
+{
+	// 0 is reserved for "not scheduled"
+	mNextScheduleId++;
+	if (mNextScheduleId == 0)
+	{
+		mNextScheduleId++;
+	}
+	timer.mScheduleId = mNextScheduleId;
+
+	ScheduledTimer entry;
+	entry.mExpireTime = timer.mExpireTime;
+	entry.mHandle = timer.mHandle;
+	entry.mScheduleId = timer.mScheduleId;
+	mTimerHeap.push_back(entry);
+	std::push_heap(mTimerHeap.begin(), mTimerHeap.end(), std::greater<ScheduledTimer>());
+
+	// Lots of pausing or adding time leaves stale entries behind
+	if (mTimerHeap.size() > 2 * mTimers.size() + 64)
+	{
+		CompactHeap();
+	}
+}
+
+void GameTimerManager::CompactHeap()
+{
+	auto isStale = [this](const ScheduledTimer& entry)
+	{
+		auto iter = mTimers.find(entry.mHandle);
+		return iter == mTimers.end() || iter->second.mScheduleId != entry.mScheduleId;
+	};
+	mTimerHeap.erase(std::remove_if(mTimerHeap.begin(), mTimerHeap.end(), isStale),
+		mTimerHeap.end());
+	std::make_heap(mTimerHeap.begin(), mTimerHeap.end(), std::greater<ScheduledTimer>());
+}
+
 void GameTimerManager::AddToObjMap(Object* obj, const TimerHandle& handle)
 {
 	auto iter = mObjToHandlesMap.find(obj);
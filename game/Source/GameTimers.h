@@ -39,8 +39,8 @@ namespace std
 	};
 }
 
-// Define a timer delegate ptr as a delegate with no parameters
-typedef DelegateNoParamsPtr TimerDelegatePtr;
+// Define a timer delegate as a delegate with no parameters
+typedef Delegate<> TimerDelegate;
 
 class GameTimerManager
 {
@@ -48,6 +48,7 @@ public:
 	GameTimerManager();
 
 	// Tick all the timers -- should only be called from Game::Tick
+	// Only the timers that actually fire this frame are touched
 	void Tick(float deltaTime);
 
 	// Sets a game timer
@@ -61,10 +62,14 @@ public:
 	void SetTimer(TimerHandle& outHandle, T* obj, void (T::*func)(),
 		float duration, bool looping = false)
 	{
-		// This is some hardcore template magic
-		// Don't really worry how this works, other than that it
-		// calls SetTimerInternal with a properly constructed delegate
-		TimerDelegatePtr delegate = std::make_shared<DelegateNoParams<T>>(obj, func);
+		SetTimerInternal(outHandle, obj, TimerDelegate(obj, func), duration, looping);
+	}
+
+	// Same as above, but calls any delegate (such as a lambda)
+	// The timer is still cleared along with obj's other timers
+	void SetTimer(TimerHandle& outHandle, Object* obj, const TimerDelegate& delegate,
+		float duration, bool looping = false)
+	{
 		SetTimerInternal(outHandle, obj, delegate, duration, looping);
 	}
 
@@ -88,10 +93,8 @@ public:
 private:
 	enum TimerStatus
 	{
-		Pending,
 		Active,
-		Paused,
-		Cleared
+		Paused
 	};
 
 	struct TimerInfo
@@ -100,7 +103,7 @@ private:
 		Object* mObj;
 
 		// Delegate for this timer
-		TimerDelegatePtr mDelegate;
+		TimerDelegate mDelegate;
 
 		// TimerHandle for this timer
 		TimerHandle mHandle;
@@ -108,9 +111,16 @@ private:
 		// Total duration of this timer
 		float mDuration;
 
-		// Remaining time on the timer
+		// Absolute time this timer fires at (only valid when active)
+		double mExpireTime;
+
+		// Remaining time on the timer (only valid when paused)
 		float mRemainingTime;
 
+		// Matches the heap entry that's currently live for this timer,
+		// or 0 if it isn't scheduled (paused)
+		unsigned int mScheduleId;
+
 		// Status of the timer
 		TimerStatus mStatus;
 
@@ -118,28 +128,50 @@ private:
 		bool mIsLooping;
 	};
 
+	// Entry in the expiry min-heap. Pausing, clearing or adding time just
+	// bumps the timer's schedule id, so old entries are skipped when popped.
+	struct ScheduledTimer
+	{
+		double mExpireTime;
+		TimerHandle mHandle;
+		unsigned int mScheduleId;
+
+		bool operator>(const ScheduledTimer& other) const
+		{
+			return mExpireTime > other.mExpireTime;
+		}
+	};
+
 	void SetTimerInternal(TimerHandle& outHandle, Object* obj,
-		TimerDelegatePtr delegate, float duration, bool looping);
+		const TimerDelegate& delegate, float duration, bool looping);
+
+	// Pushes a heap entry for timer's current expire time
+	void Schedule(TimerInfo& timer);
+	// Rebuilds the heap without stale entries
+	void CompactHeap();
 
 	void AddToObjMap(Object* obj, const TimerHandle& handle);
 	void RemoveFromObjMap(Object* obj, const TimerHandle& handle);
 
 	// Map of timer handles to timers
-	std::unordered_map<TimerHandle, TimerInfo> mActiveTimers;
+	std::unordered_map<TimerHandle, TimerInfo> mTimers;
+
+	// Min-heap of active timers, keyed by absolute expire time
+	std::vector<ScheduledTimer> mTimerHeap;
 
-	// Map of pending timers
-	std::unordered_map<TimerHandle, TimerInfo> mPendingTimers;
+	// Timers due this tick (kept around to reuse the memory)
+	std::vector<ScheduledTimer> mFiredTimers;
 
 	// Map of Object to set of timer handles
 	std::unordered_map<Object*, 
 		std::unordered_set<TimerHandle>> mObjToHandlesMap;
 
-	// Vector of cleared timers
-	std::vector<TimerHandle> mClearedTimers;
+	// Total time ticked so far
+	double mCurrentTime;
 
 	// Tracks the next timer handle ID to assign
 	int mNextTimerId;
 
-	// bool to track whether or not timers are ticking
-	bool mAreTimersTicking;
+	// Tracks the next heap schedule ID to assign
+	unsigned int mNextScheduleId;
 };
@@ -0,0 +1,152 @@
+#include "ITPEnginePCH.h"
+#include "GlyphAtlas.h"
+#include <vector>
+
+namespace
+{
+	// Empty texels around each glyph, so filtering doesn't pick up its neighbors
+	const int kPadding = 1;
+	const int kMinSize = 128;
+	const int kMaxSize = 4096;
+
+	bool IsPrintable(int ch)
+	{
+		return (ch >= 32 && ch < 127) || ch >= 160;
+	}
+}
+
+GlyphAtlas::GlyphAtlas()
+	:mLineHeight(0)
+	,mWidth(0)
+	,mHeight(0)
+{
+	memset(mGlyphs, 0, sizeof(mGlyphs));
+}
+
+bool GlyphAtlas::Build(class Game& game, TTF_Font* font)
+{
+	mLineHeight = TTF_FontHeight(font);
+
+	// Render each glyph on its own, in white so text can be tinted any color
+	SDL_Color white = { 255, 255, 255, 255 };
+	std::vector<SDL_Surface*> surfaces(256, nullptr);
+	for (int ch = 0; ch < 256; ch++)
+	{
+		if (!IsPrintable(ch) || !TTF_GlyphIsProvided(font, static_cast<Uint16>(ch)))
+		{
+			continue;
+		}
+
+		int minX, maxX, minY, maxY, advance;
+		if (TTF_GlyphMetrics(font, static_cast<Uint16>(ch), &minX, &maxX, &minY, &maxY, &advance) != 0)
+		{
+			continue;
+		}
+
+		// A one character string comes out a line tall, and starts
+		// left of the pen if the glyph hangs over
+		char text[2] = { static_cast<char>(ch), '\0' };
+		surfaces[ch] = TTF_RenderText_Blended(font, text, white);
+		if (surfaces[ch] == nullptr)
+		{
+			continue;
+		}
+
+		Glyph& glyph = mGlyphs[ch];
+		glyph.mWidth = surfaces[ch]->w;
+		glyph.mHeight = surfaces[ch]->h;
+		glyph.mOffsetX = min(minX, 0);
+		glyph.mAdvance = advance;
+		glyph.mIsValid = true;
+	}
+
+	mWidth = Pack(mGlyphs, 256);
+	mHeight = mWidth;
+
+	bool fits = mWidth != 0;
+	if (fits)
+	{
+		// Same format TTF_RenderText_Blended makes, which the texture expects
+		SDL_Surface* atlas = SDL_CreateRGBSurface(0, mWidth, mHeight, 32,
+			0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+		SDL_FillRect(atlas, nullptr, 0);
+
+		for (int ch = 0; ch < 256; ch++)
+		{
+			if (mGlyphs[ch].mIsValid)
+			{
+				// Copy the alpha instead of blending with it
+				SDL_SetSurfaceBlendMode(surfaces[ch], SDL_BLENDMODE_NONE);
+				SDL_Rect dest = { mGlyphs[ch].mX, mGlyphs[ch].mY, mGlyphs[ch].mWidth, mGlyphs[ch].mHeight };
+				SDL_BlitSurface(surfaces[ch], nullptr, atlas, &dest);
+			}
+		}
+
+		mTexture = Texture::CreateFromSurface(game, atlas);
+		SDL_FreeSurface(atlas);
+	}
+	else
+	{
+		SDL_Log("Glyphs don't fit in a %dx%d atlas", kMaxSize, kMaxSize);
+	}
+
+	for (auto surface : surfaces)
+	{
+		if (surface != nullptr)
+		{
+			SDL_FreeSurface(surface);
+		}
+	}
+
+	return fits;
+}
+
+int GlyphAtlas::Pack(Glyph* glyphs, size_t count)
+{
+	for (int size = kMinSize; size <= kMaxSize; size *= 2)
+	{
+		int x = kPadding;
+		int y = kPadding;
+		int rowHeight = 0;
+		bool fits = true;
+		for (size_t i = 0; i < count; i++)
+		{
+			Glyph& glyph = glyphs[i];
+			if (!glyph.mIsValid)
+			{
+				continue;
+			}
+
+			// Too wide for any row at this size
+			if (glyph.mWidth + 2 * kPadding > size)
+			{
+				fits = false;
+				break;
+			}
+
+			if (x + glyph.mWidth + kPadding > size)
+			{
+				x = kPadding;
+				y += rowHeight + kPadding;
+				rowHeight = 0;
+			}
+			glyph.mX = x;
+			glyph.mY = y;
+			x += glyph.mWidth + kPadding;
+			rowHeight = max(rowHeight, glyph.mHeight);
+		}
+
+		if (fits && y + rowHeight + kPadding <= size)
+		{
+			float invSize = 1.0f / size;
+			for (size_t i = 0; i < count; i++)
+			{
+				Glyph& glyph = glyphs[i];
+				glyph.mUVMin = Vector2(glyph.mX * invSize, glyph.mY * invSize);
+				glyph.mUVMax = Vector2((glyph.mX + glyph.mWidth) * invSize, (glyph.mY + glyph.mHeight) * invSize);
+			}
+			return size;
+		}
+	}
+	return 0;
+}
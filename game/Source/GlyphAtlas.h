@@ -0,0 +1,59 @@
+// GlyphAtlas.h
+// Every glyph of one font at one point size, rendered once into a
+// single texture. Text is drawn as a quad per glyph out of the atlas,
+// so changing a string doesn't have to render or upload anything.
+
+#pragma once
+#include "Math.h"
+#include "Texture.h"
+#include <memory>
+#include <SDL/SDL_ttf.h>
+
+class GlyphAtlas
+{
+public:
+	// Where a glyph is in the atlas and how to place it, in pixels
+	struct Glyph
+	{
+		int mX;
+		int mY;
+		int mWidth;
+		int mHeight;
+		// From the pen position to the left edge of the glyph
+		int mOffsetX;
+		// How far the pen moves after this glyph
+		int mAdvance;
+		// The same rectangle as mX, mY, mWidth, mHeight, in texture coordinates
+		Vector2 mUVMin;
+		Vector2 mUVMax;
+		// False if the font doesn't have this glyph
+		bool mIsValid;
+	};
+
+	GlyphAtlas();
+
+	// Renders the Latin-1 glyphs in font (the same characters TTF_RenderText
+	// supports) and uploads them. Only uses the device, so it's fine to
+	// call while the render thread is drawing.
+	bool Build(class Game& game, TTF_Font* font);
+
+	// Every glyph is mHeight tall, which is the height of a line
+	const Glyph& GetGlyph(unsigned char ch) const { return mGlyphs[ch]; }
+	int GetLineHeight() const { return mLineHeight; }
+	int GetWidth() const { return mWidth; }
+	int GetHeight() const { return mHeight; }
+	TexturePtr GetTexture() const { return mTexture; }
+
+	// Places the valid glyphs (which only need their size filled in) in
+	// rows in the smallest square atlas they fit in, and sets their
+	// positions and UVs. Returns the atlas size, or 0 if they don't fit.
+	static int Pack(Glyph* glyphs, size_t count);
+private:
+	Glyph mGlyphs[256];
+	TexturePtr mTexture;
+	int mLineHeight;
+	int mWidth;
+	int mHeight;
+};
+
+typedef std::shared_ptr<GlyphAtlas> GlyphAtlasPtr;
@@ -0,0 +1,86 @@
+#include "ITPEnginePCH.h"
+#include "SelfTest.h"
+#include "GlyphAtlas.h"
+
+namespace
+{
+	const int kNumGlyphs = 256;
+
+	// Sizes roughly like a real font's, with some missing glyphs
+	void MakeGlyphs(GlyphAtlas::Glyph* glyphs, int maxWidth, int height)
+	{
+		memset(glyphs, 0, sizeof(GlyphAtlas::Glyph) * kNumGlyphs);
+		for (int ch = 0; ch < kNumGlyphs; ch++)
+		{
+			glyphs[ch].mIsValid = ch % 7 != 0;
+			glyphs[ch].mWidth = Random::GetIntRange(1, maxWidth);
+			glyphs[ch].mHeight = height;
+		}
+	}
+
+	bool Overlaps(const GlyphAtlas::Glyph& a, const GlyphAtlas::Glyph& b)
+	{
+		return a.mX < b.mX + b.mWidth && b.mX < a.mX + a.mWidth &&
+			a.mY < b.mY + b.mHeight && b.mY < a.mY + a.mHeight;
+	}
+
+	// Every valid glyph is inside the atlas, clear of the others, and its
+	// UVs are its rectangle over the atlas size
+	bool IsPackedCorrectly(const GlyphAtlas::Glyph* glyphs, int size)
+	{
+		bool correct = true;
+		for (int i = 0; i < kNumGlyphs; i++)
+		{
+			const GlyphAtlas::Glyph& glyph = glyphs[i];
+			if (!glyph.mIsValid)
+			{
+				continue;
+			}
+
+			correct &= glyph.mX >= 1 && glyph.mY >= 1 &&
+				glyph.mX + glyph.mWidth + 1 <= size && glyph.mY + glyph.mHeight + 1 <= size;
+			for (int j = i + 1; j < kNumGlyphs; j++)
+			{
+				correct &= !glyphs[j].mIsValid || !Overlaps(glyph, glyphs[j]);
+			}
+
+			correct &= SelfTest::IsNear(glyph.mUVMin.x * size, static_cast<float>(glyph.mX), 1e-3f) &&
+				SelfTest::IsNear(glyph.mUVMin.y * size, static_cast<float>(glyph.mY), 1e-3f) &&
+				SelfTest::IsNear(glyph.mUVMax.x * size, static_cast<float>(glyph.mX + glyph.mWidth), 1e-3f) &&
+				SelfTest::IsNear(glyph.mUVMax.y * size, static_cast<float>(glyph.mY + glyph.mHeight), 1e-3f);
+		}
+		return correct;
+	}
+}
+
+void SelfTest::RunGlyphAtlasTests()
+{
+	GlyphAtlas::Glyph glyphs[kNumGlyphs];
+
+	// Small glyphs go in the smallest atlas
+	MakeGlyphs(glyphs, 6, 8);
+	int size = GlyphAtlas::Pack(glyphs, kNumGlyphs);
+	SELF_CHECK(size == 128);
+	SELF_CHECK(IsPackedCorrectly(glyphs, size));
+
+	// Bigger ones need a bigger atlas
+	MakeGlyphs(glyphs, 40, 48);
+	size = GlyphAtlas::Pack(glyphs, kNumGlyphs);
+	SELF_CHECK(size > 128);
+	SELF_CHECK(IsPackedCorrectly(glyphs, size));
+
+	// A glyph wider than a row moves to a bigger atlas, even when the
+	// rest would fit in one row
+	MakeGlyphs(glyphs, 2, 4);
+	glyphs['W'].mIsValid = true;
+	glyphs['W'].mWidth = 200;
+	size = GlyphAtlas::Pack(glyphs, kNumGlyphs);
+	SELF_CHECK(size == 256);
+	SELF_CHECK(IsPackedCorrectly(glyphs, size));
+
+	// Nothing fits past the biggest atlas
+	MakeGlyphs(glyphs, 6, 8);
+	glyphs['W'].mIsValid = true;
+	glyphs['W'].mWidth = 5000;
+	SELF_CHECK(GlyphAtlas::Pack(glyphs, kNumGlyphs) == 0);
+}
@@ -194,8 +194,12 @@ namespace
 
 GraphicsDriver::GraphicsDriver( void* inWindow  ) :
 mCurrentRenderTarget( nullptr ),
-mCurrentDepthStencil( nullptr )
+mCurrentDepthStencil( nullptr ),
+mStateStats()
 {
+	// Nothing's bound on a new device
+	InvalidateStateCache();
+
 	HWND window = reinterpret_cast<HWND>(inWindow);
 	RECT rc;
 	GetClientRect(window, &rc );
@@ -207,6 +211,15 @@ mCurrentDepthStencil( nullptr )
 	CreateSwapChain( width, height, window);
 	mBackBufferRenderTarget = CreateBackBufferRenderTargetView();
 
+	// Binding part of a constant buffer needs an 11.1 context, and the driver has to support it
+	mSupportsConstantBufferOffsets = false;
+	if( g_pImmediateContext1 )
+	{
+		D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+		HRESULT hr = g_pd3dDevice->CheckFeatureSupport( D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof( options ) );
+		mSupportsConstantBufferOffsets = SUCCEEDED( hr ) && options.ConstantBufferOffsetting;
+	}
+
 	mWindowWidth = width;
 	mWindowHeight = height;
 	SetViewport( 0.f, 0.f, static_cast< float >( width ), static_cast< float >( height ) );
@@ -220,7 +233,10 @@ mCurrentDepthStencil( nullptr )
 
 void GraphicsDriver::SetRenderTarget( RenderTargetPtr inRenderTarget )
 {
-	mCurrentRenderTarget = inRenderTarget;
+	if( !UpdateBinding( mCurrentRenderTarget, inRenderTarget ) )
+	{
+		return;
+	}
 
 	auto renderTarget = mCurrentRenderTarget.get();
 	g_pImmediateContext->OMSetRenderTargets( 1, &renderTarget, mCurrentDepthStencil.get() );
@@ -228,7 +244,10 @@ void GraphicsDriver::SetRenderTarget( RenderTargetPtr inRenderTarget )
 
 void GraphicsDriver::SetDepthStencil( DepthStencilPtr inDepthStencil )
 {
-	mCurrentDepthStencil = inDepthStencil;
+	if( !UpdateBinding( mCurrentDepthStencil, inDepthStencil ) )
+	{
+		return;
+	}
 
 	auto renderTarget = mCurrentRenderTarget.get();
 	g_pImmediateContext->OMSetRenderTargets( 1, &renderTarget, mCurrentDepthStencil.get() );
@@ -365,54 +384,152 @@ SamplerStatePtr GraphicsDriver::CreateSamplerState()
 
 void GraphicsDriver::SetInputLayout( InputLayoutPtr inLayout )
 {
-	g_pImmediateContext->IASetInputLayout( inLayout.get() );
+	if( UpdateBinding( mCurrentInputLayout, inLayout ) )
+	{
+		g_pImmediateContext->IASetInputLayout( inLayout.get() );
+	}
 }
 
 void GraphicsDriver::SetPrimitiveTopology(EPrimitiveTopology inTopology)
 {
 	// Set primitive topology
-	g_pImmediateContext->IASetPrimitiveTopology(static_cast<D3D11_PRIMITIVE_TOPOLOGY>(inTopology));
+	if( UpdateBinding( mCurrentTopology, inTopology ) )
+	{
+		g_pImmediateContext->IASetPrimitiveTopology(static_cast<D3D11_PRIMITIVE_TOPOLOGY>(inTopology));
+	}
 }
 
-void GraphicsDriver::SetVertexBuffer( GraphicsBufferPtr inBuffer, uint32_t inVertexSize )
+void GraphicsDriver::SetVertexBuffer( GraphicsBufferPtr inBuffer, uint32_t inVertexSize, uint32_t inSlot )
 {
+	if( inSlot < kMaxVertexBufferSlots )
+	{
+		VertexBufferBinding binding = { inBuffer, inVertexSize };
+		if( !UpdateBinding( mCurrentVertexBuffers[ inSlot ], binding ) )
+		{
+			return;
+		}
+	}
+
 	auto buffer = inBuffer.get();
 	uint32_t offset = 0;
-	g_pImmediateContext->IASetVertexBuffers( 0, 1, &buffer, &inVertexSize, &offset );
+	g_pImmediateContext->IASetVertexBuffers( inSlot, 1, &buffer, &inVertexSize, &offset );
 }
 
-void GraphicsDriver::SetIndexBuffer( GraphicsBufferPtr inBuffer )
+void GraphicsDriver::SetIndexBuffer( GraphicsBufferPtr inBuffer, EIndexFormat inFormat )
 {
-	g_pImmediateContext->IASetIndexBuffer( inBuffer.get(), DXGI_FORMAT_R16_UINT, 0 );
+	IndexBufferBinding binding = { inBuffer, inFormat };
+	if( UpdateBinding( mCurrentIndexBuffer, binding ) )
+	{
+		g_pImmediateContext->IASetIndexBuffer( inBuffer.get(), static_cast<DXGI_FORMAT>(inFormat), 0 );
+	}
 }
 
 void GraphicsDriver::SetVSConstantBuffer( GraphicsBufferPtr inBuffer, int inStartSlot )
 {
+	if( inStartSlot < kMaxConstantBufferSlots && !UpdateBinding( mCurrentVSConstantBuffers[ inStartSlot ], inBuffer ) )
+	{
+		return;
+	}
+
 	auto buffer = inBuffer.get();
 	g_pImmediateContext->VSSetConstantBuffers( inStartSlot, 1, &buffer );
 }
 
+void GraphicsDriver::SetVSConstantBufferRange( GraphicsBufferPtr inBuffer, int inStartSlot, uint32_t inFirstConstant, uint32_t inNumConstants )
+{
+	// Ranges change every draw, so they aren't shadowed. Forget what's in
+	// the slot so that binding a whole buffer there next isn't skipped.
+	if( inStartSlot < kMaxConstantBufferSlots )
+	{
+		mCurrentVSConstantBuffers[ inStartSlot ].reset();
+	}
+	mStateStats.mNumIssued++;
+
+	auto buffer = inBuffer.get();
+	g_pImmediateContext1->VSSetConstantBuffers1( inStartSlot, 1, &buffer, &inFirstConstant, &inNumConstants );
+}
+
 void GraphicsDriver::SetPSConstantBuffer( GraphicsBufferPtr inBuffer, int inStartSlot )
 {
+	if( inStartSlot < kMaxConstantBufferSlots && !UpdateBinding( mCurrentPSConstantBuffers[ inStartSlot ], inBuffer ) )
+	{
+		return;
+	}
+
 	auto buffer = inBuffer.get();
 	g_pImmediateContext->PSSetConstantBuffers( inStartSlot, 1, &buffer );
 }
 
 void GraphicsDriver::SetPSSamplerState( SamplerStatePtr inSamplerState, int inStartSlot )
 {
+	if( inStartSlot < kMaxSamplerSlots && !UpdateBinding( mCurrentPSSamplers[ inStartSlot ], inSamplerState ) )
+	{
+		return;
+	}
+
 	auto sampler = inSamplerState.get(); 
 	g_pImmediateContext->PSSetSamplers( inStartSlot, 1, &sampler );
 }
 
 void GraphicsDriver::SetPSTexture(GraphicsTexturePtr inTexture, int inStartSlot)
 {
+	if( inStartSlot < kMaxTextureSlots && !UpdateBinding( mCurrentPSTextures[ inStartSlot ], inTexture ) )
+	{
+		return;
+	}
+
 	auto texture = inTexture.get();
 	g_pImmediateContext->PSSetShaderResources( inStartSlot, 1, &texture );
 }
 
 void GraphicsDriver::SetDepthStencilState( DepthStencilStatePtr inDepthStencilState )
 {
-	g_pImmediateContext->OMSetDepthStencilState( inDepthStencilState.get(), 1 );
+	if( UpdateBinding( mCurrentDepthStencilState, inDepthStencilState ) )
+	{
+		g_pImmediateContext->OMSetDepthStencilState( inDepthStencilState.get(), 1 );
+	}
+}
+
+void GraphicsDriver::ResetStateStats()
+{
+	mStateStats.mNumIssued = 0;
+	mStateStats.mNumFiltered = 0;
+}
+
+void GraphicsDriver::InvalidateStateCache()
+{
+	// The render target and depth stencil are bound together, so they
+	// aren't forgotten here. The caller rebinds them if needed.
+	mCurrentInputLayout.reset();
+	mCurrentTopology = static_cast< EPrimitiveTopology >( D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED );
+	for( auto& binding : mCurrentVertexBuffers )
+	{
+		binding.mBuffer.reset();
+		binding.mVertexSize = 0;
+	}
+	mCurrentIndexBuffer.mBuffer.reset();
+	mCurrentIndexBuffer.mFormat = EIF_UInt16;
+	mCurrentVertexShader.reset();
+	mCurrentPixelShader.reset();
+	for( auto& buffer : mCurrentVSConstantBuffers )
+	{
+		buffer.reset();
+	}
+	for( auto& buffer : mCurrentPSConstantBuffers )
+	{
+		buffer.reset();
+	}
+	for( auto& sampler : mCurrentPSSamplers )
+	{
+		sampler.reset();
+	}
+	for( auto& texture : mCurrentPSTextures )
+	{
+		texture.reset();
+	}
+	mCurrentDepthStencilState.reset();
+	mCurrentRasterizerState.reset();
+	mCurrentBlendState.reset();
 }
 
 
@@ -523,6 +640,22 @@ GraphicsTexturePtr GraphicsDriver::CreateTextureFromMemory(const void* inPixels,
 	return GraphicsTexturePtr(toRet, AutoReleaseD3D);
 }
 
+GraphicsTexturePtr GraphicsDriver::CreateBufferView(GraphicsBufferPtr inBuffer, EGFormat inFormat, uint32_t inNumElements)
+{
+	D3D11_SHADER_RESOURCE_VIEW_DESC desc;
+	ZeroMemory(&desc, sizeof(desc));
+	desc.Format = static_cast<DXGI_FORMAT>(inFormat);
+	desc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+	desc.Buffer.FirstElement = 0;
+	desc.Buffer.NumElements = inNumElements;
+
+	ID3D11ShaderResourceView* toRet = nullptr;
+	HRESULT hr = g_pd3dDevice->CreateShaderResourceView(inBuffer.get(), &desc, &toRet);
+	DbgAssert(hr == S_OK, "Failed to create a shader resource view from buffer");
+
+	return GraphicsTexturePtr(toRet, AutoReleaseD3D);
+}
+
 DepthStencilPtr GraphicsDriver::CreateDepthStencil(int inWidth, int inHeight)
 {
 	ID3D11Texture2D* depthStencilTexture;
@@ -597,6 +730,7 @@ GraphicsDriver::~GraphicsDriver()
 {
 	mCurrentRenderTarget.reset();
 	mCurrentDepthStencil.reset();
+	InvalidateStateCache();
 
 	if( g_pImmediateContext )
 	{
@@ -650,12 +784,18 @@ void GraphicsDriver::ClearDepthStencil( DepthStencilPtr inDepthStencil, float in
 
 void GraphicsDriver::SetVertexShader( VertexShaderPtr inVertexShader )
 {
-	g_pImmediateContext->VSSetShader( inVertexShader.get(), nullptr, 0 );
+	if( UpdateBinding( mCurrentVertexShader, inVertexShader ) )
+	{
+		g_pImmediateContext->VSSetShader( inVertexShader.get(), nullptr, 0 );
+	}
 }
 
 void GraphicsDriver::SetPixelShader( PixelShaderPtr inPixelShader )
 {
-	g_pImmediateContext->PSSetShader( inPixelShader.get(), nullptr, 0 );
+	if( UpdateBinding( mCurrentPixelShader, inPixelShader ) )
+	{
+		g_pImmediateContext->PSSetShader( inPixelShader.get(), nullptr, 0 );
+	}
 }
 
 void GraphicsDriver::Draw( int inVertexCount, int inStartVertexIndex )
@@ -668,6 +808,13 @@ void GraphicsDriver::DrawIndexed( int inIndexCount, int inStartIndexLocation, in
 	g_pImmediateContext->DrawIndexed( inIndexCount, inStartIndexLocation, inBaseVertexLocation );
 }
 
+void GraphicsDriver::DrawIndexedInstanced( int inIndexCountPerInstance, int inInstanceCount, int inStartIndexLocation,
+	int inBaseVertexLocation, int inStartInstanceLocation )
+{
+	g_pImmediateContext->DrawIndexedInstanced( inIndexCountPerInstance, inInstanceCount, inStartIndexLocation,
+		inBaseVertexLocation, inStartInstanceLocation );
+}
+
 void GraphicsDriver::Present()
 {
 	g_pSwapChain->Present( 0, 0 );
@@ -695,7 +842,10 @@ RasterizerStatePtr GraphicsDriver::CreateRasterizerState( EFillMode inFillMode )
 
 void GraphicsDriver::SetRasterizerState(RasterizerStatePtr inRasterizerState)
 {
-	g_pImmediateContext->RSSetState( inRasterizerState.get() );
+	if( UpdateBinding( mCurrentRasterizerState, inRasterizerState ) )
+	{
+		g_pImmediateContext->RSSetState( inRasterizerState.get() );
+	}
 }
 
 BlendStatePtr GraphicsDriver::CreateBlendState(bool inEnableBlend)
@@ -721,6 +871,11 @@ BlendStatePtr GraphicsDriver::CreateBlendState(bool inEnableBlend)
 
 void GraphicsDriver::SetBlendState(BlendStatePtr inBlendState)
 {
+	if (!UpdateBinding(mCurrentBlendState, inBlendState))
+	{
+		return;
+	}
+
 	float blendFactor[4];
 
 
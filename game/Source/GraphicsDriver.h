@@ -39,6 +39,17 @@ enum EGFormat
 	EGF_R32G32_Float = DXGI_FORMAT_R32G32_FLOAT,
 	EGF_R8G8B8A8_UNorm = DXGI_FORMAT_R8G8B8A8_UNORM,
 	EGF_R8G8B8A8_UInt = DXGI_FORMAT_R8G8B8A8_UINT,
+	EGF_R16G16B16A16_UNorm = DXGI_FORMAT_R16G16B16A16_UNORM,
+	EGF_R16G16_SNorm = DXGI_FORMAT_R16G16_SNORM,
+	EGF_R16G16_Float = DXGI_FORMAT_R16G16_FLOAT,
+	EGF_R32_UInt = DXGI_FORMAT_R32_UINT,
+	EGF_R32G32_UInt = DXGI_FORMAT_R32G32_UINT,
+};
+
+enum EIndexFormat
+{
+	EIF_UInt16 = DXGI_FORMAT_R16_UINT,
+	EIF_UInt32 = DXGI_FORMAT_R32_UINT,
 };
 
 enum EFillMode
@@ -67,23 +78,32 @@ enum EComparisonFunc
 	ECF_Always = D3D11_COMPARISON_ALWAYS,
 };
 
+enum EInputClassification
+{
+	EIC_PerVertex = D3D11_INPUT_PER_VERTEX_DATA,
+	EIC_PerInstance = D3D11_INPUT_PER_INSTANCE_DATA,
+};
+
 enum ETextureFormat
 {
 	ETF_RGBA = DXGI_FORMAT_R8G8B8A8_UNORM,
 	EXT_BGRA = DXGI_FORMAT_B8G8R8A8_UNORM,
 };
 
+// Per instance elements read from their own slot, and advance once
+// every inStepRate instances
 struct InputLayoutElement : D3D11_INPUT_ELEMENT_DESC
 {
-	InputLayoutElement(const char* inSemanticName, uint32_t inSemanticIndex, EGFormat inFormat, uint32_t inByteOffset) 
+	InputLayoutElement(const char* inSemanticName, uint32_t inSemanticIndex, EGFormat inFormat, uint32_t inByteOffset,
+		uint32_t inInputSlot = 0, EInputClassification inClassification = EIC_PerVertex, uint32_t inStepRate = 0) 
 	{
 		SemanticName = inSemanticName;
 		SemanticIndex = inSemanticIndex;
 		Format = static_cast<DXGI_FORMAT>(inFormat);
-		InputSlot = 0;
+		InputSlot = inInputSlot;
 		AlignedByteOffset = inByteOffset;
-		InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-		InstanceDataStepRate = 0;
+		InputSlotClass = static_cast<D3D11_INPUT_CLASSIFICATION>(inClassification);
+		InstanceDataStepRate = inStepRate;
 	}
 };
 
@@ -120,6 +140,8 @@ public:
 	SamplerStatePtr CreateSamplerState();
 	GraphicsTexturePtr CreateTextureFromFile(const char* inFileName, int& outWidth, int& outHeight);
 	GraphicsTexturePtr CreateTextureFromMemory(const void* inPixels, int inWidth, int inHeight, ETextureFormat inTextureFormat);
+	// Lets a shader read a buffer created with EBF_ShaderResource as a Buffer<> of inFormat
+	GraphicsTexturePtr CreateBufferView(GraphicsBufferPtr inBuffer, EGFormat inFormat, uint32_t inNumElements);
 	DepthStencilPtr CreateDepthStencil(int inWidth, int inHeight);
 	DepthStencilStatePtr CreateDepthStencilState(bool inDepthTestEnable, EComparisonFunc inDepthComparisonFunction);
 	RasterizerStatePtr CreateRasterizerState(EFillMode inFillMode);
@@ -130,10 +152,13 @@ public:
 	void SetViewport(float inX, float inY, float inWidth, float inHeight);
 	void SetInputLayout(InputLayoutPtr inLayout);
 	void SetPrimitiveTopology(EPrimitiveTopology inTopology);
-	void SetVertexBuffer(GraphicsBufferPtr inBuffer, uint32_t inVertexSize);
-	void SetIndexBuffer(GraphicsBufferPtr inBuffer);
+	void SetVertexBuffer(GraphicsBufferPtr inBuffer, uint32_t inVertexSize, uint32_t inSlot = 0);
+	void SetIndexBuffer(GraphicsBufferPtr inBuffer, EIndexFormat inFormat = EIF_UInt16);
 	void SetVertexShader(VertexShaderPtr inVertexShader);
 	void SetVSConstantBuffer(GraphicsBufferPtr inBuffer, int inStartSlot);
+	// Binds part of a buffer, in 16-byte constants. Both numbers have to
+	// be multiples of 16. Only works if SupportsConstantBufferOffsets.
+	void SetVSConstantBufferRange(GraphicsBufferPtr inBuffer, int inStartSlot, uint32_t inFirstConstant, uint32_t inNumConstants);
 	void SetPixelShader(PixelShaderPtr inPixelShader);
 	void SetPSConstantBuffer(GraphicsBufferPtr inBuffer, int inStartSlot);
 	void SetPSSamplerState(SamplerStatePtr inSamplerState, int inStartSlot);
@@ -157,17 +182,93 @@ public:
 	void ClearDepthStencil(DepthStencilPtr inDepthStencil, float inDepth);
 	void Draw(int inVertexCount, int inStartVertexIndex);
 	void DrawIndexed(int inIndexCount, int inStartIndexLocation, int inBaseVertexLocation);
+	void DrawIndexedInstanced(int inIndexCountPerInstance, int inInstanceCount, int inStartIndexLocation,
+		int inBaseVertexLocation, int inStartInstanceLocation);
 	void Present();
 
 	uint32_t GetWindowWidth() const { return mWindowWidth; }
 	uint32_t GetWindowHeight() const { return mWindowHeight; }
 
+	// Whether SetVSConstantBufferRange can be used (D3D 11.1)
+	bool SupportsConstantBufferOffsets() const { return mSupportsConstantBufferOffsets; }
+
+	// The driver remembers what's bound, and Set* calls that wouldn't
+	// change anything never reach the device. These count both kinds.
+	struct StateStats
+	{
+		size_t mNumIssued;
+		size_t mNumFiltered;
+	};
+	const StateStats& GetStateStats() const { return mStateStats; }
+	void ResetStateStats();
+
+	// Forgets everything that's bound, so the next Set* calls all go to
+	// the device. Use this if anything changes the context directly.
+	void InvalidateStateCache();
+
 private:
+	// Slots past these aren't shadowed, and always go to the device
+	static const int kMaxVertexBufferSlots = 2;
+	static const int kMaxConstantBufferSlots = 4;
+	static const int kMaxSamplerSlots = 2;
+	static const int kMaxTextureSlots = 8;
+
+	struct VertexBufferBinding
+	{
+		GraphicsBufferPtr mBuffer;
+		uint32_t mVertexSize;
+		bool operator==(const VertexBufferBinding& other) const
+		{
+			return mBuffer == other.mBuffer && mVertexSize == other.mVertexSize;
+		}
+	};
+
+	struct IndexBufferBinding
+	{
+		GraphicsBufferPtr mBuffer;
+		EIndexFormat mFormat;
+		bool operator==(const IndexBufferBinding& other) const
+		{
+			return mBuffer == other.mBuffer && mFormat == other.mFormat;
+		}
+	};
+
+	// Returns true (and remembers inNew) if the device needs to hear about it
+	template<typename T>
+	bool UpdateBinding(T& ioCurrent, const T& inNew)
+	{
+		if (ioCurrent == inNew)
+		{
+			mStateStats.mNumFiltered++;
+			return false;
+		}
+		ioCurrent = inNew;
+		mStateStats.mNumIssued++;
+		return true;
+	}
+
 	uint32_t mWindowWidth, mWindowHeight;
+	bool mSupportsConstantBufferOffsets;
 
 	RenderTargetPtr mBackBufferRenderTarget;
 
 	RenderTargetPtr	mCurrentRenderTarget;
 	DepthStencilPtr mCurrentDepthStencil;
 
+	// What's currently bound on the device
+	InputLayoutPtr mCurrentInputLayout;
+	EPrimitiveTopology mCurrentTopology;
+	VertexBufferBinding mCurrentVertexBuffers[kMaxVertexBufferSlots];
+	IndexBufferBinding mCurrentIndexBuffer;
+	VertexShaderPtr mCurrentVertexShader;
+	PixelShaderPtr mCurrentPixelShader;
+	GraphicsBufferPtr mCurrentVSConstantBuffers[kMaxConstantBufferSlots];
+	GraphicsBufferPtr mCurrentPSConstantBuffers[kMaxConstantBufferSlots];
+	SamplerStatePtr mCurrentPSSamplers[kMaxSamplerSlots];
+	GraphicsTexturePtr mCurrentPSTextures[kMaxTextureSlots];
+	DepthStencilStatePtr mCurrentDepthStencilState;
+	RasterizerStatePtr mCurrentRasterizerState;
+	BlendStatePtr mCurrentBlendState;
+
+	StateStats mStateStats;
 };
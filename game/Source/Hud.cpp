@@ -0,0 +1,87 @@
+#include "ITPEnginePCH.h"
+#include "Hud.h"
+
+IMPL_ACTOR(Hud, Actor);
+
+Hud::Hud(Game& game)
+	:Actor(game)
+	,mNumRespawns(0)
+	,mWaitingToLand(false)
+{
+	mText = FontComponent::Create(*this);
+	mAudio = AudioComponent::Create(*this);
+}
+
+void Hud::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Top left of the screen (the 2D origin is the center)
+	Renderer& render = mGame.GetRenderer();
+	SetPosition(Vector3(render.GetWidth() / -2.0f + 20.0f, render.GetHeight() / 2.0f - 30.0f, 0.0f));
+
+	AssetCache& cache = mGame.GetAssetCache();
+	mText->SetFont(cache.Load<Font>("Fonts/Carlito-Regular.ttf"));
+	mRespawnSound = cache.Load<Sound>("Sounds/ShipDie.wav");
+	mLandSound = cache.Load<Sound>("Sounds/Checkpoint.wav");
+	UpdateText();
+
+	EventBus& bus = mGame.GetEventBus();
+	mRespawnHandle = bus.Subscribe<RespawnEvent>(this, &Hud::OnRespawn);
+	mTouchHandle = bus.Subscribe<TouchEvent>(this, &Hud::OnTouch);
+}
+
+void Hud::EndPlay()
+{
+	EventBus& bus = mGame.GetEventBus();
+	bus.Unsubscribe<RespawnEvent>(mRespawnHandle);
+	bus.Unsubscribe<TouchEvent>(mTouchHandle);
+
+	Super::EndPlay();
+}
+
+void Hud::OnRespawn(const RespawnEvent& event)
+{
+	mNumRespawns++;
+	mWaitingToLand = true;
+	UpdateText();
+
+	if (mRespawnSound)
+	{
+		mAudio->PlaySoundCue(mRespawnSound);
+	}
+}
+
+void Hud::OnTouch(const TouchEvent& event)
+{
+	if (!mWaitingToLand)
+	{
+		return;
+	}
+
+	// Touches come in every frame while two things overlap, so only
+	// chime for the first one after a respawn. The kill volume doesn't count.
+	Actor* other = nullptr;
+	if (IsA<Player>(*event.mFirst))
+	{
+		other = event.mSecond;
+	}
+	else if (IsA<Player>(*event.mSecond))
+	{
+		other = event.mFirst;
+	}
+
+	if (other && !IsA<KillVolume>(*other))
+	{
+		mWaitingToLand = false;
+		if (mLandSound)
+		{
+			mAudio->PlaySoundCue(mLandSound);
+		}
+	}
+}
+
+void Hud::UpdateText()
+{
+	mText->SetText("Respawns: " + std::to_string(mNumRespawns), Color::White);
+}
@@ -0,0 +1,38 @@
+// Hud.h
+// Screen overlay that follows gameplay through Game's EventBus,
+// so nothing has to know the HUD exists
+
+#pragma once
+#include "Actor.h"
+#include "AudioComponent.h"
+#include "FontComponent.h"
+#include "GameEvents.h"
+
+class Hud : public Actor
+{
+	DECL_ACTOR(Hud, Actor);
+public:
+	Hud(Game& game);
+
+	void BeginPlay() override;
+	void EndPlay() override;
+private:
+	void OnRespawn(const RespawnEvent& event);
+	void OnTouch(const TouchEvent& event);
+
+	void UpdateText();
+
+	FontComponentPtr mText;
+	AudioComponentPtr mAudio;
+	SoundPtr mRespawnSound;
+	SoundPtr mLandSound;
+
+	DelegateHandle mRespawnHandle;
+	DelegateHandle mTouchHandle;
+
+	int mNumRespawns;
+	// Set on respawn, cleared when the player lands on something
+	bool mWaitingToLand;
+};
+
+DECL_PTR(Hud);
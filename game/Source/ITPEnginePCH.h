@@ -18,6 +18,7 @@
 #include "SimdMath.h"
 #include "DbgAssert.h"
 #include "Delegate.h"
+#include "MulticastDelegate.h"
 #include "Random.h"
 #include "PoolAlloc.h"
 #include "BoneTransform.h"
@@ -6,11 +6,12 @@ void InputManager::HandleKeyPressed(int key)
 	auto actIter = mKeyToActionMap.find(key);
 	if (actIter != mKeyToActionMap.end())
 	{
-		// Trigger the "pressed" delegate if it exists
-		if (actIter->second->mPressedDelegate)
-		{
-			actIter->second->mPressedDelegate->Execute();
-		}
+		QueuedInput input;
+		input.mAction = actIter->second.get();
+		input.mAxis = nullptr;
+		input.mEvent = IE_Pressed;
+		input.mAxisValue = 0.0f;
+		mQueuedInput.push_back(input);
 	}
 
 	// Is this an axis?
@@ -26,10 +27,12 @@ void InputManager::HandleKeyPressed(int key)
 			axIter->second->mValue -= 1.0f;
 		}
 
-		if (axIter->second->mDelegate)
-		{
-			axIter->second->mDelegate->Execute(axIter->second->mValue);
-		}
+		QueuedInput input;
+		input.mAction = nullptr;
+		input.mAxis = axIter->second.get();
+		input.mEvent = IE_Pressed;
+		input.mAxisValue = axIter->second->mValue;
+		mQueuedInput.push_back(input);
 	}
 }
 
@@ -39,11 +42,12 @@ void InputManager::HandleKeyReleased(int key)
 	auto actIter = mKeyToActionMap.find(key);
 	if (actIter != mKeyToActionMap.end())
 	{
-		// Trigger the "pressed" delegate if it exists
-		if (actIter->second->mReleasedDelegate)
-		{
-			actIter->second->mReleasedDelegate->Execute();
-		}
+		QueuedInput input;
+		input.mAction = actIter->second.get();
+		input.mAxis = nullptr;
+		input.mEvent = IE_Released;
+		input.mAxisValue = 0.0f;
+		mQueuedInput.push_back(input);
 	}
 
 	// Is this an axis?
@@ -59,11 +63,38 @@ void InputManager::HandleKeyReleased(int key)
 			axIter->second->mValue += 1.0f;
 		}
 
-		if (axIter->second->mDelegate)
+		QueuedInput input;
+		input.mAction = nullptr;
+		input.mAxis = axIter->second.get();
+		input.mEvent = IE_Released;
+		input.mAxisValue = axIter->second->mValue;
+		mQueuedInput.push_back(input);
+	}
+}
+
+void InputManager::DispatchInput()
+{
+	// Mappings are never removed, so the raw pointers are safe here
+	for (size_t i = 0; i < mQueuedInput.size(); i++)
+	{
+		const QueuedInput& input = mQueuedInput[i];
+		if (input.mAction)
+		{
+			if (input.mEvent == IE_Pressed)
+			{
+				input.mAction->mPressedDelegates.Broadcast();
+			}
+			else
+			{
+				input.mAction->mReleasedDelegates.Broadcast();
+			}
+		}
+		else
 		{
-			axIter->second->mDelegate->Execute(axIter->second->mValue);
+			input.mAxis->mDelegates.Broadcast(input.mAxisValue);
 		}
 	}
+	mQueuedInput.clear();
 }
 
 void InputManager::AddActionMapping(const std::string& name, int key)
@@ -146,27 +177,56 @@ void InputManager::ParseMappings(const char* fileName)
 	}
 }
 
-void InputManager::BindActionInternal(const std::string& name, InputEvent event, ActionDelegatePtr delegate)
+DelegateHandle InputManager::BindAction(const std::string& name, InputEvent event, const ActionDelegate& delegate)
+{
+	auto iter = mNameToActionMap.find(name);
+	if (iter != mNameToActionMap.end())
+	{
+		if (event == IE_Pressed)
+		{
+			return iter->second->mPressedDelegates.Add(delegate);
+		}
+		else
+		{
+			return iter->second->mReleasedDelegates.Add(delegate);
+		}
+	}
+
+	return 0;
+}
+
+void InputManager::UnbindAction(const std::string& name, InputEvent event, DelegateHandle handle)
 {
 	auto iter = mNameToActionMap.find(name);
 	if (iter != mNameToActionMap.end())
 	{
 		if (event == IE_Pressed)
 		{
-			iter->second->mPressedDelegate = delegate;
+			iter->second->mPressedDelegates.Remove(handle);
 		}
 		else
 		{
-			iter->second->mReleasedDelegate = delegate;
+			iter->second->mReleasedDelegates.Remove(handle);
 		}
 	}
 }
 
-void InputManager::BindAxisInternal(const std::string& name, AxisDelegatePtr delegate)
+DelegateHandle InputManager::BindAxis(const std::string& name, const AxisDelegate& delegate)
+{
+	auto iter = mNameToAxisMap.find(name);
+	if (iter != mNameToAxisMap.end())
+	{
+		return iter->second->mDelegates.Add(delegate);
+	}
+
+	return 0;
+}
+
+void InputManager::UnbindAxis(const std::string& name, DelegateHandle handle)
 {
 	auto iter = mNameToAxisMap.find(name);
 	if (iter != mNameToAxisMap.end())
 	{
-		iter->second->mDelegate = delegate;
+		iter->second->mDelegates.Remove(handle);
 	}
 }
@@ -1,7 +1,8 @@
 #pragma once
 #include <unordered_map>
 #include <string>
-#include "Delegate.h"
+#include <vector>
+#include "MulticastDelegate.h"
 
 // Used to bind an action to pressed or released
 enum InputEvent
@@ -11,18 +12,23 @@ enum InputEvent
 };
 
 // Action delegate takes no parameters
-typedef DelegateNoParamsPtr ActionDelegatePtr;
+typedef Delegate<> ActionDelegate;
 
 // Axis delegate takes a single float parameter
-typedef std::shared_ptr<DelegateBase<float>> AxisDelegatePtr;
+typedef Delegate<float> AxisDelegate;
 
 class InputManager
 {
 public:
 	// These functions are called from Game when input events are received
+	// They only queue up the resulting action/axis events
 	void HandleKeyPressed(int key);
 	void HandleKeyReleased(int key);
 
+	// Sends out all the queued action/axis events in the order they
+	// happened -- called by Game once it's polled all the SDL events
+	void DispatchInput();
+
 	// Creates an action mapping with the specified name and key
 	void AddActionMapping(const std::string& name, int key);
 
@@ -30,42 +36,48 @@ public:
 	void AddAxisMapping(const std::string& name, int positiveKey, int negativeKey);
 
 	// Given the name of an action, binds a member function to be triggered by it
+	// Any number of functions can be bound to the same action
 	// Parameters:
 	// - Name of action
 	// - InputEvent type (either IE_Pressed or IE_Released)
 	// - Pointer to object (usually this)
 	// - Pointer to member function
+	// Returns a handle that can be passed to UnbindAction (0 if no such action)
 	template <typename T>
-	void BindAction(const std::string& name, InputEvent event,
+	DelegateHandle BindAction(const std::string& name, InputEvent event,
 		T* obj, void (T::*func)())
 	{
-		// Template magic to construct the delegate pointer and pass it
-		// to BindActionInternal
-		ActionDelegatePtr delegate = std::make_shared<Delegate<T>>(obj, func);
-		BindActionInternal(name, event, delegate);
+		return BindAction(name, event, ActionDelegate(obj, func));
 	}
 
+	// Same as above, but with any delegate (such as a lambda)
+	DelegateHandle BindAction(const std::string& name, InputEvent event,
+		const ActionDelegate& delegate);
+
+	void UnbindAction(const std::string& name, InputEvent event, DelegateHandle handle);
+
 	// Given the name of an axis, binds a member function to be triggered by it
+	// Any number of functions can be bound to the same axis
 	// Parameters:
 	// - Name of axis
 	// - Pointer to object (usually this)
 	// - Pointer to member function
+	// Returns a handle that can be passed to UnbindAxis (0 if no such axis)
 	template <typename T>
-	void BindAxis(const std::string& name, T* obj, void (T::*func)(float))
+	DelegateHandle BindAxis(const std::string& name, T* obj, void (T::*func)(float))
 	{
-		// Template magic to construct the delegate pointer and pass it
-		// to BindActionInternal
-		AxisDelegatePtr delegate = std::make_shared<Delegate<T, float>>(obj, func);
-		BindAxisInternal(name, delegate);
+		return BindAxis(name, AxisDelegate(obj, func));
 	}
 
+	// Same as above, but with any delegate (such as a lambda)
+	DelegateHandle BindAxis(const std::string& name, const AxisDelegate& delegate);
+
+	void UnbindAxis(const std::string& name, DelegateHandle handle);
+
 	// Parses input mappings from the specified file
 	// See Config/Mappings.itpconfig as an example of the JSON format
 	void ParseMappings(const char* fileName);
 private:
-	void BindActionInternal(const std::string& name, InputEvent event, 
-		ActionDelegatePtr delegate);
-	void BindAxisInternal(const std::string& name, AxisDelegatePtr delegate);
 
 	// Struct used for a mapping of a single action
 	struct ActionMapping
@@ -74,9 +86,9 @@ private:
 		std::string mName;
 		// Key associated with this mapping
 		int mKey;
-		// Delegate to trigger when action is "pressed"
-		ActionDelegatePtr mPressedDelegate;
-		ActionDelegatePtr mReleasedDelegate;
+		// Delegates to trigger when action is "pressed"/"released"
+		MulticastDelegate<> mPressedDelegates;
+		MulticastDelegate<> mReleasedDelegates;
 	};
 
 	typedef std::shared_ptr<ActionMapping> ActionMappingPtr;
@@ -92,12 +104,25 @@ private:
 		int mNegativeKey;
 		// Current value of this axis
 		float mValue;
-		// Delegate to trigger when value updates
-		AxisDelegatePtr mDelegate;
+		// Delegates to trigger when value updates
+		MulticastDelegate<float> mDelegates;
 	};
 
 	typedef std::shared_ptr<AxisMapping> AxisMappingPtr;
 
+	// An action or axis event waiting for DispatchInput
+	struct QueuedInput
+	{
+		// Exactly one of these is set
+		ActionMapping* mAction;
+		AxisMapping* mAxis;
+		InputEvent mEvent;
+		// Axis value at the time of the key event
+		float mAxisValue;
+	};
+
+	std::vector<QueuedInput> mQueuedInput;
+
 	// These map string names to either action or axis mappings
 	std::unordered_map<std::string, ActionMappingPtr>
 		mNameToActionMap;
@@ -0,0 +1,142 @@
+#include "ITPEnginePCH.h"
+
+namespace
+{
+	// Set on worker threads (and while the caller is running chunks),
+	// so nested ParallelFors run inline instead of deadlocking
+	thread_local bool sInParallelFor = false;
+}
+
+JobSystem::JobSystem()
+	:mJob(nullptr)
+	,mJobGeneration(0)
+	,mShuttingDown(false)
+{
+
+}
+
+JobSystem::~JobSystem()
+{
+	Shutdown();
+}
+
+void JobSystem::Init(size_t numWorkers)
+{
+	if (numWorkers == 0)
+	{
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		numWorkers = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+	}
+
+	mShuttingDown = false;
+	mWorkers.reserve(numWorkers);
+	for (size_t i = 0; i < numWorkers; i++)
+	{
+		mWorkers.emplace_back(&JobSystem::WorkerLoop, this);
+	}
+}
+
+void JobSystem::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mShuttingDown = true;
+	}
+	mWorkCV.notify_all();
+
+	for (auto& worker : mWorkers)
+	{
+		worker.join();
+	}
+	mWorkers.clear();
+}
+
+size_t JobSystem::ComputeChunkSize(size_t count, size_t minChunkSize) const
+{
+	// A few chunks per thread so uneven chunks even out
+	size_t targetChunks = GetNumThreads() * 4;
+	size_t chunkSize = (count + targetChunks - 1) / targetChunks;
+	return max(chunkSize, max(minChunkSize, static_cast<size_t>(1)));
+}
+
+void JobSystem::Run(Job& job)
+{
+	job.mNextChunk = 0;
+	job.mChunksDone = 0;
+	job.mWorkersInside = 0;
+
+	if (mWorkers.empty() || sInParallelFor || job.mNumChunks == 1)
+	{
+		job.mFunc(job.mContext, 0, job.mCount);
+		return;
+	}
+
+	std::lock_guard<std::mutex> submitLock(mSubmitMutex);
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mJob = &job;
+		mJobGeneration++;
+	}
+	mWorkCV.notify_all();
+
+	sInParallelFor = true;
+	RunChunks(job);
+	sInParallelFor = false;
+
+	// Wait for the workers to finish their chunks and let go of the job
+	std::unique_lock<std::mutex> lock(mMutex);
+	mDoneCV.wait(lock, [&job]
+	{
+		return job.mChunksDone == job.mNumChunks && job.mWorkersInside == 0;
+	});
+	mJob = nullptr;
+}
+
+void JobSystem::RunChunks(Job& job)
+{
+	size_t chunk = job.mNextChunk++;
+	while (chunk < job.mNumChunks)
+	{
+		size_t begin = chunk * job.mChunkSize;
+		size_t end = begin + job.mChunkSize;
+		if (end > job.mCount)
+		{
+			end = job.mCount;
+		}
+
+		job.mFunc(job.mContext, begin, end);
+		job.mChunksDone++;
+		chunk = job.mNextChunk++;
+	}
+}
+
+void JobSystem::WorkerLoop()
+{
+	sInParallelFor = true;
+	unsigned int lastGeneration = 0;
+
+	std::unique_lock<std::mutex> lock(mMutex);
+	while (true)
+	{
+		mWorkCV.wait(lock, [this, &lastGeneration]
+		{
+			return mShuttingDown || (mJob != nullptr && mJobGeneration != lastGeneration);
+		});
+
+		if (mShuttingDown)
+		{
+			return;
+		}
+
+		Job* job = mJob;
+		lastGeneration = mJobGeneration;
+		job->mWorkersInside++;
+
+		lock.unlock();
+		RunChunks(*job);
+		lock.lock();
+
+		job->mWorkersInside--;
+		mDoneCV.notify_all();
+	}
+}
@@ -0,0 +1,85 @@
+// JobSystem.h
+// A small pool of worker threads for splitting up data parallel work.
+// Usage:
+// jobs.ParallelFor(count, 256, [&](size_t begin, size_t end)
+// {
+//     for (size_t i = begin; i < end; i++) { ... }
+// });
+// The calling thread helps out and ParallelFor returns once every
+// index has been processed, so the function can safely capture
+// locals by reference.
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem
+{
+public:
+	JobSystem();
+	~JobSystem();
+
+	// numWorkers = 0 means one less than the number of hardware threads
+	void Init(size_t numWorkers = 0);
+	void Shutdown();
+
+	// Number of threads (including the caller) that run ParallelFor work
+	size_t GetNumThreads() const { return mWorkers.size() + 1; }
+
+	// Calls func(begin, end) on ranges covering [0, count), each at least
+	// minChunkSize long (except the last). If this is called from inside
+	// another ParallelFor, it just runs on the current thread.
+	template <typename Func>
+	void ParallelFor(size_t count, size_t minChunkSize, const Func& func)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+
+		Job job;
+		job.mFunc = &InvokeRange<Func>;
+		job.mContext = &func;
+		job.mCount = count;
+		job.mChunkSize = ComputeChunkSize(count, minChunkSize);
+		job.mNumChunks = (count + job.mChunkSize - 1) / job.mChunkSize;
+		Run(job);
+	}
+private:
+	struct Job
+	{
+		void (*mFunc)(const void* context, size_t begin, size_t end);
+		const void* mContext;
+		size_t mCount;
+		size_t mChunkSize;
+		size_t mNumChunks;
+		std::atomic<size_t> mNextChunk;
+		std::atomic<size_t> mChunksDone;
+		// Guarded by mMutex
+		size_t mWorkersInside;
+	};
+
+	template <typename Func>
+	static void InvokeRange(const void* context, size_t begin, size_t end)
+	{
+		(*static_cast<const Func*>(context))(begin, end);
+	}
+
+	size_t ComputeChunkSize(size_t count, size_t minChunkSize) const;
+	void Run(Job& job);
+	static void RunChunks(Job& job);
+	void WorkerLoop();
+
+	std::vector<std::thread> mWorkers;
+	// Only one ParallelFor is handed to the workers at a time
+	std::mutex mSubmitMutex;
+	std::mutex mMutex;
+	std::condition_variable mWorkCV;
+	std::condition_variable mDoneCV;
+	Job* mJob;
+	unsigned int mJobGeneration;
+	bool mShuttingDown;
+};
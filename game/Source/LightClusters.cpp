@@ -0,0 +1,148 @@
+#include "ITPEnginePCH.h"
+#include "LightClusters.h"
+
+LightClusters::LightClusters()
+	:mWidth(0)
+	,mHeight(0)
+	,mNear(1.0f)
+	,mFar(2.0f)
+	,mNumTilesX(0)
+	,mNumTilesY(0)
+	,mSliceScale(0.0f)
+	,mSliceBias(0.0f)
+{
+
+}
+
+void LightClusters::Init(int width, int height, float nearPlane, float farPlane)
+{
+	mWidth = width;
+	mHeight = height;
+	mNear = nearPlane;
+	mFar = farPlane;
+	mNumTilesX = (width + kTileSize - 1) / kTileSize;
+	mNumTilesY = (height + kTileSize - 1) / kTileSize;
+
+	// Slices are evenly spaced in log(depth), so near slices are thin
+	// and far ones thick, which keeps clusters roughly cube shaped
+	float logRange = logf(farPlane / nearPlane);
+	// (kNumSlices is unsigned, so convert before negating)
+	float numSlices = static_cast<float>(kNumSlices);
+	mSliceScale = numSlices / logRange;
+	mSliceBias = -numSlices * logf(nearPlane) / logRange;
+
+	mClusters.resize(mNumTilesX * mNumTilesY * kNumSlices);
+	Cluster empty = { 0, 0 };
+	std::fill(mClusters.begin(), mClusters.end(), empty);
+	mLightIndices.clear();
+}
+
+uint32_t LightClusters::GetSlice(float depth) const
+{
+	if (depth <= mNear)
+	{
+		return 0;
+	}
+	int slice = static_cast<int>(logf(depth) * mSliceScale + mSliceBias);
+	return static_cast<uint32_t>(Math::Clamp(slice, 0, static_cast<int>(kNumSlices) - 1));
+}
+
+bool LightClusters::ComputeBounds(const Vector3& center, float radius, const Matrix4& proj, ClusterBounds& outBounds) const
+{
+	float zMin = max(center.z - radius, mNear);
+	float zMax = min(center.z + radius, mFar);
+	if (zMin > zMax)
+	{
+		return false;
+	}
+
+	// Project the sphere's bounding box. x / z over the box is most
+	// extreme at one of its corners, so this is conservative.
+	float minX = center.x - radius;
+	float maxX = center.x + radius;
+	float minY = center.y - radius;
+	float maxY = center.y + radius;
+	float ndcMinX = proj.mat[0][0] * (minX < 0.0f ? minX / zMin : minX / zMax);
+	float ndcMaxX = proj.mat[0][0] * (maxX > 0.0f ? maxX / zMin : maxX / zMax);
+	float ndcMinY = proj.mat[1][1] * (minY < 0.0f ? minY / zMin : minY / zMax);
+	float ndcMaxY = proj.mat[1][1] * (maxY > 0.0f ? maxY / zMin : maxY / zMax);
+	if (ndcMaxX < -1.0f || ndcMinX > 1.0f || ndcMaxY < -1.0f || ndcMinY > 1.0f)
+	{
+		return false;
+	}
+
+	// To tiles, which have y going down the screen
+	float tilesPerNdcX = mWidth * 0.5f / kTileSize;
+	float tilesPerNdcY = mHeight * 0.5f / kTileSize;
+	int lastX = static_cast<int>(mNumTilesX) - 1;
+	int lastY = static_cast<int>(mNumTilesY) - 1;
+	outBounds.mMinX = Math::Clamp(static_cast<int>((ndcMinX + 1.0f) * tilesPerNdcX), 0, lastX);
+	outBounds.mMaxX = Math::Clamp(static_cast<int>((ndcMaxX + 1.0f) * tilesPerNdcX), 0, lastX);
+	outBounds.mMinY = Math::Clamp(static_cast<int>((1.0f - ndcMaxY) * tilesPerNdcY), 0, lastY);
+	outBounds.mMaxY = Math::Clamp(static_cast<int>((1.0f - ndcMinY) * tilesPerNdcY), 0, lastY);
+	outBounds.mMinSlice = GetSlice(zMin);
+	outBounds.mMaxSlice = GetSlice(zMax);
+	return true;
+}
+
+void LightClusters::Build(const std::vector<PointLightData>& lights, const Matrix4& view, const Matrix4& proj)
+{
+	for (auto& cluster : mClusters)
+	{
+		cluster.mCount = 0;
+	}
+
+	// Find the clusters each light reaches, and count the lights in each cluster
+	mVisibleLights.clear();
+	mVisibleBounds.clear();
+	for (size_t i = 0; i < lights.size(); i++)
+	{
+		const PointLightData& light = lights[i];
+		ClusterBounds bounds;
+		if (!light.mEnabled ||
+			!ComputeBounds(Transform(light.mPosition, view), light.mOuterRadius, proj, bounds))
+		{
+			continue;
+		}
+
+		mVisibleLights.push_back(static_cast<uint32_t>(i));
+		mVisibleBounds.push_back(bounds);
+		for (uint32_t slice = bounds.mMinSlice; slice <= bounds.mMaxSlice; slice++)
+		{
+			for (uint32_t y = bounds.mMinY; y <= bounds.mMaxY; y++)
+			{
+				for (uint32_t x = bounds.mMinX; x <= bounds.mMaxX; x++)
+				{
+					mClusters[GetClusterIndex(x, y, slice)].mCount++;
+				}
+			}
+		}
+	}
+
+	// Give each cluster its own run of the index list
+	uint32_t total = 0;
+	for (auto& cluster : mClusters)
+	{
+		cluster.mOffset = total;
+		total += cluster.mCount;
+		cluster.mCount = 0;
+	}
+	mLightIndices.resize(total);
+
+	// Then fill them in
+	for (size_t i = 0; i < mVisibleLights.size(); i++)
+	{
+		const ClusterBounds& bounds = mVisibleBounds[i];
+		for (uint32_t slice = bounds.mMinSlice; slice <= bounds.mMaxSlice; slice++)
+		{
+			for (uint32_t y = bounds.mMinY; y <= bounds.mMaxY; y++)
+			{
+				for (uint32_t x = bounds.mMinX; x <= bounds.mMaxX; x++)
+				{
+					Cluster& cluster = mClusters[GetClusterIndex(x, y, slice)];
+					mLightIndices[cluster.mOffset + cluster.mCount++] = mVisibleLights[i];
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,78 @@
+// LightClusters.h
+// Splits the view frustum into clusters (screen tiles, each cut into
+// depth slices) and works out which point lights reach each of them.
+// The pixel shader then only lights a pixel with the lights in its
+// cluster, instead of every light in the scene.
+
+#pragma once
+#include "Math.h"
+#include "PointLightData.h"
+#include <vector>
+
+class LightClusters
+{
+public:
+	// Size of a tile in pixels
+	static const uint32_t kTileSize = 64;
+	// The depth range is cut into this many slices, which get thicker
+	// further from the camera
+	static const uint32_t kNumSlices = 16;
+
+	// Where a cluster's lights are in GetLightIndices
+	struct Cluster
+	{
+		uint32_t mOffset;
+		uint32_t mCount;
+	};
+
+	LightClusters();
+
+	void Init(int width, int height, float nearPlane, float farPlane);
+
+	// Works out which lights reach each cluster. Disabled lights aren't in any.
+	void Build(const std::vector<PointLightData>& lights, const Matrix4& view, const Matrix4& proj);
+
+	uint32_t GetNumTilesX() const { return mNumTilesX; }
+	uint32_t GetNumTilesY() const { return mNumTilesY; }
+	uint32_t GetClusterIndex(uint32_t x, uint32_t y, uint32_t slice) const
+	{
+		return (slice * mNumTilesY + y) * mNumTilesX + x;
+	}
+
+	// slice = log(depth) * scale + bias, clamped to the valid slices
+	// (the shaders use the same formula)
+	uint32_t GetSlice(float depth) const;
+	float GetSliceScale() const { return mSliceScale; }
+	float GetSliceBias() const { return mSliceBias; }
+
+	const std::vector<Cluster>& GetClusters() const { return mClusters; }
+	// Indices into the lights passed to Build
+	const std::vector<uint32_t>& GetLightIndices() const { return mLightIndices; }
+private:
+	// Inclusive range of clusters a light touches
+	struct ClusterBounds
+	{
+		uint32_t mMinX, mMaxX;
+		uint32_t mMinY, mMaxY;
+		uint32_t mMinSlice, mMaxSlice;
+	};
+
+	// Returns false if the sphere (in view space) is outside the frustum
+	bool ComputeBounds(const Vector3& center, float radius, const Matrix4& proj, ClusterBounds& outBounds) const;
+
+	int mWidth;
+	int mHeight;
+	float mNear;
+	float mFar;
+	uint32_t mNumTilesX;
+	uint32_t mNumTilesY;
+	float mSliceScale;
+	float mSliceBias;
+
+	std::vector<Cluster> mClusters;
+	std::vector<uint32_t> mLightIndices;
+
+	// Scratch space for Build
+	std::vector<uint32_t> mVisibleLights;
+	std::vector<ClusterBounds> mVisibleBounds;
+};
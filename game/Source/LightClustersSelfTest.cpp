@@ -0,0 +1,104 @@
+#include "ITPEnginePCH.h"
+#include "SelfTest.h"
+#include "LightClusters.h"
+
+namespace
+{
+	const int kWidth = 1024;
+	const int kHeight = 768;
+	const float kNear = 25.0f;
+	const float kFar = 10000.0f;
+	const int kNumLights = 300;
+	const int kNumSamples = 20000;
+
+	bool ClusterHasLight(const LightClusters& clusters, const LightClusters::Cluster& cluster, uint32_t light)
+	{
+		const std::vector<uint32_t>& indices = clusters.GetLightIndices();
+		for (uint32_t i = 0; i < cluster.mCount; i++)
+		{
+			if (indices[cluster.mOffset + i] == light)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+void SelfTest::RunLightClustersTests()
+{
+	Matrix4 view = Matrix4::CreateLookAt(Vector3(-500.0f, 200.0f, 100.0f),
+		Vector3(1000.0f, 0.0f, 0.0f), Vector3::UnitZ);
+	Matrix4 invView = view;
+	invView.Invert();
+	Matrix4 proj = Matrix4::CreatePerspectiveFOV(Math::ToRadians(70.0f),
+		static_cast<float>(kWidth), static_cast<float>(kHeight), kNear, kFar);
+
+	// Lights spread around (and behind) the camera, with some turned off
+	std::vector<PointLightData> lights(kNumLights);
+	for (auto& light : lights)
+	{
+		Vector3 viewPos = Random::GetVector(Vector3(-3000.0f, -2000.0f, -500.0f), Vector3(3000.0f, 2000.0f, 6000.0f));
+		light.mPosition = Transform(viewPos, invView);
+		light.mOuterRadius = Random::GetFloatRange(50.0f, 600.0f);
+		light.mEnabled = Random::GetFloatRange(0.0f, 1.0f) < 0.9f ? 1 : 0;
+	}
+
+	LightClusters clusters;
+	clusters.Init(kWidth, kHeight, kNear, kFar);
+	clusters.Build(lights, view, proj);
+
+	// Slices go from the near plane to the far plane, in order
+	SELF_CHECK(clusters.GetSlice(kNear) == 0);
+	SELF_CHECK(clusters.GetSlice(kFar) == LightClusters::kNumSlices - 1);
+	// Halfway in log(depth) is halfway through the slices
+	SELF_CHECK(clusters.GetSlice(sqrtf(kNear * kFar) * 1.01f) == LightClusters::kNumSlices / 2);
+	bool slicesInOrder = true;
+	for (float depth = kNear; depth < kFar; depth *= 1.05f)
+	{
+		slicesInOrder &= clusters.GetSlice(depth) <= clusters.GetSlice(depth * 1.05f);
+	}
+	SELF_CHECK(slicesInOrder);
+
+	// Every index points at an enabled light
+	bool indicesValid = clusters.GetClusters().size() ==
+		clusters.GetNumTilesX() * clusters.GetNumTilesY() * LightClusters::kNumSlices;
+	for (uint32_t index : clusters.GetLightIndices())
+	{
+		indicesValid &= index < lights.size() && lights[index].mEnabled;
+	}
+	SELF_CHECK(indicesValid);
+
+	// Any point a light reaches has that light in its cluster. Pick
+	// random pixels and depths, and check them against every light.
+	bool noLightsMissed = true;
+	int numReached = 0;
+	for (int s = 0; s < kNumSamples; s++)
+	{
+		float pixelX = Random::GetFloatRange(0.0f, kWidth - 0.01f);
+		float pixelY = Random::GetFloatRange(0.0f, kHeight - 0.01f);
+		float depth = expf(Random::GetFloatRange(logf(kNear), logf(kFar)));
+
+		// Back from the pixel to view space, then world space
+		float ndcX = pixelX / kWidth * 2.0f - 1.0f;
+		float ndcY = 1.0f - pixelY / kHeight * 2.0f;
+		Vector3 viewPoint(ndcX * depth / proj.mat[0][0], ndcY * depth / proj.mat[1][1], depth);
+		Vector3 worldPoint = Transform(viewPoint, invView);
+
+		uint32_t clusterIndex = clusters.GetClusterIndex(static_cast<uint32_t>(pixelX) / LightClusters::kTileSize,
+			static_cast<uint32_t>(pixelY) / LightClusters::kTileSize, clusters.GetSlice(depth));
+		const LightClusters::Cluster& cluster = clusters.GetClusters()[clusterIndex];
+		for (size_t i = 0; i < lights.size(); i++)
+		{
+			if (lights[i].mEnabled &&
+				(worldPoint - lights[i].mPosition).Length() <= lights[i].mOuterRadius)
+			{
+				numReached++;
+				noLightsMissed &= ClusterHasLight(clusters, cluster, static_cast<uint32_t>(i));
+			}
+		}
+	}
+	SELF_CHECK(noLightsMissed);
+	// Make sure the samples actually hit some lights
+	SELF_CHECK(numReached > 0);
+}
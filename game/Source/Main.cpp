@@ -1,7 +1,19 @@
 #include "ITPEnginePCH.h"
+#include "MathBench.h"
+#include "SelfTest.h"
 
 int main(int argc, char* argv[])
 {
+#ifdef MATH_BENCH
+	// Benchmark builds don't run the game at all
+	return MathBench::Run();
+#else
+	// Headless checks, without a window or a device
+	if (argc > 1 && strcmp(argv[1], "-selftest") == 0)
+	{
+		return SelfTest::RunAll();
+	}
+
 	Game game;
 	
 	if (game.Init())
@@ -10,4 +22,5 @@ int main(int argc, char* argv[])
 	}
 
 	return 0;
+#endif
 }
@@ -43,6 +43,12 @@ const Quaternion Quaternion::Identity(0.0f, 0.0f, 0.0f, 1.0f);
 
 void Matrix4::Invert()
 {
+#if MATH_SSE
+	// Same cofactor expansion, four lanes at a time
+	SimdMatrix4 temp(*this);
+	temp.Invert();
+	*this = temp.ToMatrix4();
+#else
 	// Thanks slow math
 	float tmp[12]; /* temp array for pairs */
 	float src[16]; /* array of transpose source matrix */
@@ -155,6 +161,7 @@ void Matrix4::Invert()
 			mat[i][j] = dst[i * 4 + j];
 		}
 	}
+#endif
 }
 
 Matrix4 Matrix4::CreateFromQuaternion(const class Quaternion& q)
@@ -7,10 +7,66 @@
 #include <memory.h>
 #include <xmmintrin.h>
 
+// SIMD instruction set selection, based on what the compiler is targeting.
+// Define MATH_NO_SIMD to force the scalar paths everywhere.
+#if !defined(MATH_NO_SIMD) && (defined(_M_X64) || defined(_M_AMD64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__))
+#define MATH_SSE 1
+#else
+#define MATH_SSE 0
+#endif
+
+// MSVC doesn't define __FMA__, but every /arch:AVX2 target has FMA3
+#if MATH_SSE && (defined(__AVX2__) || defined(__FMA__))
+#define MATH_FMA 1
+#else
+#define MATH_FMA 0
+#endif
+
+#if MATH_SSE && defined(__AVX2__)
+#define MATH_AVX2 1
+#else
+#define MATH_AVX2 0
+#endif
+
+#if MATH_FMA || MATH_AVX2
+#include <immintrin.h>
+#endif
+
 // Stupid windows defines...
 #undef far
 #undef near
 
+// Small helpers shared by the SSE paths here and in SimdMath.h
+namespace Simd
+{
+	// a * b + c, as a single instruction when we have FMA
+	inline __m128 MulAdd(__m128 a, __m128 b, __m128 c)
+	{
+#if MATH_FMA
+		return _mm_fmadd_ps(a, b, c);
+#else
+		return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+	}
+
+	// Broadcast component i of v to all four components
+	template <int i>
+	inline __m128 Splat(__m128 v)
+	{
+		return _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i));
+	}
+
+	// v * rows, where rows are the four rows of a row-major matrix
+	inline __m128 MulRows(__m128 v, __m128 r0, __m128 r1, __m128 r2, __m128 r3)
+	{
+		__m128 result = _mm_mul_ps(Splat<0>(v), r0);
+		result = MulAdd(Splat<1>(v), r1, result);
+		result = MulAdd(Splat<2>(v), r2, result);
+		return MulAdd(Splat<3>(v), r3, result);
+	}
+}
+
 namespace Math
 {
 	const float Pi = 3.1415926535f;
@@ -587,6 +643,18 @@ public:
 	friend Matrix4 operator*(const Matrix4& a, const Matrix4& b)
 	{
 		Matrix4 retVal;
+#if MATH_SSE
+		// Each row of the result is a linear combination of b's rows
+		__m128 b0 = _mm_loadu_ps(b.mat[0]);
+		__m128 b1 = _mm_loadu_ps(b.mat[1]);
+		__m128 b2 = _mm_loadu_ps(b.mat[2]);
+		__m128 b3 = _mm_loadu_ps(b.mat[3]);
+		for (int i = 0; i < 4; i++)
+		{
+			_mm_storeu_ps(retVal.mat[i],
+				Simd::MulRows(_mm_loadu_ps(a.mat[i]), b0, b1, b2, b3));
+		}
+#else
 		// row 0
 		retVal.mat[0][0] = 
 			a.mat[0][0] * b.mat[0][0] + 
@@ -686,6 +754,7 @@ public:
 			a.mat[3][1] * b.mat[1][3] +
 			a.mat[3][2] * b.mat[2][3] +
 			a.mat[3][3] * b.mat[3][3];
+#endif
 		
 		return retVal;
 	}
@@ -696,7 +765,7 @@ public:
 		return *this;
 	}
 
-	// Invert the matrix - super slow
+	// Invert the matrix (general 4x4 cofactor inverse)
 	void Invert();
 
 	// Get the translation component of the matrix
@@ -999,6 +1068,24 @@ public:
 	friend Quaternion Concatenate(const Quaternion& q, const Quaternion& p)
 	{
 		Quaternion retVal;
+#if MATH_SSE
+		// Same as below, written out as the Hamilton product p * q:
+		// p.w * q + p.x * <qw,-qz,qy,-qx> + p.y * <qz,qw,-qx,-qy> + p.z * <-qy,qx,qw,-qz>
+		const __m128 signX = _mm_setr_ps(1.0f, -1.0f, 1.0f, -1.0f);
+		const __m128 signY = _mm_setr_ps(1.0f, 1.0f, -1.0f, -1.0f);
+		const __m128 signZ = _mm_setr_ps(-1.0f, 1.0f, 1.0f, -1.0f);
+		__m128 qVec = _mm_loadu_ps(&q.x);
+		__m128 pVec = _mm_loadu_ps(&p.x);
+
+		__m128 result = _mm_mul_ps(Simd::Splat<3>(pVec), qVec);
+		result = Simd::MulAdd(_mm_mul_ps(Simd::Splat<0>(pVec), signX),
+			_mm_shuffle_ps(qVec, qVec, _MM_SHUFFLE(0, 1, 2, 3)), result);
+		result = Simd::MulAdd(_mm_mul_ps(Simd::Splat<1>(pVec), signY),
+			_mm_shuffle_ps(qVec, qVec, _MM_SHUFFLE(1, 0, 3, 2)), result);
+		result = Simd::MulAdd(_mm_mul_ps(Simd::Splat<2>(pVec), signZ),
+			_mm_shuffle_ps(qVec, qVec, _MM_SHUFFLE(2, 3, 0, 1)), result);
+		_mm_storeu_ps(&retVal.x, result);
+#else
 
 		// Vector component is:
 		// ps * qv + qs * pv + pv x qv
@@ -1012,6 +1099,7 @@ public:
 		// Scalar component is:
 		// ps * qs - pv . qv
 		retVal.w = p.w * q.w - Dot(pv, qv);
+#endif
 
 		return retVal;
 	}
@@ -1037,6 +1125,12 @@ inline Vector2 Transform(const Vector2& vec, const Matrix3& mat, float z = 1.0f)
 
 inline Vector3 Transform(const Vector3& vec, const Matrix4& mat, float w = 1.0f)
 {
+#if MATH_SSE
+	__m128 result = Simd::MulRows(_mm_setr_ps(vec.x, vec.y, vec.z, w),
+		_mm_loadu_ps(mat.mat[0]), _mm_loadu_ps(mat.mat[1]),
+		_mm_loadu_ps(mat.mat[2]), _mm_loadu_ps(mat.mat[3]));
+	return Vector3(result);
+#else
 	Vector3 retVal;
 	retVal.x = vec.x * mat.mat[0][0] + vec.y * mat.mat[1][0] + 
 		vec.z * mat.mat[2][0] + w * mat.mat[3][0];
@@ -1046,11 +1140,19 @@ inline Vector3 Transform(const Vector3& vec, const Matrix4& mat, float w = 1.0f)
 		vec.z * mat.mat[2][2] + w * mat.mat[3][2];
 	//ignore w since we aren't returning a new value for it...
 	return retVal;
+#endif
 }
 
 // This will transform the vector and renormalize the w component
 inline Vector3 TransformWithPerspDiv(const Vector3& vec, const Matrix4& mat, float w = 1.0f)
 {
+#if MATH_SSE
+	__m128 result = Simd::MulRows(_mm_setr_ps(vec.x, vec.y, vec.z, w),
+		_mm_loadu_ps(mat.mat[0]), _mm_loadu_ps(mat.mat[1]),
+		_mm_loadu_ps(mat.mat[2]), _mm_loadu_ps(mat.mat[3]));
+	Vector3 retVal(result);
+	float transformedW = _mm_cvtss_f32(Simd::Splat<3>(result));
+#else
 	Vector3 retVal;
 	retVal.x = vec.x * mat.mat[0][0] + vec.y * mat.mat[1][0] +
 		vec.z * mat.mat[2][0] + w * mat.mat[3][0];
@@ -1060,6 +1162,7 @@ inline Vector3 TransformWithPerspDiv(const Vector3& vec, const Matrix4& mat, flo
 		vec.z * mat.mat[2][2] + w * mat.mat[3][2];
 	float transformedW = vec.x * mat.mat[0][3] + vec.y * mat.mat[1][3] +
 		vec.z * mat.mat[2][3] + w * mat.mat[3][3];
+#endif
 	if (!Math::IsZero(Math::Abs(transformedW)))
 	{
 		transformedW = 1.0f / transformedW;
@@ -0,0 +1,177 @@
+#include "ITPEnginePCH.h"
+#include "MathBench.h"
+
+#ifdef MATH_BENCH
+#include <chrono>
+#include <vector>
+
+namespace
+{
+	// Enough data to not fit in L1, small enough to stay in L2
+	const size_t kNumItems = 1024;
+	const int kNumRepeats = 2000;
+
+	// Plain versions of the operations, the same math as the
+	// MATH_NO_SIMD paths in Math.h
+	Matrix4 ScalarMul(const Matrix4& a, const Matrix4& b)
+	{
+		Matrix4 retVal;
+		for (int i = 0; i < 4; i++)
+		{
+			for (int j = 0; j < 4; j++)
+			{
+				retVal.mat[i][j] = a.mat[i][0] * b.mat[0][j] + a.mat[i][1] * b.mat[1][j] +
+					a.mat[i][2] * b.mat[2][j] + a.mat[i][3] * b.mat[3][j];
+			}
+		}
+		return retVal;
+	}
+
+	Vector3 ScalarTransform(const Vector3& vec, const Matrix4& mat)
+	{
+		return Vector3(
+			vec.x * mat.mat[0][0] + vec.y * mat.mat[1][0] + vec.z * mat.mat[2][0] + mat.mat[3][0],
+			vec.x * mat.mat[0][1] + vec.y * mat.mat[1][1] + vec.z * mat.mat[2][1] + mat.mat[3][1],
+			vec.x * mat.mat[0][2] + vec.y * mat.mat[1][2] + vec.z * mat.mat[2][2] + mat.mat[3][2]);
+	}
+
+	Quaternion ScalarConcatenate(const Quaternion& q, const Quaternion& p)
+	{
+		Vector3 qv(q.x, q.y, q.z);
+		Vector3 pv(p.x, p.y, p.z);
+		Vector3 newVec = p.w * qv + q.w * pv + Cross(pv, qv);
+		return Quaternion(newVec.x, newVec.y, newVec.z, p.w * q.w - Dot(pv, qv));
+	}
+
+	// Times kNumRepeats calls of func, and returns nanoseconds per item
+	template <typename Func>
+	double Time(Func func)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < kNumRepeats; i++)
+		{
+			func();
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+		double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+		return ns / (static_cast<double>(kNumRepeats) * kNumItems);
+	}
+
+	void Report(const char* name, double simd, double scalar)
+	{
+		SDL_Log("%-24s %8.2f ns  (scalar %8.2f ns, %.2fx)", name, simd, scalar, scalar / simd);
+	}
+
+	// Keeps the compiler from throwing the results away
+	volatile float sSink;
+}
+
+int MathBench::Run()
+{
+#if MATH_FMA
+	SDL_Log("MathBench: SSE + FMA");
+#elif MATH_SSE
+	SDL_Log("MathBench: SSE");
+#else
+	SDL_Log("MathBench: scalar (MATH_NO_SIMD)");
+#endif
+
+	Random::Init();
+	std::vector<Matrix4> matrices(kNumItems);
+	std::vector<Quaternion> quats(kNumItems);
+	std::vector<Vector3> points(kNumItems);
+	for (size_t i = 0; i < kNumItems; i++)
+	{
+		Vector3 axis = Random::GetVector(Vector3(-1.0f, -1.0f, -1.0f), Vector3(1.0f, 1.0f, 1.0f));
+		axis.Normalize();
+		quats[i] = Quaternion(axis, Random::GetFloatRange(0.0f, Math::TwoPi));
+		matrices[i] = Matrix4::CreateScale(Random::GetFloatRange(0.5f, 2.0f)) *
+			Matrix4::CreateFromQuaternion(quats[i]) *
+			Matrix4::CreateTranslation(Random::GetVector(Vector3(-100.0f, -100.0f, -100.0f), Vector3(100.0f, 100.0f, 100.0f)));
+		points[i] = Random::GetVector(Vector3(-100.0f, -100.0f, -100.0f), Vector3(100.0f, 100.0f, 100.0f));
+	}
+	std::vector<Matrix4> outMatrices(kNumItems);
+	std::vector<Vector3> outPoints(kNumItems);
+	std::vector<Quaternion> outQuats(kNumItems);
+
+	// Matrix4 * Matrix4
+	double simd = Time([&]
+	{
+		for (size_t i = 0; i < kNumItems; i++)
+		{
+			outMatrices[i] = matrices[i] * matrices[(i + 1) % kNumItems];
+		}
+	});
+	double scalar = Time([&]
+	{
+		for (size_t i = 0; i < kNumItems; i++)
+		{
+			outMatrices[i] = ScalarMul(matrices[i], matrices[(i + 1) % kNumItems]);
+		}
+	});
+	sSink = outMatrices[kNumItems / 2].mat[1][2];
+	Report("Matrix4 * Matrix4", simd, scalar);
+
+	// Transform(Vector3, Matrix4)
+	simd = Time([&]
+	{
+		for (size_t i = 0; i < kNumItems; i++)
+		{
+			outPoints[i] = Transform(points[i], matrices[i]);
+		}
+	});
+	scalar = Time([&]
+	{
+		for (size_t i = 0; i < kNumItems; i++)
+		{
+			outPoints[i] = ScalarTransform(points[i], matrices[i]);
+		}
+	});
+	sSink = outPoints[kNumItems / 2].y;
+	Report("Transform(Vector3)", simd, scalar);
+
+	// Quaternion Concatenate
+	simd = Time([&]
+	{
+		for (size_t i = 0; i < kNumItems; i++)
+		{
+			outQuats[i] = Concatenate(quats[i], quats[(i + 1) % kNumItems]);
+		}
+	});
+	scalar = Time([&]
+	{
+		for (size_t i = 0; i < kNumItems; i++)
+		{
+			outQuats[i] = ScalarConcatenate(quats[i], quats[(i + 1) % kNumItems]);
+		}
+	});
+	sSink = outQuats[kNumItems / 2].z;
+	Report("Concatenate", simd, scalar);
+
+	// Matrix4::Invert only has the one version per build, so there's no
+	// scalar column here (compare against a MATH_NO_SIMD build instead)
+	simd = Time([&]
+	{
+		for (size_t i = 0; i < kNumItems; i++)
+		{
+			outMatrices[i] = matrices[i];
+			outMatrices[i].Invert();
+		}
+	});
+	sSink = outMatrices[kNumItems / 2].mat[3][0];
+	SDL_Log("%-24s %8.2f ns", "Matrix4::Invert", simd);
+
+	// Matrix4::CreateFromQuaternion
+	simd = Time([&]
+	{
+		for (size_t i = 0; i < kNumItems; i++)
+		{
+			outMatrices[i] = Matrix4::CreateFromQuaternion(quats[i]);
+		}
+	});
+	sSink = outMatrices[kNumItems / 2].mat[0][1];
+	SDL_Log("%-24s %8.2f ns", "CreateFromQuaternion", simd);
+
+	return 0;
+}
+#endif
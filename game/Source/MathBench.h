@@ -0,0 +1,16 @@
+// MathBench.h
+// Microbenchmarks for the hot Math.h operations. Only compiled when
+// MATH_BENCH is defined, in which case main runs these instead of the
+// game. Each result is printed next to a plain scalar version of the
+// same operation; build again with MATH_NO_SIMD as well to time the
+// scalar fallbacks of everything (Invert included).
+
+#pragma once
+
+#ifdef MATH_BENCH
+namespace MathBench
+{
+	// Returns 0, so main can return it
+	int Run();
+}
+#endif
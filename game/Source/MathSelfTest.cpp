@@ -0,0 +1,115 @@
+#include "ITPEnginePCH.h"
+#include "SelfTest.h"
+
+namespace
+{
+	const int kNumSamples = 1000;
+
+	Quaternion RandomRotation()
+	{
+		Vector3 axis = Random::GetVector(Vector3(-1.0f, -1.0f, -1.0f), Vector3(1.0f, 1.0f, 1.0f));
+		if (axis.LengthSq() < 0.01f)
+		{
+			axis = Vector3::UnitZ;
+		}
+		axis.Normalize();
+		return Quaternion(axis, Random::GetFloatRange(-Math::Pi, Math::Pi));
+	}
+
+	Vector3 RandomTranslation()
+	{
+		return Random::GetVector(Vector3(-100.0f, -100.0f, -100.0f), Vector3(100.0f, 100.0f, 100.0f));
+	}
+}
+
+void SelfTest::RunMathTests()
+{
+	// LoadFromQuaternion builds the same matrix as the scalar version
+	bool quatMatches = true;
+	for (int i = 0; i < kNumSamples; i++)
+	{
+		Quaternion q = RandomRotation();
+		SimdMatrix4 simd;
+		simd.LoadFromQuaternion(q);
+		quatMatches &= IsNear(simd.ToMatrix4(), Matrix4::CreateFromQuaternion(q), 1e-5f);
+	}
+	SELF_CHECK(quatMatches);
+
+	// InvertRigid matches the full inverse for rotation + translation,
+	// and undoes the original
+	bool rigidMatches = true;
+	bool rigidIsInverse = true;
+	for (int i = 0; i < kNumSamples; i++)
+	{
+		Matrix4 mat = Matrix4::CreateFromQuaternion(RandomRotation()) * Matrix4::CreateTranslation(RandomTranslation());
+		Matrix4 expected = mat;
+		expected.Invert();
+
+		SimdMatrix4 simd(mat);
+		simd.InvertRigid();
+		rigidMatches &= IsNear(simd.ToMatrix4(), expected, 1e-3f);
+		rigidIsInverse &= IsNear(mat * simd.ToMatrix4(), Matrix4::Identity, 1e-4f);
+	}
+	SELF_CHECK(rigidMatches);
+	SELF_CHECK(rigidIsInverse);
+
+	// InvertAffine also handles (non-uniform) scale
+	bool affineMatches = true;
+	bool affineIsInverse = true;
+	for (int i = 0; i < kNumSamples; i++)
+	{
+		Vector3 scale = Random::GetVector(Vector3(0.25f, 0.25f, 0.25f), Vector3(4.0f, 4.0f, 4.0f));
+		Matrix4 mat = Matrix4::CreateScale(scale) * Matrix4::CreateFromQuaternion(RandomRotation()) *
+			Matrix4::CreateTranslation(RandomTranslation());
+		Matrix4 expected = mat;
+		expected.Invert();
+
+		SimdMatrix4 simd(mat);
+		simd.InvertAffine();
+		affineMatches &= IsNear(simd.ToMatrix4(), expected, 1e-3f);
+		affineIsInverse &= IsNear(mat * simd.ToMatrix4(), Matrix4::Identity, 1e-4f);
+	}
+	SELF_CHECK(affineMatches);
+	SELF_CHECK(affineIsInverse);
+
+	// The batch point transforms match Transform one point at a time.
+	// An odd count goes through the eight wide, four wide and leftover loops.
+	const size_t numPoints = 1001;
+	Matrix4 mat = Matrix4::CreateScale(2.0f) * Matrix4::CreateFromQuaternion(RandomRotation()) *
+		Matrix4::CreateTranslation(RandomTranslation());
+	SimdMatrix4 simdMat(mat);
+	std::vector<Vector3> points;
+	std::vector<float> packed;
+	std::vector<float> xs, ys, zs;
+	for (size_t i = 0; i < numPoints; i++)
+	{
+		Vector3 point = RandomTranslation();
+		points.push_back(point);
+		packed.push_back(point.x);
+		packed.push_back(point.y);
+		packed.push_back(point.z);
+		xs.push_back(point.x);
+		ys.push_back(point.y);
+		zs.push_back(point.z);
+	}
+
+	std::vector<float> packedOut(packed.size());
+	TransformPoints(packed.data(), packedOut.data(), numPoints, simdMat);
+	// In place too
+	TransformPointsSoA(xs.data(), ys.data(), zs.data(), xs.data(), ys.data(), zs.data(), numPoints, simdMat);
+
+	bool pointsMatch = true;
+	bool soaMatches = true;
+	for (size_t i = 0; i < numPoints; i++)
+	{
+		Vector3 expected = Transform(points[i], mat);
+		pointsMatch &= IsNear(packedOut[i * 3], expected.x, 1e-3f) &&
+			IsNear(packedOut[i * 3 + 1], expected.y, 1e-3f) &&
+			IsNear(packedOut[i * 3 + 2], expected.z, 1e-3f);
+		soaMatches &= IsNear(xs[i], expected.x, 1e-3f) &&
+			IsNear(ys[i], expected.y, 1e-3f) &&
+			IsNear(zs[i], expected.z, 1e-3f);
+	}
+	SELF_CHECK(pointsMatch);
+	SELF_CHECK(soaMatches);
+}
@@ -5,5 +5,12 @@ const size_t MAX_SKELETON_BONES = 96;
 
 struct MatrixPalette
 {
+	MatrixPalette()
+		:mNumBones(MAX_SKELETON_BONES)
+	{
+	}
+
+	// Only mMatrixPalette goes to the shader, and only the first mNumBones of it
 	SimdMatrix4 mMatrixPalette[MAX_SKELETON_BONES];
+	size_t mNumBones;
 };
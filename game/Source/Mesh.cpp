@@ -1,13 +1,94 @@
 #include "ITPEnginePCH.h"
 #include <SDL/SDL_log.h>
+#include "MeshOptimizer.h"
+#include "VertexQuantization.h"
 
 namespace
 {
+	// Bump this whenever the cooked layout (or the parsing) changes
+	const uint32_t kCookedMeshVersion = 6;
+
 	union VertPacked
 	{
 		float f;
 		uint8_t b[4];
 	};
+
+	// How much of the vertex/index arrays each parsing job handles
+	const size_t kVertsPerChunk = 2048;
+	const size_t kTrisPerChunk = 4096;
+
+	// Each LOD aims for half the triangles of the one before it
+	const uint32_t kDefaultMaxLods = 4;
+	// Don't bother simplifying meshes that are already this small
+	const size_t kMinLodTriangles = 64;
+	// A LOD that doesn't get rid of at least this much isn't worth keeping
+	const float kMinLodReduction = 0.8f;
+
+	struct ParseChunk
+	{
+		Collision::AxisAlignedBox mBounds;
+		bool mIsValid;
+	};
+
+	// Packs one json vertex into out, which has room for vertSize bytes
+	// Returns false if the vertex doesn't match vertSize
+	bool PackVertex(const rapidjson::Value& vert, bool isSkinned, uint8_t* out, size_t vertSize)
+	{
+		VertPacked packed[32];
+		size_t count = 0;
+		rapidjson::SizeType numValues = vert.Size();
+		if (numValues > 32)
+		{
+			return false;
+		}
+
+		if (!isSkinned)
+		{
+			for (rapidjson::SizeType j = 0; j < numValues; j++)
+			{
+				packed[count++].f = static_cast<float>(vert[j].GetDouble());
+			}
+		}
+		else
+		{
+			// Special case code for skinned, for now...
+			if (numValues < 14)
+			{
+				return false;
+			}
+
+			// Position/Normal
+			for (rapidjson::SizeType j = 0; j < 6; j++)
+			{
+				packed[count++].f = static_cast<float>(vert[j].GetDouble());
+			}
+
+			// Uints for bones and weights
+			for (rapidjson::SizeType j = 6; j < 14; j += 4)
+			{
+				VertPacked& temp = packed[count++];
+				temp.b[0] = static_cast<uint8_t>(vert[j].GetUint());
+				temp.b[1] = static_cast<uint8_t>(vert[j + 1].GetUint());
+				temp.b[2] = static_cast<uint8_t>(vert[j + 2].GetUint());
+				temp.b[3] = static_cast<uint8_t>(vert[j + 3].GetUint());
+			}
+
+			// Last two texture coordinates
+			for (rapidjson::SizeType j = 14; j < numValues; j++)
+			{
+				packed[count++].f = static_cast<float>(vert[j].GetDouble());
+			}
+		}
+
+		if (count * sizeof(VertPacked) != vertSize)
+		{
+			return false;
+		}
+
+		memcpy(out, packed, vertSize);
+		return true;
+	}
 }
 
 Mesh::Mesh(class Game& game)
@@ -20,7 +101,7 @@ Mesh::Mesh(class Game& game)
 
 	// Initialize the bounding box to maximal opposite values
 	mBoundingBox.mMin = Vector3(FLT_MAX, FLT_MAX, FLT_MAX);
-	mBoundingBox.mMax = Vector3(FLT_MIN, FLT_MIN, FLT_MIN);
+	mBoundingBox.mMax = Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
 }
 
 Mesh::~Mesh()
@@ -30,7 +111,7 @@ Mesh::~Mesh()
 
 bool Mesh::Load(const char* fileName, AssetCache* cache)
 {
-	std::ifstream file(fileName);
+	std::ifstream file(fileName, std::ios::binary);
 	if (!file.is_open())
 	{
 		SDL_Log("File not found: Mesh %s", fileName);
@@ -40,9 +121,43 @@ bool Mesh::Load(const char* fileName, AssetCache* cache)
 	std::stringstream fileStream;
 	fileStream << file.rdbuf();
 	std::string contents = fileStream.str();
-	rapidjson::StringStream jsonStr(contents.c_str());
+
+	// Try the cooked version first
+	AssetDiskCache& diskCache = cache->GetDiskCache();
+	uint64_t sourceHash = AssetDiskCache::HashContents(contents.data(), contents.size());
+	MeshData data;
+	std::vector<char> cooked;
+	if (diskCache.Load("itpmesh", kCookedMeshVersion, sourceHash, cooked))
+	{
+		CookedReader reader(cooked);
+		if (Uncook(reader, data))
+		{
+			return InitFromData(data, fileName, cache);
+		}
+
+		SDL_Log("Mesh %s: cooked data is corrupt, reparsing", fileName);
+		data = MeshData();
+	}
+
+	if (!ParseJson(fileName, contents, mGame.GetJobSystem(), data))
+	{
+		return false;
+	}
+
+	Optimize(fileName, data);
+
+	CookedWriter writer;
+	Cook(data, writer);
+	diskCache.Store("itpmesh", kCookedMeshVersion, sourceHash, writer.GetData());
+
+	return InitFromData(data, fileName, cache);
+}
+
+bool Mesh::ParseJson(const char* fileName, std::string& contents, JobSystem& jobs, MeshData& outData)
+{
+	// Parse in place, so strings point into contents instead of being copied
 	rapidjson::Document doc;
-	doc.ParseStream(jsonStr);
+	doc.ParseInsitu(&contents[0]);
 
 	if (!doc.IsObject())
 	{
@@ -72,14 +187,7 @@ bool Mesh::Load(const char* fileName, AssetCache* cache)
 	
 	for (rapidjson::SizeType i = 0; i < textures.Size(); i++)
 	{
-		std::string textureName = textures[i].GetString();
-		mTextures.emplace_back(cache->Load<Texture>(textureName.c_str()));
-		if (mTextures[i] == nullptr)
-		{
-			// Failed to load this texture, so use the default
-			SDL_Log("Mesh %s: Failed to load texture %s. Using default.", fileName, textureName.c_str());
-			mTextures[i] = cache->Load<Texture>("Textures/Default.png");
-		}
+		outData.mTextures.emplace_back(textures[i].GetString());
 	}
 
 	// Read the vertex format
@@ -127,17 +235,18 @@ bool Mesh::Load(const char* fileName, AssetCache* cache)
 
 	// Get the shader type
 	std::string shaderType = doc["shader"]["name"].GetString();
+	outData.mShaderType = EMS_Basic;
 	if (shaderType == "BasicMesh")
 	{
-		mShaderType = EMS_Basic;
+		outData.mShaderType = EMS_Basic;
 	}
 	else if (shaderType == "Phong")
 	{
-		mShaderType = EMS_Phong;
+		outData.mShaderType = EMS_Phong;
 	}
 	else if (shaderType == "Skinned")
 	{
-		mShaderType = EMS_Skinned;
+		outData.mShaderType = EMS_Skinned;
 	}
 	else
 	{
@@ -152,95 +261,350 @@ bool Mesh::Load(const char* fileName, AssetCache* cache)
 		return false;
 	}
 
+	// Load in the indices
+	const rapidjson::Value& indJson = doc["indices"];
+	if (!indJson.IsArray() || indJson.Size() < 1)
+	{
+		SDL_Log("Mesh %s has no indices", fileName);
+		return false;
+	}
+
 	size_t numVerts = vertsJson.Size();
-	std::vector<VertPacked> vertices;
-	vertices.reserve(numVerts * vertSize);
-	for (rapidjson::SizeType i = 0; i < vertsJson.Size(); i++)
+	size_t numTris = indJson.Size();
+	bool isSkinned = outData.mShaderType == EMS_Skinned;
+	outData.mVertices.resize(numVerts * vertSize);
+	outData.mIndices.resize(numTris * 3);
+
+	// Convert the vertices in chunks across the job system. Every chunk
+	// writes to its own part of the vertex buffer and keeps its own bounds,
+	// which are combined once everything's done.
+	size_t numChunks = (numVerts + kVertsPerChunk - 1) / kVertsPerChunk;
+	std::vector<ParseChunk> chunks(numChunks);
+	jobs.ParallelFor(numChunks, 1, [&](size_t firstChunk, size_t lastChunk)
+	{
+		for (size_t c = firstChunk; c < lastChunk; c++)
+		{
+			ParseChunk& chunk = chunks[c];
+			chunk.mBounds.mMin = Vector3(FLT_MAX, FLT_MAX, FLT_MAX);
+			chunk.mBounds.mMax = Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+			chunk.mIsValid = true;
+
+			size_t begin = c * kVertsPerChunk;
+			size_t end = min(begin + kVertsPerChunk, numVerts);
+			for (size_t i = begin; i < end; i++)
+			{
+				const rapidjson::Value& vert = vertsJson[static_cast<rapidjson::SizeType>(i)];
+				uint8_t* out = outData.mVertices.data() + i * vertSize;
+				if (!vert.IsArray() || vert.Size() != vertNumValues ||
+					!PackVertex(vert, isSkinned, out, vertSize))
+				{
+					chunk.mIsValid = false;
+					break;
+				}
+
+				// Update the bounding box
+				chunk.mBounds.UpdateMinMax(Vector3(vert[0].GetDouble(),
+					vert[1].GetDouble(), vert[2].GetDouble()));
+			}
+		}
+	});
+
+	// Initialize the bounding box to maximal opposite values
+	outData.mBoundingBox.mMin = Vector3(FLT_MAX, FLT_MAX, FLT_MAX);
+	outData.mBoundingBox.mMax = Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (const auto& chunk : chunks)
 	{
-		const rapidjson::Value& vert = vertsJson[i];
-		if (!vert.IsArray() || vert.Size() != vertNumValues)
+		if (!chunk.mIsValid)
 		{
 			SDL_Log("Unexpected vertex format for %s", fileName);
 			return false;
 		}
+		outData.mBoundingBox.UpdateMinMax(chunk.mBounds.mMin);
+		outData.mBoundingBox.UpdateMinMax(chunk.mBounds.mMax);
+	}
 
-		Vector3 pos(vert[0].GetDouble(), vert[1].GetDouble(), vert[2].GetDouble());
-		// Update the bounding box
-		mBoundingBox.UpdateMinMax(pos);
-		
-		// Now stuff all the vertices into the vertex buffer
-		if (mShaderType != EMS_Skinned)
+	// Same thing for the indices
+	numChunks = (numTris + kTrisPerChunk - 1) / kTrisPerChunk;
+	std::vector<char> validChunks(numChunks, 1);
+	jobs.ParallelFor(numChunks, 1, [&](size_t firstChunk, size_t lastChunk)
+	{
+		for (size_t c = firstChunk; c < lastChunk; c++)
 		{
-			for (rapidjson::SizeType j = 0; j < vert.Size(); j++)
+			size_t begin = c * kTrisPerChunk;
+			size_t end = min(begin + kTrisPerChunk, numTris);
+			uint32_t* out = outData.mIndices.data() + begin * 3;
+			for (size_t i = begin; i < end; i++)
 			{
-				VertPacked temp;
-				temp.f = vert[j].GetDouble();
-				vertices.emplace_back(temp);
+				const rapidjson::Value& ind = indJson[static_cast<rapidjson::SizeType>(i)];
+				if (!ind.IsArray() || ind.Size() != 3)
+				{
+					validChunks[c] = 0;
+					break;
+				}
+
+				for (rapidjson::SizeType k = 0; k < 3; k++)
+				{
+					if (!ind[k].IsUint() || ind[k].GetUint() >= numVerts)
+					{
+						validChunks[c] = 0;
+						break;
+					}
+					*out++ = ind[k].GetUint();
+				}
 			}
 		}
-		else
+	});
+
+	for (char valid : validChunks)
+	{
+		if (!valid)
 		{
-			// Special case code for skinned, for now...
-			VertPacked temp;
-			// Position/Normal
-			for (rapidjson::SizeType j = 0; j < 6; j++)
-			{
-				temp.f = vert[j].GetDouble();
-				vertices.emplace_back(temp);
-			}
-			
-			// Uints for bones and weights
-			for (rapidjson::SizeType j = 6; j < 14; j += 4)
-			{
-				temp.b[0] = vert[j].GetUint();
-				temp.b[1] = vert[j + 1].GetUint();
-				temp.b[2] = vert[j + 2].GetUint();
-				temp.b[3] = vert[j + 3].GetUint();
-				vertices.emplace_back(temp);
-			}
+			SDL_Log("Invalid indices for %s", fileName);
+			return false;
+		}
+	}
 
-			// Last two texture coordinates
-			for (rapidjson::SizeType j = 14; j < vert.Size(); j++)
-			{
-				temp.f = vert[j].GetDouble();
-				vertices.emplace_back(temp);
-			}
+	// Quantizing is opt in, since not every mesh can live with the precision
+	outData.mQuantize = false;
+	if (doc.HasMember("quantize") && doc["quantize"].IsBool())
+	{
+		outData.mQuantize = doc["quantize"].GetBool();
+	}
+
+	outData.mMaxLods = kDefaultMaxLods;
+	if (doc.HasMember("lods") && doc["lods"].IsUint())
+	{
+		outData.mMaxLods = max(doc["lods"].GetUint(), 1u);
+	}
+
+	MeshLod lod;
+	lod.mStartIndex = 0;
+	lod.mIndexCount = static_cast<uint32_t>(outData.mIndices.size());
+	lod.mError = 0.0f;
+	outData.mLods.push_back(lod);
+
+	outData.mInputLayoutName = inputLayoutName;
+	outData.mVertexSize = vertSize;
+	outData.mVertexCount = numVerts;
+	return true;
+}
+
+void Mesh::Cook(const MeshData& data, CookedWriter& writer)
+{
+	writer.Write(static_cast<uint32_t>(data.mTextures.size()));
+	for (const auto& texture : data.mTextures)
+	{
+		writer.WriteString(texture);
+	}
+	writer.WriteString(data.mInputLayoutName);
+	writer.Write(static_cast<uint32_t>(data.mShaderType));
+	writer.Write(static_cast<uint32_t>(data.mVertexSize));
+	writer.Write(static_cast<uint32_t>(data.mVertexCount));
+	writer.WriteArray(data.mVertices);
+	writer.WriteArray(data.mIndices);
+	writer.WriteArray(data.mLods);
+	writer.Write(data.mBoundingBox);
+	writer.Write(static_cast<uint8_t>(data.mQuantize));
+}
+
+bool Mesh::Uncook(CookedReader& reader, MeshData& outData)
+{
+	uint32_t numTextures = 0;
+	if (!reader.Read(numTextures))
+	{
+		return false;
+	}
+
+	outData.mTextures.resize(numTextures);
+	for (auto& texture : outData.mTextures)
+	{
+		if (!reader.ReadString(texture))
+		{
+			return false;
+		}
+	}
+
+	uint32_t shaderType = 0;
+	uint32_t vertSize = 0;
+	uint32_t vertCount = 0;
+	uint8_t quantize = 0;
+	if (!reader.ReadString(outData.mInputLayoutName) ||
+		!reader.Read(shaderType) ||
+		!reader.Read(vertSize) ||
+		!reader.Read(vertCount) ||
+		!reader.ReadArray(outData.mVertices) ||
+		!reader.ReadArray(outData.mIndices) ||
+		!reader.ReadArray(outData.mLods) ||
+		!reader.Read(outData.mBoundingBox) ||
+		!reader.Read(quantize) ||
+		!reader.IsAtEnd())
+	{
+		return false;
+	}
+
+	// Only the shaders a mesh file can ask for get cooked. The quantized
+	// and instanced ones are picked later, by adding to these.
+	if (shaderType > EMS_Skinned)
+	{
+		return false;
+	}
+
+	outData.mShaderType = static_cast<EMeshShader>(shaderType);
+	outData.mVertexSize = vertSize;
+	outData.mVertexCount = vertCount;
+	outData.mQuantize = quantize != 0;
+	for (auto index : outData.mIndices)
+	{
+		if (index >= vertCount)
+		{
+			return false;
+		}
+	}
+	if (outData.mLods.empty())
+	{
+		return false;
+	}
+	for (const auto& lod : outData.mLods)
+	{
+		if (lod.mStartIndex > outData.mIndices.size() ||
+			lod.mIndexCount > outData.mIndices.size() - lod.mStartIndex)
+		{
+			return false;
+		}
+	}
+	return outData.mVertices.size() == outData.mVertexSize * outData.mVertexCount;
+}
+
+void Mesh::Optimize(const char* fileName, MeshData& data)
+{
+	float acmrBefore = MeshOptimizer::ComputeACMR(data.mIndices, data.mVertexCount);
+	size_t vertsBefore = data.mVertexCount;
+
+	data.mVertexCount = MeshOptimizer::DeduplicateVertices(data.mVertices,
+		data.mVertexSize, data.mIndices);
+
+	// Some exporters already do a good job, so keep their order if
+	// it's better than what we come up with
+	std::vector<uint32_t> exportedOrder(data.mIndices);
+	MeshOptimizer::OptimizeVertexCache(data.mIndices, data.mVertexCount);
+	if (MeshOptimizer::ComputeACMR(data.mIndices, data.mVertexCount) >
+		MeshOptimizer::ComputeACMR(exportedOrder, data.mVertexCount))
+	{
+		data.mIndices.swap(exportedOrder);
+	}
+	float acmrAfter = MeshOptimizer::ComputeACMR(data.mIndices, data.mVertexCount);
+
+	GenerateLods(fileName, data);
+
+	// LOD 0 comes first, so this lays the vertices out for it
+	data.mVertexCount = MeshOptimizer::OptimizeVertexFetch(data.mVertices,
+		data.mVertexSize, data.mIndices);
+
+	SDL_Log("Mesh %s: %u -> %u verts, ACMR %.3f -> %.3f", fileName,
+		static_cast<unsigned>(vertsBefore), static_cast<unsigned>(data.mVertexCount),
+		acmrBefore, acmrAfter);
+}
+
+void Mesh::GenerateLods(const char* fileName, MeshData& data)
+{
+	// Every LOD is simplified from LOD 0, so errors don't stack up
+	std::vector<uint32_t> baseIndices(data.mIndices);
+	size_t prevCount = baseIndices.size();
+	std::vector<uint32_t> lodIndices;
+	for (uint32_t i = 1; i < data.mMaxLods; i++)
+	{
+		size_t targetTris = (baseIndices.size() / 3) >> i;
+		if (targetTris < kMinLodTriangles)
+		{
+			break;
+		}
+
+		float error;
+		if (!MeshOptimizer::Simplify(data.mVertices, data.mVertexSize,
+			baseIndices, targetTris * 3, lodIndices, error) ||
+			lodIndices.size() > prevCount * kMinLodReduction)
+		{
+			break;
 		}
+
+		MeshOptimizer::OptimizeVertexCache(lodIndices, data.mVertexCount);
+
+		MeshLod lod;
+		lod.mStartIndex = static_cast<uint32_t>(data.mIndices.size());
+		lod.mIndexCount = static_cast<uint32_t>(lodIndices.size());
+		lod.mError = error;
+		data.mLods.push_back(lod);
+		data.mIndices.insert(data.mIndices.end(), lodIndices.begin(), lodIndices.end());
+		prevCount = lodIndices.size();
+
+		SDL_Log("Mesh %s: LOD %u has %u tris, error %.3f", fileName, i,
+			static_cast<unsigned>(lod.mIndexCount / 3), error);
 	}
+}
+
+bool Mesh::InitFromData(const MeshData& data, const char* fileName, AssetCache* cache)
+{
+	for (size_t i = 0; i < data.mTextures.size(); i++)
+	{
+		const std::string& textureName = data.mTextures[i];
+		mTextures.emplace_back(cache->Load<Texture>(textureName));
+		if (mTextures[i] == nullptr)
+		{
+			// Failed to load this texture, so use the default
+			SDL_Log("Mesh %s: Failed to load texture %s. Using default.", fileName, textureName.c_str());
+			mTextures[i] = cache->Load<Texture>(ASSET_PATH("Textures/Default.png"));
+		}
+	}
+
+	mShaderType = data.mShaderType;
+	mBoundingBox = data.mBoundingBox;
+	mLods = data.mLods;
 
 	// Now that we have a bounding box, make a bounding sphere
 	// around it
 	mBoundingSphere.ComputeFromBox(mBoundingBox);
 
-	// Load in the indices
-	const rapidjson::Value& indJson = doc["indices"];
-	if (!indJson.IsArray() || indJson.Size() < 1)
+	// Only use 32-bit indices if we have to
+	const void* indices = data.mIndices.data();
+	size_t indexSize = sizeof(uint32_t);
+	std::vector<uint16_t> shortIndices;
+	if (data.mVertexCount <= 0xffff)
 	{
-		SDL_Log("Mesh %s has no indices", fileName);
-		return false;
+		shortIndices.assign(data.mIndices.begin(), data.mIndices.end());
+		indices = shortIndices.data();
+		indexSize = sizeof(uint16_t);
 	}
 
-	std::vector<uint16_t> indices;
-	indices.reserve(indJson.Size() * 3);
-	for (rapidjson::SizeType i = 0; i < indJson.Size(); i++)
+	const uint8_t* vertices = data.mVertices.data();
+	size_t vertexSize = data.mVertexSize;
+	std::string inputLayoutName = data.mInputLayoutName;
+	std::vector<uint8_t> quantized;
+	Vector3 positionScale(1.0f, 1.0f, 1.0f);
+	Vector3 positionOffset = Vector3::Zero;
+	if (data.mQuantize)
 	{
-		const rapidjson::Value& ind = indJson[i];
-		if (!ind.IsArray() || ind.Size() != 3)
+		bool isSkinned = data.mShaderType == EMS_Skinned;
+		if (VertexQuantization::QuantizeVertices(vertices, data.mVertexCount, vertexSize,
+			isSkinned, mBoundingBox.mMin, mBoundingBox.mMax,
+			quantized, positionScale, positionOffset))
 		{
-			SDL_Log("Invalid indices for %s", fileName);
-			return false;
+			vertices = quantized.data();
+			vertexSize = VertexQuantization::GetQuantizedSize(vertexSize, isSkinned);
+			inputLayoutName = "q" + inputLayoutName;
+			mShaderType = static_cast<EMeshShader>(mShaderType + EMS_BasicQuantized);
+		}
+		else
+		{
+			SDL_Log("Mesh %s: Can't quantize this vertex format, using floats.", fileName);
 		}
-		
-		indices.emplace_back(static_cast<uint16_t>(ind[0].GetUint()));
-		indices.emplace_back(static_cast<uint16_t>(ind[1].GetUint()));
-		indices.emplace_back(static_cast<uint16_t>(ind[2].GetUint()));
 	}
 
 	// Now create a vertex array
 	mVertexArray = VertexArray::Create(mGame.GetRenderer().GetGraphicsDriver(), 
 		mGame.GetRenderer().GetInputLayoutCache(),
-		vertices.data(), numVerts, vertSize, inputLayoutName,
-		indices.data(), indices.size());
+		vertices, data.mVertexCount, vertexSize, inputLayoutName,
+		indices, data.mIndices.size(), indexSize);
+	mVertexArray->SetPositionDequantization(positionScale, positionOffset);
 	return true;
 }
 
@@ -255,3 +619,52 @@ TexturePtr Mesh::GetTexture(size_t index)
 		return nullptr;
 	}
 }
+
+size_t Mesh::SelectLod(const std::vector<MeshLod>& lods, float sphereRadius,
+	float screenSize, int screenHeight, float maxPixelError)
+{
+	if (sphereRadius <= 0.0f)
+	{
+		return 0;
+	}
+
+	// The error is in model units, so compare it to the bounding sphere
+	// to get the fraction of the screen it covers
+	float pixelsPerUnit = screenSize * 0.5f * screenHeight / sphereRadius;
+	for (size_t i = lods.size(); i-- > 1;)
+	{
+		if (lods[i].mError * pixelsPerUnit <= maxPixelError)
+		{
+			return i;
+		}
+	}
+	return 0;
+}
+
+float Mesh::ComputeScreenSize(const Collision::Sphere& worldSphere,
+	const Matrix4& view, const Matrix4& proj)
+{
+	// View space z is the distance in front of the camera
+	float depth = Transform(worldSphere.mCenter, view).z;
+	if (depth <= worldSphere.mRadius)
+	{
+		return FLT_MAX;
+	}
+
+	// proj[1][1] scales y into [-1, 1], so the diameter covers this much
+	// of the screen's height
+	return worldSphere.mRadius * proj.mat[1][1] / depth;
+}
+
+size_t Mesh::GetMemorySize() const
+{
+	// Textures are cached (and counted) on their own
+	size_t size = sizeof(Mesh) + mTextures.capacity() * sizeof(TexturePtr) +
+		mLods.capacity() * sizeof(MeshLod);
+	if (mVertexArray)
+	{
+		size += mVertexArray->GetVertexCount() * mVertexArray->GetVertexSize();
+		size += mVertexArray->GetIndexCount() * mVertexArray->GetIndexSize();
+	}
+	return size;
+}
@@ -3,9 +3,43 @@
 #include "VertexArray.h"
 #include "Texture.h"
 #include <vector>
+#include <string>
 #include "ShaderTypes.h"
 #include "CollisionHelpers.h"
 
+// A level of detail is a range of the mesh's index buffer.
+// Every LOD draws from the same vertices.
+struct MeshLod
+{
+	uint32_t mStartIndex;
+	uint32_t mIndexCount;
+	// Roughly how far (in model units) the surface moved from LOD 0
+	float mError;
+};
+
+// Everything a mesh file describes, before anything is created on
+// the GPU. This is what gets cooked into the disk cache.
+struct MeshData
+{
+	std::vector<std::string> mTextures;
+	std::string mInputLayoutName;
+	EMeshShader mShaderType;
+	size_t mVertexSize;
+	size_t mVertexCount;
+	// Packed vertex data, mVertexSize * mVertexCount bytes
+	std::vector<uint8_t> mVertices;
+	// Always 32-bit here, InitFromData picks the index size for the GPU
+	// Holds every LOD, one after another
+	std::vector<uint32_t> mIndices;
+	std::vector<MeshLod> mLods;
+	// How many LODs to generate when cooking ("lods" in the mesh file)
+	uint32_t mMaxLods;
+	Collision::AxisAlignedBox mBoundingBox;
+	// Set by "quantize": true in the mesh file, to upload the vertices
+	// in the smaller quantized format
+	bool mQuantize;
+};
+
 class Mesh : public Asset
 {
 	DECL_ASSET(Mesh, Asset);
@@ -14,6 +48,7 @@ public:
 	virtual ~Mesh();
 
 	bool Load(const char* fileName, class AssetCache* cache) override;
+	size_t GetMemorySize() const override;
 
 	VertexArrayPtr GetVertexArray() { return mVertexArray; }
 	TexturePtr GetTexture(size_t index);
@@ -22,11 +57,46 @@ public:
 	const Collision::AxisAlignedBox& GetBoundingBox() const { return mBoundingBox; }
 
 	EMeshShader GetShaderType() const { return mShaderType; }
+
+	size_t GetNumLods() const { return mLods.size(); }
+	const MeshLod& GetLod(size_t index) const { return mLods[index]; }
+
+	// Picks the coarsest LOD whose error covers at most maxPixelError pixels,
+	// given the mesh's screenSize (from ComputeScreenSize)
+	size_t SelectLod(float screenSize, int screenHeight, float maxPixelError = 1.0f) const
+	{
+		return SelectLod(mLods, mBoundingSphere.mRadius, screenSize, screenHeight, maxPixelError);
+	}
+
+	// Same as above for any list of LODs, given the radius of the
+	// bounding sphere their errors are relative to
+	static size_t SelectLod(const std::vector<MeshLod>& lods, float sphereRadius,
+		float screenSize, int screenHeight, float maxPixelError);
+
+	// Fraction of the screen's height a sphere's diameter covers
+	// Spheres touching or behind the camera return FLT_MAX
+	static float ComputeScreenSize(const Collision::Sphere& worldSphere,
+		const Matrix4& view, const Matrix4& proj);
 private:
+	// Parses the itpmesh json (destroying contents in the process)
+	// The vertex and index arrays are converted in parallel
+	static bool ParseJson(const char* fileName, std::string& contents,
+		class JobSystem& jobs, MeshData& outData);
+	static void Cook(const MeshData& data, class CookedWriter& writer);
+	static bool Uncook(class CookedReader& reader, MeshData& outData);
+	// Dedups and reorders the vertices/indices for the GPU's caches
+	static void Optimize(const char* fileName, MeshData& data);
+	// Simplifies LOD 0 into the rest of the LODs
+	static void GenerateLods(const char* fileName, MeshData& data);
+
+	// Loads the textures and creates the vertex array
+	bool InitFromData(const MeshData& data, const char* fileName, class AssetCache* cache);
+
 	Collision::Sphere mBoundingSphere;
 	Collision::AxisAlignedBox mBoundingBox;
 	VertexArrayPtr mVertexArray;
 	std::vector<TexturePtr> mTextures;
+	std::vector<MeshLod> mLods;
 	EMeshShader mShaderType;
 };
 
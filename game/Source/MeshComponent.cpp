@@ -13,11 +13,41 @@ void MeshComponent::Draw(class Renderer& render)
 {
 	if (mMesh)
 	{
+		size_t lodIndex = SelectLod(render);
+		const MeshLod& lod = mMesh->GetLod(lodIndex);
 		render.DrawMesh(mMesh->GetVertexArray(), mMesh->GetTexture(mTextureIndex),
-			mOwner.GetWorldTransform(), mMesh->GetShaderType());
+			mOwner.GetWorldTransform(), mMesh->GetShaderType(),
+			lodIndex, lod.mStartIndex, lod.mIndexCount);
 	}
 }
 
+bool MeshComponent::GetLocalBounds(Collision::AxisAlignedBox& outBounds)
+{
+	if (!mMesh)
+	{
+		return false;
+	}
+
+	// Skinned meshes use their bind pose bounds, which is close enough
+	// for the animations we have
+	outBounds = mMesh->GetBoundingBox();
+	return true;
+}
+
+size_t MeshComponent::SelectLod(Renderer& render) const
+{
+	const Matrix4& worldTransform = mOwner.GetWorldTransform();
+	Vector3 scale = worldTransform.GetScale();
+
+	Collision::Sphere worldSphere;
+	worldSphere.mCenter = Transform(mMesh->GetBoundingSphere().mCenter, worldTransform);
+	worldSphere.mRadius = mMesh->GetBoundingSphere().mRadius * max(scale.x, max(scale.y, scale.z));
+
+	float screenSize = Mesh::ComputeScreenSize(worldSphere,
+		render.GetViewMatrix(), render.GetProjectionMatrix());
+	return mMesh->SelectLod(screenSize, render.GetHeight());
+}
+
 void MeshComponent::SetProperties(const rapidjson::Value& properties)
 {
 	Super::SetProperties(properties);
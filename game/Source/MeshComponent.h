@@ -9,6 +9,7 @@ public:
 	MeshComponent(Actor& owner);
 
 	void Draw(class Renderer& render) override;
+	bool GetLocalBounds(Collision::AxisAlignedBox& outBounds) override;
 
 	void SetMesh(MeshPtr mesh) { mMesh = mesh; }
 	MeshPtr GetMesh() { return mMesh; }
@@ -16,6 +17,9 @@ public:
 
 	void SetProperties(const rapidjson::Value& properties) override;
 protected:
+	// Picks the mesh's LOD from how big it is on screen
+	size_t SelectLod(class Renderer& render) const;
+
 	MeshPtr mMesh;
 	int mTextureIndex;
 };
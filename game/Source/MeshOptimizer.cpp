@@ -0,0 +1,659 @@
+#include "ITPEnginePCH.h"
+#include "MeshOptimizer.h"
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+	// Size of the simulated cache used by the Forsyth optimizer
+	const int kCacheSize = 32;
+	// Valences past this all score the same
+	const int kMaxValence = 32;
+
+	const float kCacheDecayPower = 1.5f;
+	const float kLastTriScore = 0.75f;
+	const float kValenceBoostScale = 2.0f;
+	const float kValenceBoostPower = 0.5f;
+
+	const uint32_t kInvalid = 0xffffffff;
+
+	// A collapse can turn a triangle by at most acos of this (60 degrees)
+	const float kMinCollapseCosine = 0.5f;
+
+	struct ScoreTables
+	{
+		ScoreTables()
+		{
+			for (int i = 0; i < kCacheSize; i++)
+			{
+				if (i < 3)
+				{
+					// The last triangle's vertices get a fixed score, so
+					// there's no preference for one of its edges
+					mCache[i] = kLastTriScore;
+				}
+				else
+				{
+					float scaler = 1.0f / (kCacheSize - 3);
+					mCache[i] = powf(1.0f - (i - 3) * scaler, kCacheDecayPower);
+				}
+			}
+
+			mValence[0] = 0.0f;
+			for (int i = 1; i <= kMaxValence; i++)
+			{
+				// Boost vertices with few triangles left, to get rid of them
+				mValence[i] = kValenceBoostScale * powf(static_cast<float>(i), -kValenceBoostPower);
+			}
+		}
+
+		float mCache[kCacheSize];
+		float mValence[kMaxValence + 1];
+	};
+
+	float VertexScore(const ScoreTables& tables, int cachePos, uint32_t activeTris)
+	{
+		if (activeTris == 0)
+		{
+			// No triangles need this vertex anymore
+			return -1.0f;
+		}
+
+		float score = cachePos >= 0 ? tables.mCache[cachePos] : 0.0f;
+		return score + tables.mValence[min(activeTris, static_cast<uint32_t>(kMaxValence))];
+	}
+
+	// Sum of squared distances to a set of planes, as a symmetric 4x4 matrix
+	struct Quadric
+	{
+		double mA2, mAB, mAC, mAD;
+		double mB2, mBC, mBD;
+		double mC2, mCD;
+		double mD2;
+		// Total area of the planes, so errors can be normalized
+		double mWeight;
+	};
+
+	void AddPlane(Quadric& q, const Vector3& normal, float d, double weight)
+	{
+		double a = normal.x;
+		double b = normal.y;
+		double c = normal.z;
+		q.mA2 += weight * a * a;
+		q.mAB += weight * a * b;
+		q.mAC += weight * a * c;
+		q.mAD += weight * a * d;
+		q.mB2 += weight * b * b;
+		q.mBC += weight * b * c;
+		q.mBD += weight * b * d;
+		q.mC2 += weight * c * c;
+		q.mCD += weight * c * d;
+		q.mD2 += weight * d * d;
+		q.mWeight += weight;
+	}
+
+	void AddQuadric(Quadric& q, const Quadric& other)
+	{
+		q.mA2 += other.mA2;
+		q.mAB += other.mAB;
+		q.mAC += other.mAC;
+		q.mAD += other.mAD;
+		q.mB2 += other.mB2;
+		q.mBC += other.mBC;
+		q.mBD += other.mBD;
+		q.mC2 += other.mC2;
+		q.mCD += other.mCD;
+		q.mD2 += other.mD2;
+		q.mWeight += other.mWeight;
+	}
+
+	// Average squared distance from p to the planes in a and b
+	float CollapseError(const Quadric& a, const Quadric& b, const Vector3& p)
+	{
+		Quadric q = a;
+		AddQuadric(q, b);
+		if (q.mWeight <= 0.0)
+		{
+			return 0.0f;
+		}
+
+		double x = p.x;
+		double y = p.y;
+		double z = p.z;
+		double error = q.mA2 * x * x + 2.0 * q.mAB * x * y + 2.0 * q.mAC * x * z + 2.0 * q.mAD * x +
+			q.mB2 * y * y + 2.0 * q.mBC * y * z + 2.0 * q.mBD * y +
+			q.mC2 * z * z + 2.0 * q.mCD * z +
+			q.mD2;
+		return static_cast<float>(max(error, 0.0) / q.mWeight);
+	}
+
+	struct Collapse
+	{
+		float mError;
+		uint32_t mFrom;
+		uint32_t mTo;
+
+		bool operator<(const Collapse& other) const
+		{
+			return mError < other.mError;
+		}
+	};
+
+	// Would moving from onto to flip (or flatten) any triangle around from?
+	bool CollapseFlips(const std::vector<Vector3>& positions, const std::vector<uint32_t>& indices,
+		const uint32_t* adjBegin, const uint32_t* adjEnd, uint32_t from, uint32_t to)
+	{
+		for (const uint32_t* a = adjBegin; a != adjEnd; ++a)
+		{
+			const uint32_t* tri = &indices[*a * 3];
+			if (tri[0] == to || tri[1] == to || tri[2] == to)
+			{
+				// This one collapses away
+				continue;
+			}
+
+			Vector3 before[3];
+			Vector3 after[3];
+			for (size_t k = 0; k < 3; k++)
+			{
+				before[k] = positions[tri[k]];
+				after[k] = tri[k] == from ? positions[to] : before[k];
+			}
+
+			// Only checking for a sign change would let a triangle turn a
+			// bit further every pass until it flips, so turning too far or
+			// losing all its area counts as well
+			Vector3 oldNormal = Cross(before[1] - before[0], before[2] - before[0]);
+			Vector3 newNormal = Cross(after[1] - after[0], after[2] - after[0]);
+			if (Dot(oldNormal, newNormal) <= kMinCollapseCosine * oldNormal.Length() * newNormal.Length())
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	uint64_t HashBytes(const uint8_t* data, size_t size)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= data[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+}
+
+size_t MeshOptimizer::DeduplicateVertices(std::vector<uint8_t>& vertices, size_t vertexSize,
+	std::vector<uint32_t>& indices)
+{
+	size_t vertexCount = vertices.size() / vertexSize;
+
+	// Open addressing table of unique vertex indices, at most half full
+	size_t tableSize = 1;
+	while (tableSize < vertexCount * 2)
+	{
+		tableSize *= 2;
+	}
+	std::vector<uint32_t> table(tableSize, kInvalid);
+	std::vector<uint32_t> remap(vertexCount);
+
+	size_t uniqueCount = 0;
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const uint8_t* vert = vertices.data() + i * vertexSize;
+		size_t slot = static_cast<size_t>(HashBytes(vert, vertexSize)) & (tableSize - 1);
+		while (true)
+		{
+			uint32_t existing = table[slot];
+			if (existing == kInvalid)
+			{
+				// First time we've seen this vertex, so compact it down
+				if (uniqueCount != i)
+				{
+					memcpy(vertices.data() + uniqueCount * vertexSize, vert, vertexSize);
+				}
+				table[slot] = static_cast<uint32_t>(uniqueCount);
+				remap[i] = static_cast<uint32_t>(uniqueCount);
+				uniqueCount++;
+				break;
+			}
+			else if (memcmp(vertices.data() + existing * vertexSize, vert, vertexSize) == 0)
+			{
+				remap[i] = existing;
+				break;
+			}
+			slot = (slot + 1) & (tableSize - 1);
+		}
+	}
+
+	for (auto& index : indices)
+	{
+		index = remap[index];
+	}
+
+	vertices.resize(uniqueCount * vertexSize);
+	return uniqueCount;
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+	static const ScoreTables sTables;
+
+	size_t triCount = indices.size() / 3;
+	if (triCount == 0)
+	{
+		return;
+	}
+
+	// Build the vertex -> triangle adjacency in one flat array
+	std::vector<uint32_t> activeTris(vertexCount, 0);
+	for (auto index : indices)
+	{
+		activeTris[index]++;
+	}
+
+	std::vector<uint32_t> adjOffsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		adjOffsets[v + 1] = adjOffsets[v] + activeTris[v];
+	}
+
+	std::vector<uint32_t> adjacency(indices.size());
+	std::vector<uint32_t> fill(adjOffsets.begin(), adjOffsets.end() - 1);
+	for (size_t t = 0; t < triCount; t++)
+	{
+		for (size_t k = 0; k < 3; k++)
+		{
+			uint32_t v = indices[t * 3 + k];
+			adjacency[fill[v]++] = static_cast<uint32_t>(t);
+		}
+	}
+
+	std::vector<float> vertScores(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		vertScores[v] = VertexScore(sTables, -1, activeTris[v]);
+	}
+
+	std::vector<float> triScores(triCount);
+	std::vector<bool> emitted(triCount, false);
+	for (size_t t = 0; t < triCount; t++)
+	{
+		triScores[t] = vertScores[indices[t * 3]] +
+			vertScores[indices[t * 3 + 1]] +
+			vertScores[indices[t * 3 + 2]];
+	}
+
+	// The simulated cache has room for the new triangle's vertices
+	// before the old ones get pushed out
+	uint32_t cache[kCacheSize + 3];
+	uint32_t newCache[kCacheSize + 3];
+	int cacheCount = 0;
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	size_t scanPos = 0;
+	uint32_t bestTri = kInvalid;
+	for (size_t emittedCount = 0; emittedCount < triCount; emittedCount++)
+	{
+		if (bestTri == kInvalid)
+		{
+			// Nothing in the cache is useful, so take the next triangle
+			// that hasn't been emitted yet
+			while (emitted[scanPos])
+			{
+				scanPos++;
+			}
+			bestTri = static_cast<uint32_t>(scanPos);
+		}
+
+		emitted[bestTri] = true;
+		const uint32_t* tri = &indices[bestTri * 3];
+		int newCount = 0;
+		for (size_t k = 0; k < 3; k++)
+		{
+			uint32_t v = tri[k];
+			result.push_back(v);
+			if (k == 0 || (v != tri[0] && (k == 1 || v != tri[1])))
+			{
+				newCache[newCount++] = v;
+			}
+
+			// This triangle no longer needs v
+			uint32_t* adjBegin = &adjacency[adjOffsets[v]];
+			uint32_t* adjEnd = adjBegin + activeTris[v];
+			for (uint32_t* a = adjBegin; a != adjEnd; ++a)
+			{
+				if (*a == bestTri)
+				{
+					*a = *(adjEnd - 1);
+					break;
+				}
+			}
+			activeTris[v]--;
+		}
+
+		// Everything that was already in the cache moves back
+		for (int i = 0; i < cacheCount; i++)
+		{
+			uint32_t v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+			{
+				newCache[newCount++] = v;
+			}
+		}
+
+		// Rescore the vertices that are (or just were) in the cache,
+		// and their triangles
+		bestTri = kInvalid;
+		float bestScore = -1.0f;
+		for (int i = 0; i < newCount; i++)
+		{
+			uint32_t v = newCache[i];
+			int pos = i < kCacheSize ? i : -1;
+
+			float newScore = VertexScore(sTables, pos, activeTris[v]);
+			float delta = newScore - vertScores[v];
+			vertScores[v] = newScore;
+
+			const uint32_t* adj = &adjacency[adjOffsets[v]];
+			for (uint32_t a = 0; a < activeTris[v]; a++)
+			{
+				uint32_t t = adj[a];
+				triScores[t] += delta;
+				if (triScores[t] > bestScore)
+				{
+					bestScore = triScores[t];
+					bestTri = t;
+				}
+			}
+		}
+
+		cacheCount = min(newCount, kCacheSize);
+		memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+	}
+
+	indices.swap(result);
+}
+
+size_t MeshOptimizer::OptimizeVertexFetch(std::vector<uint8_t>& vertices, size_t vertexSize,
+	std::vector<uint32_t>& indices)
+{
+	size_t vertexCount = vertices.size() / vertexSize;
+	std::vector<uint32_t> remap(vertexCount, kInvalid);
+	std::vector<uint8_t> result(vertices.size());
+
+	uint32_t nextVertex = 0;
+	for (auto& index : indices)
+	{
+		if (remap[index] == kInvalid)
+		{
+			memcpy(result.data() + nextVertex * vertexSize,
+				vertices.data() + index * vertexSize, vertexSize);
+			remap[index] = nextVertex++;
+		}
+		index = remap[index];
+	}
+
+	result.resize(nextVertex * vertexSize);
+	vertices.swap(result);
+	return nextVertex;
+}
+
+float MeshOptimizer::ComputeACMR(const std::vector<uint32_t>& indices, size_t vertexCount,
+	size_t cacheSize)
+{
+	size_t triCount = indices.size() / 3;
+	if (triCount == 0)
+	{
+		return 0.0f;
+	}
+
+	// A vertex is in the FIFO if it was added within the last
+	// cacheSize misses
+	std::vector<size_t> cacheTime(vertexCount, 0);
+	size_t time = cacheSize + 1;
+	size_t misses = 0;
+	for (auto index : indices)
+	{
+		if (time - cacheTime[index] > cacheSize)
+		{
+			cacheTime[index] = time++;
+			misses++;
+		}
+	}
+
+	return static_cast<float>(misses) / static_cast<float>(triCount);
+}
+
+bool MeshOptimizer::Simplify(const std::vector<uint8_t>& vertices, size_t vertexSize,
+	const std::vector<uint32_t>& indices, size_t targetIndexCount,
+	std::vector<uint32_t>& outIndices, float& outError)
+{
+	outIndices.clear();
+	outError = 0.0f;
+	if (vertexSize < sizeof(Vector3) || indices.size() % 3 != 0)
+	{
+		SDL_Log("Simplify: Needs a triangle list with float3 positions.");
+		return false;
+	}
+
+	size_t vertexCount = vertices.size() / vertexSize;
+	for (auto index : indices)
+	{
+		if (index >= vertexCount)
+		{
+			SDL_Log("Simplify: Index %u is past the last vertex.", index);
+			return false;
+		}
+	}
+
+	outIndices = indices;
+	std::vector<Vector3> positions(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		memcpy(&positions[v], vertices.data() + v * vertexSize, sizeof(Vector3));
+	}
+
+	// Each vertex starts with the planes of the triangles around it
+	std::vector<Quadric> quadrics(vertexCount, Quadric());
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		const Vector3& p0 = positions[indices[i]];
+		Vector3 normal = Cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0);
+		float length = normal.Length();
+		if (length <= 0.0f)
+		{
+			continue;
+		}
+
+		normal *= 1.0f / length;
+		float d = -Dot(normal, p0);
+		double area = 0.5 * length;
+		for (size_t k = 0; k < 3; k++)
+		{
+			AddPlane(quadrics[indices[i + k]], normal, d, area);
+		}
+	}
+
+	// An edge that only goes one way is on a border, or on a seam where
+	// the vertices split. Moving those vertices would tear the mesh.
+	std::vector<uint64_t> edges;
+	edges.reserve(indices.size());
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		for (size_t k = 0; k < 3; k++)
+		{
+			uint64_t a = indices[i + k];
+			uint64_t b = indices[i + (k + 1) % 3];
+			edges.push_back((a << 32) | b);
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+
+	std::vector<bool> locked(vertexCount, false);
+	for (auto edge : edges)
+	{
+		uint64_t reverse = (edge << 32) | (edge >> 32);
+		if (!std::binary_search(edges.begin(), edges.end(), reverse))
+		{
+			locked[edge >> 32] = true;
+			locked[edge & 0xffffffff] = true;
+		}
+	}
+
+	float maxError = 0.0f;
+	std::vector<uint32_t> activeTris(vertexCount);
+	std::vector<uint32_t> adjOffsets(vertexCount + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<uint32_t> remap(vertexCount);
+	std::vector<bool> touched(vertexCount);
+	std::vector<Collapse> bestCollapse(vertexCount);
+	std::vector<Collapse> collapses;
+
+	// Each pass does as many independent collapses as it can, then
+	// rebuilds everything from the new indices
+	while (outIndices.size() > targetIndexCount)
+	{
+		size_t triCount = outIndices.size() / 3;
+
+		// Vertex -> triangle adjacency, same as OptimizeVertexCache
+		std::fill(activeTris.begin(), activeTris.end(), 0);
+		for (auto index : outIndices)
+		{
+			activeTris[index]++;
+		}
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			adjOffsets[v + 1] = adjOffsets[v] + activeTris[v];
+		}
+		adjacency.resize(outIndices.size());
+		std::vector<uint32_t> fill(adjOffsets.begin(), adjOffsets.end() - 1);
+		for (size_t t = 0; t < triCount; t++)
+		{
+			for (size_t k = 0; k < 3; k++)
+			{
+				uint32_t v = outIndices[t * 3 + k];
+				adjacency[fill[v]++] = static_cast<uint32_t>(t);
+			}
+		}
+
+		// Cheapest collapse for every vertex that's allowed to move
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			bestCollapse[v].mError = FLT_MAX;
+		}
+		for (size_t t = 0; t < triCount; t++)
+		{
+			for (size_t k = 0; k < 3; k++)
+			{
+				uint32_t a = outIndices[t * 3 + k];
+				uint32_t b = outIndices[t * 3 + (k + 1) % 3];
+				for (size_t dir = 0; dir < 2; dir++)
+				{
+					uint32_t from = dir == 0 ? a : b;
+					uint32_t to = dir == 0 ? b : a;
+					if (locked[from] || from == to)
+					{
+						continue;
+					}
+
+					float error = CollapseError(quadrics[from], quadrics[to], positions[to]);
+					if (error < bestCollapse[from].mError)
+					{
+						bestCollapse[from].mError = error;
+						bestCollapse[from].mFrom = from;
+						bestCollapse[from].mTo = to;
+					}
+				}
+			}
+		}
+
+		collapses.clear();
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			if (bestCollapse[v].mError != FLT_MAX)
+			{
+				collapses.push_back(bestCollapse[v]);
+			}
+		}
+		std::sort(collapses.begin(), collapses.end());
+
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			remap[v] = static_cast<uint32_t>(v);
+		}
+		std::fill(touched.begin(), touched.end(), false);
+
+		size_t trisLeft = triCount;
+		size_t numCollapsed = 0;
+		for (const auto& collapse : collapses)
+		{
+			if (trisLeft * 3 <= targetIndexCount)
+			{
+				break;
+			}
+
+			uint32_t from = collapse.mFrom;
+			uint32_t to = collapse.mTo;
+			if (touched[from] || touched[to])
+			{
+				continue;
+			}
+
+			const uint32_t* adjBegin = &adjacency[adjOffsets[from]];
+			const uint32_t* adjEnd = adjBegin + activeTris[from];
+			if (CollapseFlips(positions, outIndices, adjBegin, adjEnd, from, to))
+			{
+				continue;
+			}
+
+			// Nothing else around from can change this pass, so the flip
+			// test above stays valid
+			for (const uint32_t* a = adjBegin; a != adjEnd; ++a)
+			{
+				const uint32_t* tri = &outIndices[*a * 3];
+				if (tri[0] == to || tri[1] == to || tri[2] == to)
+				{
+					trisLeft--;
+				}
+				touched[tri[0]] = true;
+				touched[tri[1]] = true;
+				touched[tri[2]] = true;
+			}
+
+			remap[from] = to;
+			AddQuadric(quadrics[to], quadrics[from]);
+			maxError = max(maxError, collapse.mError);
+			numCollapsed++;
+		}
+
+		if (numCollapsed == 0)
+		{
+			// Everything left is locked or would flip
+			break;
+		}
+
+		// Apply the collapses and throw out the triangles that collapsed
+		size_t writePos = 0;
+		for (size_t i = 0; i < outIndices.size(); i += 3)
+		{
+			uint32_t a = remap[outIndices[i]];
+			uint32_t b = remap[outIndices[i + 1]];
+			uint32_t c = remap[outIndices[i + 2]];
+			if (a != b && b != c && a != c)
+			{
+				outIndices[writePos++] = a;
+				outIndices[writePos++] = b;
+				outIndices[writePos++] = c;
+			}
+		}
+		outIndices.resize(writePos);
+	}
+
+	outError = sqrtf(maxError);
+	return true;
+}
@@ -0,0 +1,46 @@
+// MeshOptimizer.h
+// Functions to clean up and reorder indexed triangle lists so they
+// render faster. The usual order to run them in is:
+// 1. DeduplicateVertices
+// 2. OptimizeVertexCache (reorders triangles)
+// 3. OptimizeVertexFetch (reorders vertices to match)
+// Vertices are treated as opaque blobs of vertexSize bytes, except by
+// Simplify, which expects them to start with a float3 position.
+
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace MeshOptimizer
+{
+	// Merges vertices that are byte for byte identical and remaps the
+	// indices. Returns the new vertex count.
+	size_t DeduplicateVertices(std::vector<uint8_t>& vertices, size_t vertexSize,
+		std::vector<uint32_t>& indices);
+
+	// Reorders the triangles to make better use of the post-transform
+	// vertex cache (Tom Forsyth's linear-speed vertex cache optimization)
+	void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+	// Reorders the vertices into the order the indices first use them,
+	// so vertex fetches walk through memory. Unused vertices are dropped.
+	// Returns the new vertex count.
+	size_t OptimizeVertexFetch(std::vector<uint8_t>& vertices, size_t vertexSize,
+		std::vector<uint32_t>& indices);
+
+	// Average cache miss ratio: vertices transformed per triangle with a
+	// FIFO cache of the given size. 0.5 is ideal, 3.0 is the worst.
+	float ComputeACMR(const std::vector<uint32_t>& indices, size_t vertexCount,
+		size_t cacheSize = 16);
+
+	// Reduces the triangle count towards targetIndexCount with quadric
+	// error metric edge collapses (Garland and Heckbert). Vertices are only
+	// ever collapsed onto other existing vertices, so the simplified indices
+	// still use the same vertex buffer. Vertices on borders and UV/normal
+	// seams stay put, so the result may have more indices than asked for.
+	// outError is the largest distance a surface moved (in model units).
+	// Returns false if the input isn't a valid triangle list.
+	bool Simplify(const std::vector<uint8_t>& vertices, size_t vertexSize,
+		const std::vector<uint32_t>& indices, size_t targetIndexCount,
+		std::vector<uint32_t>& outIndices, float& outError);
+}
@@ -0,0 +1,240 @@
+#include "ITPEnginePCH.h"
+#include "SelfTest.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+
+namespace
+{
+	// Position, normal, texcoord, like the static mesh layout
+	struct GridVertex
+	{
+		float mPos[3];
+		float mNormal[3];
+		float mUV[2];
+	};
+
+	// A flat size x size quad grid on the xy plane, with random z bumps
+	// if bumpy is set
+	void MakeGrid(int size, bool bumpy, std::vector<uint8_t>& outVertices, std::vector<uint32_t>& outIndices)
+	{
+		std::vector<GridVertex> verts;
+		for (int y = 0; y <= size; y++)
+		{
+			for (int x = 0; x <= size; x++)
+			{
+				GridVertex vert;
+				vert.mPos[0] = static_cast<float>(x);
+				vert.mPos[1] = static_cast<float>(y);
+				vert.mPos[2] = bumpy ? Random::GetFloatRange(-0.05f, 0.05f) : 0.0f;
+				vert.mNormal[0] = 0.0f;
+				vert.mNormal[1] = 0.0f;
+				vert.mNormal[2] = 1.0f;
+				vert.mUV[0] = static_cast<float>(x) / size;
+				vert.mUV[1] = static_cast<float>(y) / size;
+				verts.push_back(vert);
+			}
+		}
+		outVertices.resize(verts.size() * sizeof(GridVertex));
+		memcpy(outVertices.data(), verts.data(), outVertices.size());
+
+		outIndices.clear();
+		uint32_t row = static_cast<uint32_t>(size + 1);
+		for (uint32_t y = 0; y < static_cast<uint32_t>(size); y++)
+		{
+			for (uint32_t x = 0; x < static_cast<uint32_t>(size); x++)
+			{
+				uint32_t v = y * row + x;
+				uint32_t tris[6] = { v, v + 1, v + row + 1, v, v + row + 1, v + row };
+				outIndices.insert(outIndices.end(), tris, tris + 6);
+			}
+		}
+	}
+
+	// Shuffles whole triangles, to give the cache optimizer something to do
+	void ShuffleTriangles(std::vector<uint32_t>& indices)
+	{
+		size_t triCount = indices.size() / 3;
+		for (size_t t = triCount - 1; t > 0; t--)
+		{
+			size_t other = static_cast<size_t>(Random::GetIntRange(0, static_cast<int>(t)));
+			for (size_t k = 0; k < 3; k++)
+			{
+				std::swap(indices[t * 3 + k], indices[other * 3 + k]);
+			}
+		}
+	}
+
+	// Splits the grid's vertices down column x, with the triangles to its
+	// right using copies that have different UVs, like a texture seam
+	void AddSeam(int size, int x, std::vector<uint8_t>& vertices, std::vector<uint32_t>& indices,
+		std::vector<uint32_t>& outSeamVertices)
+	{
+		uint32_t row = static_cast<uint32_t>(size + 1);
+		std::vector<uint32_t> copies(vertices.size() / sizeof(GridVertex), 0);
+		outSeamVertices.clear();
+		for (uint32_t y = 0; y < row; y++)
+		{
+			uint32_t v = y * row + x;
+			GridVertex copy;
+			memcpy(&copy, &vertices[v * sizeof(GridVertex)], sizeof(GridVertex));
+			copy.mUV[0] += 1.0f;
+			copies[v] = static_cast<uint32_t>(vertices.size() / sizeof(GridVertex));
+			vertices.insert(vertices.end(), reinterpret_cast<uint8_t*>(&copy),
+				reinterpret_cast<uint8_t*>(&copy) + sizeof(GridVertex));
+			outSeamVertices.push_back(v);
+			outSeamVertices.push_back(copies[v]);
+		}
+
+		for (size_t t = 0; t < indices.size(); t += 3)
+		{
+			bool rightOfSeam = false;
+			for (size_t k = 0; k < 3; k++)
+			{
+				rightOfSeam |= static_cast<int>(indices[t + k] % row) > x;
+			}
+			for (size_t k = 0; rightOfSeam && k < 3; k++)
+			{
+				if (static_cast<int>(indices[t + k] % row) == x)
+				{
+					indices[t + k] = copies[indices[t + k]];
+				}
+			}
+		}
+	}
+
+	// Triangles as sorted triples, so two index lists can be compared
+	// as sets of triangles
+	std::vector<uint64_t> SortedTriangles(const std::vector<uint32_t>& indices)
+	{
+		std::vector<uint64_t> tris;
+		for (size_t t = 0; t + 2 < indices.size(); t += 3)
+		{
+			// Rotate so the smallest index is first, which keeps the winding
+			size_t first = t;
+			if (indices[t + 1] < indices[first]) first = t + 1;
+			if (indices[t + 2] < indices[first]) first = t + 2;
+			uint64_t a = indices[first];
+			uint64_t b = indices[t + (first - t + 1) % 3];
+			uint64_t c = indices[t + (first - t + 2) % 3];
+			tris.push_back((a << 42) | (b << 21) | c);
+		}
+		std::sort(tris.begin(), tris.end());
+		return tris;
+	}
+}
+
+void SelfTest::RunMeshOptimizerTests()
+{
+	// ACMR of the simplest cases: a lone triangle transforms all three of
+	// its vertices, two that share an edge only need four
+	std::vector<uint32_t> oneTri = { 0, 1, 2 };
+	SELF_CHECK(IsNear(MeshOptimizer::ComputeACMR(oneTri, 3), 3.0f, 1e-6f));
+	std::vector<uint32_t> twoTris = { 0, 1, 2, 2, 1, 3 };
+	SELF_CHECK(IsNear(MeshOptimizer::ComputeACMR(twoTris, 4), 2.0f, 1e-6f));
+
+	// The Forsyth reorder keeps every triangle (and its winding), and
+	// gets a shuffled grid close to the ideal 0.5
+	std::vector<uint8_t> vertices;
+	std::vector<uint32_t> indices;
+	MakeGrid(32, false, vertices, indices);
+	size_t vertexCount = vertices.size() / sizeof(GridVertex);
+	ShuffleTriangles(indices);
+	std::vector<uint32_t> optimized(indices);
+	MeshOptimizer::OptimizeVertexCache(optimized, vertexCount);
+	SELF_CHECK(SortedTriangles(optimized) == SortedTriangles(indices));
+	float acmrBefore = MeshOptimizer::ComputeACMR(indices, vertexCount);
+	float acmrAfter = MeshOptimizer::ComputeACMR(optimized, vertexCount);
+	SELF_CHECK(acmrBefore > 1.5f);
+	SELF_CHECK(acmrAfter < 0.8f);
+
+	// Dedup merges identical vertices, and the fetch reorder puts them in
+	// first use order without changing what gets drawn
+	std::vector<uint8_t> doubled(vertices);
+	doubled.insert(doubled.end(), vertices.begin(), vertices.end());
+	std::vector<uint32_t> doubledIndices(optimized);
+	for (size_t i = 0; i < doubledIndices.size(); i += 2)
+	{
+		doubledIndices[i] += static_cast<uint32_t>(vertexCount);
+	}
+	size_t dedupedCount = MeshOptimizer::DeduplicateVertices(doubled, sizeof(GridVertex), doubledIndices);
+	SELF_CHECK(dedupedCount == vertexCount);
+
+	std::vector<uint8_t> fetchVertices(vertices);
+	std::vector<uint32_t> fetchIndices(optimized);
+	size_t fetchCount = MeshOptimizer::OptimizeVertexFetch(fetchVertices, sizeof(GridVertex), fetchIndices);
+	bool fetchInOrder = fetchCount == vertexCount;
+	bool fetchSameMesh = fetchIndices.size() == optimized.size();
+	uint32_t nextNew = 0;
+	for (size_t i = 0; i < fetchIndices.size() && fetchInOrder && fetchSameMesh; i++)
+	{
+		fetchInOrder &= fetchIndices[i] <= nextNew;
+		if (fetchIndices[i] == nextNew)
+		{
+			nextNew++;
+		}
+		fetchSameMesh &= memcmp(&fetchVertices[fetchIndices[i] * sizeof(GridVertex)],
+			&vertices[optimized[i] * sizeof(GridVertex)], sizeof(GridVertex)) == 0;
+	}
+	SELF_CHECK(fetchInOrder);
+	SELF_CHECK(fetchSameMesh);
+
+	// Simplify gets a bumpy grid with a seam down the middle to the
+	// target, without moving the border or the seam, or flipping anything
+	const int kSimplifySize = 32;
+	MakeGrid(kSimplifySize, true, vertices, indices);
+	std::vector<uint32_t> seamVertices;
+	AddSeam(kSimplifySize, kSimplifySize / 2, vertices, indices, seamVertices);
+	vertexCount = vertices.size() / sizeof(GridVertex);
+
+	size_t targetIndexCount = indices.size() / 4;
+	std::vector<uint32_t> simplified;
+	float error = -1.0f;
+	SELF_CHECK(MeshOptimizer::Simplify(vertices, sizeof(GridVertex), indices, targetIndexCount,
+		simplified, error));
+	SELF_CHECK(simplified.size() <= targetIndexCount && simplified.size() % 3 == 0);
+	// The bumps are 0.1 high, so that's about as far as anything can move
+	SELF_CHECK(error > 0.0f && error < 0.2f);
+
+	std::vector<bool> used(vertexCount, false);
+	for (auto index : simplified)
+	{
+		used[index] = true;
+	}
+	bool bordersKept = true;
+	for (int i = 0; i <= kSimplifySize; i++)
+	{
+		uint32_t row = kSimplifySize + 1;
+		bordersKept &= used[i] && used[kSimplifySize * row + i] &&
+			used[i * row] && used[i * row + kSimplifySize];
+	}
+	for (auto v : seamVertices)
+	{
+		bordersKept &= used[v];
+	}
+	SELF_CHECK(bordersKept);
+
+	// The grid faces +z, so every triangle left should too
+	bool noFlips = true;
+	for (size_t t = 0; t < simplified.size(); t += 3)
+	{
+		const GridVertex* tri[3];
+		for (size_t k = 0; k < 3; k++)
+		{
+			tri[k] = reinterpret_cast<const GridVertex*>(&vertices[simplified[t + k] * sizeof(GridVertex)]);
+		}
+		Vector3 p0(tri[0]->mPos[0], tri[0]->mPos[1], tri[0]->mPos[2]);
+		Vector3 p1(tri[1]->mPos[0], tri[1]->mPos[1], tri[1]->mPos[2]);
+		Vector3 p2(tri[2]->mPos[0], tri[2]->mPos[1], tri[2]->mPos[2]);
+		noFlips &= Cross(p1 - p0, p2 - p0).z > 0.0f;
+	}
+	SELF_CHECK(noFlips);
+
+	// Things that aren't triangle lists get turned away
+	std::vector<uint32_t> partialTri(indices.begin(), indices.begin() + 4);
+	SELF_CHECK(!MeshOptimizer::Simplify(vertices, sizeof(GridVertex), partialTri, 0, simplified, error));
+	std::vector<uint32_t> pastEnd(indices);
+	pastEnd[7] = static_cast<uint32_t>(vertexCount);
+	SELF_CHECK(!MeshOptimizer::Simplify(vertices, sizeof(GridVertex), pastEnd, 0, simplified, error));
+	SELF_CHECK(!MeshOptimizer::Simplify(vertices, sizeof(float) * 2, indices, 0, simplified, error));
+	SELF_CHECK(simplified.empty());
+}
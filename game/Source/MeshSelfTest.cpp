@@ -0,0 +1,83 @@
+#include "ITPEnginePCH.h"
+#include "SelfTest.h"
+
+namespace
+{
+	const int kScreenHeight = 768;
+	const float kRadius = 100.0f;
+
+	std::vector<MeshLod> MakeLods()
+	{
+		// Only the errors matter for selection
+		const float errors[] = { 0.0f, 0.5f, 2.0f, 8.0f };
+		std::vector<MeshLod> lods;
+		for (float error : errors)
+		{
+			MeshLod lod;
+			lod.mStartIndex = 0;
+			lod.mIndexCount = 0;
+			lod.mError = error;
+			lods.push_back(lod);
+		}
+		return lods;
+	}
+
+	// How many pixels a LOD's error covers at the given screen size
+	float ErrorInPixels(const MeshLod& lod, float screenSize)
+	{
+		return lod.mError * screenSize * 0.5f * kScreenHeight / kRadius;
+	}
+}
+
+void SelfTest::RunMeshTests()
+{
+	Matrix4 view = Matrix4::CreateLookAt(Vector3::Zero, Vector3::UnitX, Vector3::UnitZ);
+	Matrix4 proj = Matrix4::CreatePerspectiveFOV(Math::ToRadians(70.0f), 1024.0f,
+		static_cast<float>(kScreenHeight), 25.0f, 10000.0f);
+
+	// Screen size falls off with distance, and spheres that reach the
+	// camera count as filling the screen
+	Collision::Sphere sphere;
+	sphere.mRadius = kRadius;
+	sphere.mCenter = Vector3(-500.0f, 0.0f, 0.0f);
+	SELF_CHECK(Mesh::ComputeScreenSize(sphere, view, proj) == FLT_MAX);
+	sphere.mCenter = Vector3(50.0f, 0.0f, 0.0f);
+	SELF_CHECK(Mesh::ComputeScreenSize(sphere, view, proj) == FLT_MAX);
+	sphere.mCenter = Vector3(1000.0f, 0.0f, 0.0f);
+	float nearSize = Mesh::ComputeScreenSize(sphere, view, proj);
+	sphere.mCenter = Vector3(2000.0f, 0.0f, 0.0f);
+	float farSize = Mesh::ComputeScreenSize(sphere, view, proj);
+	SELF_CHECK(IsNear(nearSize, 2.0f * farSize, 1e-5f));
+
+	// Walking away from the mesh, the LOD only ever gets coarser, and
+	// each pick is the coarsest one that stays under a pixel of error
+	std::vector<MeshLod> lods = MakeLods();
+	bool neverFiner = true;
+	bool isCoarsestValid = true;
+	size_t prevLod = 0;
+	for (float distance = 150.0f; distance < 200000.0f; distance *= 1.1f)
+	{
+		sphere.mCenter = Vector3(distance, 0.0f, 0.0f);
+		float screenSize = Mesh::ComputeScreenSize(sphere, view, proj);
+		size_t lod = Mesh::SelectLod(lods, kRadius, screenSize, kScreenHeight, 1.0f);
+
+		neverFiner &= lod >= prevLod;
+		prevLod = lod;
+		if (lod > 0)
+		{
+			isCoarsestValid &= ErrorInPixels(lods[lod], screenSize) <= 1.0f;
+		}
+		if (lod + 1 < lods.size())
+		{
+			isCoarsestValid &= ErrorInPixels(lods[lod + 1], screenSize) > 1.0f;
+		}
+	}
+	SELF_CHECK(neverFiner);
+	SELF_CHECK(isCoarsestValid);
+	// Far enough away, everything goes to the last LOD
+	SELF_CHECK(prevLod == lods.size() - 1);
+
+	// Up close, or without a usable bounding sphere, it's LOD 0
+	SELF_CHECK(Mesh::SelectLod(lods, kRadius, FLT_MAX, kScreenHeight, 1.0f) == 0);
+	SELF_CHECK(Mesh::SelectLod(lods, 0.0f, 0.001f, kScreenHeight, 1.0f) == 0);
+}
@@ -0,0 +1,140 @@
+#pragma once
+#include <vector>
+#include "Delegate.h"
+
+// Identifies one binding in a MulticastDelegate (0 is never used)
+typedef unsigned int DelegateHandle;
+
+// A MulticastDelegate calls any number of bound delegates in the order
+// they were added. Bindings live in a flat array, and it's safe to add
+// or remove bindings from inside a broadcast: removed bindings are
+// skipped right away, and added ones first fire on the next broadcast.
+template <typename ...Params>
+class MulticastDelegate
+{
+public:
+	MulticastDelegate()
+		:mNextHandle(0)
+		,mBroadcastDepth(0)
+		,mNeedsCompact(false)
+	{ }
+
+	DelegateHandle Add(const Delegate<Params...>& delegate)
+	{
+		mNextHandle++;
+		if (mNextHandle == 0)
+		{
+			mNextHandle++;
+		}
+
+		Binding binding;
+		binding.mDelegate = delegate;
+		binding.mHandle = mNextHandle;
+		mBindings.push_back(binding);
+		return mNextHandle;
+	}
+
+	template <typename T>
+	DelegateHandle Add(T* obj, void (T::*func)(Params...))
+	{
+		return Add(Delegate<Params...>(obj, func));
+	}
+
+	void Remove(DelegateHandle handle)
+	{
+		for (size_t i = 0; i < mBindings.size(); i++)
+		{
+			if (mBindings[i].mHandle == handle)
+			{
+				if (mBroadcastDepth > 0)
+				{
+					// Can't shift the array out from under a broadcast
+					mBindings[i].mHandle = 0;
+					mNeedsCompact = true;
+				}
+				else
+				{
+					mBindings.erase(mBindings.begin() + i);
+				}
+				return;
+			}
+		}
+	}
+
+	void Clear()
+	{
+		if (mBroadcastDepth > 0)
+		{
+			for (auto& binding : mBindings)
+			{
+				binding.mHandle = 0;
+			}
+			mNeedsCompact = true;
+		}
+		else
+		{
+			mBindings.clear();
+		}
+	}
+
+	void Broadcast(Params... p)
+	{
+		mBroadcastDepth++;
+
+		// Only fire what was bound when the broadcast started
+		size_t count = mBindings.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			if (mBindings[i].mHandle != 0)
+			{
+				// Call a copy, since a callback that binds more
+				// delegates may reallocate the array
+				Delegate<Params...> delegate = mBindings[i].mDelegate;
+				delegate.Execute(p...);
+			}
+		}
+
+		mBroadcastDepth--;
+		if (mBroadcastDepth == 0 && mNeedsCompact)
+		{
+			Compact();
+		}
+	}
+
+	bool IsBound() const
+	{
+		for (auto& binding : mBindings)
+		{
+			if (binding.mHandle != 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+private:
+	void Compact()
+	{
+		size_t dest = 0;
+		for (size_t i = 0; i < mBindings.size(); i++)
+		{
+			if (mBindings[i].mHandle != 0)
+			{
+				mBindings[dest++] = mBindings[i];
+			}
+		}
+		mBindings.resize(dest);
+		mNeedsCompact = false;
+	}
+
+	struct Binding
+	{
+		Delegate<Params...> mDelegate;
+		DelegateHandle mHandle;
+	};
+
+	std::vector<Binding> mBindings;
+	DelegateHandle mNextHandle;
+	int mBroadcastDepth;
+	bool mNeedsCompact;
+};
@@ -139,6 +139,7 @@
 		return std::static_pointer_cast<d>(shared_from_this()); \
 	} \
 	public: \
+	static const char* StaticTypeName() { return #d; } \
 	static std::shared_ptr<d> StaticLoad(const char* file, class AssetCache* cache, Game& game) \
 	{ \
 		std::shared_ptr<d> ptr = std::make_shared<d>(game); \
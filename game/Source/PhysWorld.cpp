@@ -1,5 +1,6 @@
 #include "ITPEnginePCH.h"
 #include <unordered_map>
+#include "GameEvents.h"
 
 PhysWorld::PhysWorld()
 	:mIsInTick(false)
@@ -56,6 +57,11 @@ void PhysWorld::Tick(float deltaTime)
 					outer->GetOwner().BeginTouch(inner->GetOwner());
 					inner->GetOwner().BeginTouch(outer->GetOwner());
 					AddCollisionPair(outer->GetOwner(), inner->GetOwner());
+
+					TouchEvent touch;
+					touch.mFirst = &outer->GetOwner();
+					touch.mSecond = &inner->GetOwner();
+					outer->GetOwner().GetGame().GetEventBus().Queue(touch);
 				}
 			}
 		}
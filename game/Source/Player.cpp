@@ -1,5 +1,6 @@
 #include "ITPEnginePCH.h"
 #include "Player.h"
+#include "GameEvents.h"
 
 IMPL_ACTOR(Player, Actor);
 
@@ -54,6 +55,11 @@ void Player::OnRespawn()
 {
 	SetPosition(mRespawnPosition);
 	OnRecenter();
+
+	RespawnEvent respawn;
+	respawn.mPlayer = this;
+	respawn.mPosition = mRespawnPosition;
+	mGame.GetEventBus().Queue(respawn);
 }
 
 void Player::SetProperties(const rapidjson::Value& properties)
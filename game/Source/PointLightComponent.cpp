@@ -4,6 +4,7 @@ IMPL_COMPONENT(PointLightComponent, Component, MAX_POINT_LIGHTS);
 
 PointLightComponent::PointLightComponent(Actor& owner)
 	:Component(owner)
+	,mDirty(true)
 {
 	mData.mEnabled = 1;
 	mData.mPosition = owner.GetPosition();
@@ -23,7 +24,12 @@ void PointLightComponent::Unregister()
 
 void PointLightComponent::OnUpdatedTransform()
 {
-	mData.mPosition = mOwner.GetPosition();
+	// Rotating or scaling the owner doesn't change anything
+	const Vector3& position = mOwner.GetPosition();
+	if (position.x != mData.mPosition.x || position.y != mData.mPosition.y || position.z != mData.mPosition.z)
+	{
+		SetPosition(position);
+	}
 }
 
 void PointLightComponent::SetProperties(const rapidjson::Value& properties)
@@ -15,32 +15,37 @@ public:
 
 	const PointLightData& GetData() const { return mData; }
 
+	// Set whenever the light changes, so the Renderer knows to upload it again
+	bool IsDirty() const { return mDirty; }
+	void ClearDirty() { mDirty = false; }
+
 	// Getter/setter functions for PointLightData
 
 	const Vector3& GetDiffuse() const { return mData.mDiffuse; }
-	void SetDiffuse(const Vector3 &diffuse) { mData.mDiffuse = diffuse; }
+	void SetDiffuse(const Vector3 &diffuse) { mData.mDiffuse = diffuse; mDirty = true; }
 
 	const Vector3& GetSpecular() const { return mData.mSpecular; }
-	void SetSpecular(const Vector3 &specular) { mData.mSpecular = specular; }
+	void SetSpecular(const Vector3 &specular) { mData.mSpecular = specular; mDirty = true; }
 
 	const Vector3& GetPosition() const { return mData.mPosition; }
-	void SetPosition(const Vector3 &position) { mData.mPosition = position; }
+	void SetPosition(const Vector3 &position) { mData.mPosition = position; mDirty = true; }
 
 	float GetSpecularPower() const { return mData.mSpecularPower; }
-	void SetSpecularPower(const float specularPower) { mData.mSpecularPower = specularPower; }
+	void SetSpecularPower(const float specularPower) { mData.mSpecularPower = specularPower; mDirty = true; }
 
 	float GetInnerRadius() const { return mData.mInnerRadius; }
-	void SetInnerRadius(const float innerRadius) { mData.mInnerRadius = innerRadius; }
+	void SetInnerRadius(const float innerRadius) { mData.mInnerRadius = innerRadius; mDirty = true; }
 
 	float GetOuterRadius() const { return mData.mOuterRadius; }
-	void SetOuterRadius(const float outerRadius) { mData.mOuterRadius = outerRadius; }
+	void SetOuterRadius(const float outerRadius) { mData.mOuterRadius = outerRadius; mDirty = true; }
 
 	int IsEnabled() const { return mData.mEnabled; }
-	void SetEnabled(const int enabled) { mData.mEnabled = enabled; }
+	void SetEnabled(const int enabled) { mData.mEnabled = enabled; mDirty = true; }
 
 	void SetProperties(const rapidjson::Value& properties) override;
 private:
 	PointLightData mData;
+	bool mDirty;
 };
 
 DECL_PTR(PointLightComponent);
@@ -1,7 +1,9 @@
 #pragma once
 #include "Math.h"
 
-const size_t MAX_POINT_LIGHTS = 8;
+// Lights are culled per cluster (see LightClusters), so the
+// scene can have a lot more of them than reach any one pixel
+const size_t MAX_POINT_LIGHTS = 256;
 
 struct PointLightData
 {
@@ -0,0 +1,197 @@
+#include "ITPEnginePCH.h"
+#include "RenderQueue.h"
+
+namespace
+{
+	// Squashes a pointer down to a 16-bit id for the sort key. Two
+	// pointers sharing an id only costs some grouping, since execution
+	// compares the real pointers.
+	uint64_t PointerId(const void* ptr)
+	{
+		uint64_t value = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr));
+		return ((value >> 4) * 0x9E3779B97F4A7C15ULL) >> 48;
+	}
+
+	// Fewer draws than this aren't worth the trip through the instance buffer
+	const uint32_t kMinInstanceCount = 2;
+}
+
+RenderQueue::RenderQueue()
+	:mStats()
+{
+
+}
+
+void RenderQueue::Clear()
+{
+	mCommands.clear();
+	mOrder.clear();
+	mBatches.clear();
+	mInstanceTransforms.clear();
+}
+
+void RenderQueue::Submit(const Command& command)
+{
+	mCommands.push_back(command);
+}
+
+uint64_t RenderQueue::MakeKey(ELayer layer, EMeshShader shader, const Texture* texture,
+	const VertexArray* vertexArray, size_t lod, float depth)
+{
+	uint64_t depthBits = static_cast<uint64_t>(Math::Clamp(depth, 0.0f, 1.0f) * 0xfffff);
+	return (static_cast<uint64_t>(layer & 0xf) << 60) |
+		(static_cast<uint64_t>(shader & 0xf) << 56) |
+		(PointerId(texture) << 40) |
+		(PointerId(vertexArray) << 24) |
+		(static_cast<uint64_t>(min(lod, static_cast<size_t>(0xf))) << 20) |
+		depthBits;
+}
+
+void RenderQueue::Sort()
+{
+	size_t count = mCommands.size();
+	mOrder.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		mOrder[i] = static_cast<uint32_t>(i);
+	}
+
+	mStats.mNumDraws = count;
+	mStats.mUnsorted = CountStateChanges(mOrder);
+	if (count == 0)
+	{
+		mStats.mSorted = mStats.mUnsorted;
+		BuildBatches();
+		return;
+	}
+
+	// LSD radix sort on the keys, a byte at a time. Each pass is stable,
+	// so by the last one everything is in key order.
+	mTempOrder.resize(count);
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		size_t counts[256] = { 0 };
+		for (size_t i = 0; i < count; i++)
+		{
+			counts[(mCommands[i].mKey >> shift) & 0xff]++;
+		}
+
+		// Every key has the same byte here, so this pass wouldn't move anything
+		if (counts[(mCommands[0].mKey >> shift) & 0xff] == count)
+		{
+			continue;
+		}
+
+		size_t offsets[256];
+		size_t total = 0;
+		for (int b = 0; b < 256; b++)
+		{
+			offsets[b] = total;
+			total += counts[b];
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			uint32_t index = mOrder[i];
+			mTempOrder[offsets[(mCommands[index].mKey >> shift) & 0xff]++] = index;
+		}
+		mOrder.swap(mTempOrder);
+	}
+
+	mStats.mSorted = CountStateChanges(mOrder);
+	BuildBatches();
+}
+
+bool RenderQueue::CanInstance(EMeshShader shader)
+{
+	return shader == EMS_Basic || shader == EMS_Phong;
+}
+
+EMeshShader RenderQueue::GetInstancedShader(EMeshShader shader)
+{
+	return shader == EMS_Phong ? EMS_PhongInstanced : EMS_BasicInstanced;
+}
+
+bool RenderQueue::CanBatch(const Command& a, const Command& b)
+{
+	return CanInstance(a.mShader) &&
+		a.mShader == b.mShader &&
+		a.mTexture == b.mTexture &&
+		a.mVertexArray == b.mVertexArray &&
+		a.mStartIndex == b.mStartIndex &&
+		a.mIndexCount == b.mIndexCount &&
+		!a.mPalette && !b.mPalette;
+}
+
+void RenderQueue::BuildBatches()
+{
+	mBatches.clear();
+	mInstanceTransforms.clear();
+	mStats.mNumInstanced = 0;
+
+	// Sorting put draws with the same state next to each other, so
+	// a batch is just a run of commands that can be merged
+	size_t count = mOrder.size();
+	size_t first = 0;
+	while (first < count)
+	{
+		const Command& command = mCommands[mOrder[first]];
+		size_t last = first + 1;
+		while (last < count && CanBatch(command, mCommands[mOrder[last]]))
+		{
+			last++;
+		}
+
+		Batch batch;
+		batch.mFirst = static_cast<uint32_t>(first);
+		batch.mCount = static_cast<uint32_t>(last - first);
+		batch.mFirstInstance = static_cast<uint32_t>(mInstanceTransforms.size());
+		batch.mIsInstanced = batch.mCount >= kMinInstanceCount;
+		if (batch.mIsInstanced)
+		{
+			for (size_t i = first; i < last; i++)
+			{
+				mInstanceTransforms.push_back(mCommands[mOrder[i]].mWorldTransform);
+			}
+			mStats.mNumInstanced += batch.mCount;
+			mBatches.push_back(batch);
+		}
+		else
+		{
+			// Everything in a run that's too short draws on its own
+			for (size_t i = first; i < last; i++)
+			{
+				batch.mFirst = static_cast<uint32_t>(i);
+				batch.mCount = 1;
+				mBatches.push_back(batch);
+			}
+		}
+		first = last;
+	}
+
+	mStats.mNumDrawCalls = mBatches.size();
+}
+
+RenderQueue::StateChanges RenderQueue::CountStateChanges(const std::vector<uint32_t>& order) const
+{
+	StateChanges changes = { 0, 0, 0 };
+	const Command* last = nullptr;
+	for (auto index : order)
+	{
+		const Command& command = mCommands[index];
+		if (!last || command.mShader != last->mShader)
+		{
+			changes.mShaders++;
+		}
+		if (!last || command.mTexture != last->mTexture)
+		{
+			changes.mTextures++;
+		}
+		if (!last || command.mVertexArray != last->mVertexArray)
+		{
+			changes.mVertexArrays++;
+		}
+		last = &command;
+	}
+	return changes;
+}
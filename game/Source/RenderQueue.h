@@ -0,0 +1,115 @@
+// RenderQueue.h
+// Collects mesh draws for a frame so they can be sorted by state
+// (shader, then texture, then vertex array and LOD, then front to back)
+// before the Renderer executes them. Runs of identical static mesh
+// draws are merged into instanced batches.
+
+#pragma once
+#include "Math.h"
+#include "VertexArray.h"
+#include "Texture.h"
+#include "ShaderTypes.h"
+#include <vector>
+
+class RenderQueue
+{
+public:
+	// Everything needed to execute one draw
+	struct Command
+	{
+		uint64_t mKey;
+		VertexArrayPtr mVertexArray;
+		TexturePtr mTexture;
+		Matrix4 mWorldTransform;
+		// Only for skinned meshes, and must live until the queue is executed
+		const struct MatrixPalette* mPalette;
+		EMeshShader mShader;
+		uint32_t mStartIndex;
+		uint32_t mIndexCount;
+	};
+
+	// How many times the shader, texture and vertex array change
+	// when drawing in a given order
+	struct StateChanges
+	{
+		size_t mShaders;
+		size_t mTextures;
+		size_t mVertexArrays;
+	};
+
+	// A run of sorted commands that's drawn with one call
+	struct Batch
+	{
+		// Index of the first command, for GetSorted
+		uint32_t mFirst;
+		uint32_t mCount;
+		// Where this batch's transforms start in GetInstanceTransforms
+		uint32_t mFirstInstance;
+		bool mIsInstanced;
+	};
+
+	struct Stats
+	{
+		size_t mNumDraws;
+		// Draw calls after batching
+		size_t mNumDrawCalls;
+		// Draws that went into instanced batches
+		size_t mNumInstanced;
+		// In the order things were submitted
+		StateChanges mUnsorted;
+		// In the order things were drawn
+		StateChanges mSorted;
+	};
+
+	// Lower layers draw first (such as opaque before transparent)
+	enum ELayer
+	{
+		EL_Opaque = 0,
+		EL_Transparent,
+	};
+
+	RenderQueue();
+
+	void Clear();
+	void Submit(const Command& command);
+
+	// Sorts the commands by key, counts the state changes and
+	// builds the batches
+	void Sort();
+
+	size_t GetNumCommands() const { return mCommands.size(); }
+	// After Sort, GetSorted(i) is the i-th command to draw
+	const Command& GetSorted(size_t i) const { return mCommands[mOrder[i]]; }
+
+	const std::vector<Batch>& GetBatches() const { return mBatches; }
+	// World transforms for every instanced batch, one after another
+	const std::vector<Matrix4>& GetInstanceTransforms() const { return mInstanceTransforms; }
+
+	// Only the static, non-quantized shaders have instanced versions
+	static bool CanInstance(EMeshShader shader);
+	static EMeshShader GetInstancedShader(EMeshShader shader);
+
+	const Stats& GetStats() const { return mStats; }
+
+	// Packs the state into a key, from most to least significant:
+	// layer (4 bits) | shader (4) | texture (16) | vertex array (16) | LOD (4) | depth (20)
+	// The LOD keeps draws of the same index range together, so they can
+	// batch. LODs past 15 share the last value. depth is 0 at the camera
+	// and 1 at the far plane.
+	static uint64_t MakeKey(ELayer layer, EMeshShader shader, const Texture* texture,
+		const VertexArray* vertexArray, size_t lod, float depth);
+private:
+	StateChanges CountStateChanges(const std::vector<uint32_t>& order) const;
+	void BuildBatches();
+	// Can b be drawn in the same instanced call as a?
+	static bool CanBatch(const Command& a, const Command& b);
+
+	std::vector<Command> mCommands;
+	// Indices into mCommands, sorted by key
+	std::vector<uint32_t> mOrder;
+	// Scratch space for the radix sort
+	std::vector<uint32_t> mTempOrder;
+	std::vector<Batch> mBatches;
+	std::vector<Matrix4> mInstanceTransforms;
+	Stats mStats;
+};
@@ -0,0 +1,161 @@
+#include "ITPEnginePCH.h"
+#include "SelfTest.h"
+#include "RenderQueue.h"
+
+namespace
+{
+	const int kNumCommands = 3001;
+
+	// The queue only compares these, so they never get used. The aliasing
+	// constructor gives a pointer that doesn't own (or touch) anything.
+	template <typename T>
+	std::shared_ptr<T> FakePointer(uintptr_t id)
+	{
+		return std::shared_ptr<T>(std::shared_ptr<T>(), reinterpret_cast<T*>(0x1000 + id * 16));
+	}
+
+	// mStartIndex doubles as the submission order, to check stability
+	RenderQueue::Command MakeCommand(uint64_t key, uint32_t order)
+	{
+		RenderQueue::Command command;
+		command.mKey = key;
+		command.mVertexArray = FakePointer<VertexArray>(key & 0xff);
+		command.mTexture = FakePointer<Texture>((key >> 8) & 0xff);
+		command.mWorldTransform = Matrix4::Identity;
+		command.mPalette = nullptr;
+		command.mShader = EMS_Skinned;
+		command.mStartIndex = order;
+		command.mIndexCount = 3;
+		return command;
+	}
+
+	uint64_t RandomBits(int bits)
+	{
+		uint64_t value = 0;
+		for (int i = 0; i < bits; i += 16)
+		{
+			value = (value << 16) | static_cast<uint64_t>(Random::GetIntRange(0, 0xffff));
+		}
+		return bits < 64 ? value & ((1ULL << bits) - 1) : value;
+	}
+}
+
+void SelfTest::RunRenderQueueTests()
+{
+	// The radix sort puts random keys in order, and keeps equal keys in
+	// the order they came in. The top byte is the same for everything,
+	// so that pass gets skipped.
+	RenderQueue queue;
+	std::vector<uint64_t> keys;
+	for (int i = 0; i < kNumCommands; i++)
+	{
+		// Plenty of repeats, and keys that only differ in the low bytes
+		uint64_t key = (0x12ULL << 56) | (RandomBits(16) << 40) | RandomBits(8);
+		if (i % 3 == 0)
+		{
+			key = (0x12ULL << 56) | RandomBits(56);
+		}
+		keys.push_back(key);
+		queue.Submit(MakeCommand(key, static_cast<uint32_t>(i)));
+	}
+	queue.Sort();
+
+	bool isSorted = queue.GetNumCommands() == keys.size();
+	bool isStable = true;
+	std::vector<bool> seen(keys.size(), false);
+	for (size_t i = 1; i < queue.GetNumCommands() && isSorted; i++)
+	{
+		const RenderQueue::Command& prev = queue.GetSorted(i - 1);
+		const RenderQueue::Command& cur = queue.GetSorted(i);
+		isSorted &= prev.mKey <= cur.mKey;
+		isStable &= prev.mKey != cur.mKey || prev.mStartIndex < cur.mStartIndex;
+	}
+	for (size_t i = 0; i < queue.GetNumCommands() && isSorted; i++)
+	{
+		const RenderQueue::Command& command = queue.GetSorted(i);
+		isSorted &= !seen[command.mStartIndex] && keys[command.mStartIndex] == command.mKey;
+		seen[command.mStartIndex] = true;
+	}
+	SELF_CHECK(isSorted);
+	SELF_CHECK(isStable);
+
+	// An empty queue sorts to nothing
+	queue.Clear();
+	queue.Sort();
+	SELF_CHECK(queue.GetNumCommands() == 0 && queue.GetBatches().empty());
+
+	// In the key, the LOD comes before depth, so draws of the same LOD end
+	// up next to each other however far away they are
+	VertexArray* vertexArray = FakePointer<VertexArray>(1).get();
+	Texture* texture = FakePointer<Texture>(2).get();
+	uint64_t nearLod1 = RenderQueue::MakeKey(RenderQueue::EL_Opaque, EMS_Phong, texture, vertexArray, 1, 0.1f);
+	uint64_t farLod0 = RenderQueue::MakeKey(RenderQueue::EL_Opaque, EMS_Phong, texture, vertexArray, 0, 0.9f);
+	uint64_t farLod1 = RenderQueue::MakeKey(RenderQueue::EL_Opaque, EMS_Phong, texture, vertexArray, 1, 0.9f);
+	SELF_CHECK(farLod0 < nearLod1 && nearLod1 < farLod1);
+	// LODs past the field share the last value instead of spilling over
+	SELF_CHECK(RenderQueue::MakeKey(RenderQueue::EL_Opaque, EMS_Phong, texture, vertexArray, 40, 0.0f) ==
+		RenderQueue::MakeKey(RenderQueue::EL_Opaque, EMS_Phong, texture, vertexArray, 15, 0.0f));
+	// Layer beats everything else
+	SELF_CHECK(RenderQueue::MakeKey(RenderQueue::EL_Opaque, EMS_Skinned, texture, vertexArray, 15, 1.0f) <
+		RenderQueue::MakeKey(RenderQueue::EL_Transparent, EMS_Basic, nullptr, nullptr, 0, 0.0f));
+
+	// Batching merges runs of the same static mesh, LOD and texture into
+	// instanced draws, and leaves everything else on its own
+	queue.Clear();
+	MatrixPalette* palette = reinterpret_cast<MatrixPalette*>(0x2000);
+	const struct
+	{
+		EMeshShader mShader;
+		uint32_t mStartIndex;
+		bool mSkinned;
+	} draws[] =
+	{
+		// Three of the same LOD, then one at another LOD
+		{ EMS_Phong, 0, false }, { EMS_Phong, 0, false }, { EMS_Phong, 0, false },
+		{ EMS_Phong, 36, false },
+		// Skinned meshes can't instance, even when everything else matches
+		{ EMS_Skinned, 0, true }, { EMS_Skinned, 0, true },
+		// Quantized shaders don't have instanced versions
+		{ EMS_BasicQuantized, 0, false }, { EMS_BasicQuantized, 0, false },
+		// A run of two is enough
+		{ EMS_Basic, 0, false }, { EMS_Basic, 0, false },
+	};
+	const size_t numDraws = sizeof(draws) / sizeof(draws[0]);
+	for (size_t i = 0; i < numDraws; i++)
+	{
+		RenderQueue::Command command = MakeCommand(0, draws[i].mStartIndex);
+		command.mKey = RenderQueue::MakeKey(RenderQueue::EL_Opaque, draws[i].mShader, texture, vertexArray,
+			draws[i].mStartIndex / 36, static_cast<float>(i) / numDraws);
+		command.mShader = draws[i].mShader;
+		command.mPalette = draws[i].mSkinned ? palette : nullptr;
+		command.mIndexCount = 36;
+		command.mWorldTransform = Matrix4::CreateTranslation(Vector3(static_cast<float>(i), 0.0f, 0.0f));
+		queue.Submit(command);
+	}
+	queue.Sort();
+
+	// Sorted by shader: Basic, Phong, Skinned, BasicQuantized
+	const std::vector<RenderQueue::Batch>& batches = queue.GetBatches();
+	SELF_CHECK(batches.size() == 7);
+	SELF_CHECK(queue.GetStats().mNumDrawCalls == 7 && queue.GetStats().mNumInstanced == 5);
+	bool batchesMatch = batches.size() == 7;
+	const uint32_t expectedCounts[] = { 2, 3, 1, 1, 1, 1, 1 };
+	for (size_t i = 0; i < batches.size() && batchesMatch; i++)
+	{
+		batchesMatch &= batches[i].mCount == expectedCounts[i] &&
+			batches[i].mIsInstanced == (expectedCounts[i] > 1);
+	}
+	SELF_CHECK(batchesMatch);
+
+	// Instanced batches get their transforms in draw order
+	bool transformsMatch = queue.GetInstanceTransforms().size() == 5;
+	for (size_t b = 0; b < batches.size() && transformsMatch; b++)
+	{
+		for (uint32_t i = 0; batches[b].mIsInstanced && i < batches[b].mCount; i++)
+		{
+			transformsMatch &= IsNear(queue.GetInstanceTransforms()[batches[b].mFirstInstance + i],
+				queue.GetSorted(batches[b].mFirst + i).mWorldTransform, 1e-6f);
+		}
+	}
+	SELF_CHECK(transformsMatch);
+}
@@ -0,0 +1,43 @@
+#include "ITPEnginePCH.h"
+#include "RenderSnapshot.h"
+#include <algorithm>
+
+RenderSnapshot::RenderSnapshot()
+	:mLightsChanged(false)
+	,mAmbientLightChanged(false)
+	,mNumCommandLists(0)
+	,mNumCommands(0)
+	,mNumSpriteDrawCalls(0)
+	,mNumStatesIssued(0)
+	,mNumStatesFiltered(0)
+{
+
+}
+
+void RenderSnapshot::Clear()
+{
+	mQueue.Clear();
+	mPalettes.clear();
+	mSprites.clear();
+	mLights.clear();
+	mLightsChanged = false;
+	mAmbientLightChanged = false;
+}
+
+const MatrixPalette* RenderSnapshot::AddPalette(const MatrixPalette& palette)
+{
+	mPalettes.emplace_back();
+	MatrixPalette& copy = mPalettes.back();
+	memcpy(copy.mMatrixPalette, palette.mMatrixPalette, palette.mNumBones * sizeof(SimdMatrix4));
+	copy.mNumBones = palette.mNumBones;
+	return &copy;
+}
+
+void RenderSnapshot::SortSprites()
+{
+	std::stable_sort(mSprites.begin(), mSprites.end(),
+		[](const SpriteDraw& a, const SpriteDraw& b)
+	{
+		return a.mTexture.get() < b.mTexture.get();
+	});
+}
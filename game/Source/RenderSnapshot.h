@@ -0,0 +1,59 @@
+// RenderSnapshot.h
+// Everything the render thread needs to draw one frame. The main thread
+// copies it out of the game, so it can go on to simulate the next frame
+// while this one is drawn (see Renderer::RenderFrame). Nothing in here
+// points back into the game.
+
+#pragma once
+#include "RenderQueue.h"
+#include "MatrixPalette.h"
+#include "PointLightData.h"
+#include <deque>
+#include <vector>
+
+struct RenderSnapshot
+{
+	struct SpriteDraw
+	{
+		TexturePtr mTexture;
+		Matrix4 mWorldTransform;
+		// The part of the texture to draw (glyphs only use some of the atlas)
+		Vector2 mUVMin;
+		Vector2 mUVMax;
+		Vector3 mColor;
+	};
+
+	RenderSnapshot();
+
+	void Clear();
+
+	// Copies the bones in use, and returns a palette that lives as long as the snapshot
+	const MatrixPalette* AddPalette(const MatrixPalette& palette);
+
+	// Groups the sprites by texture, so the sprite batch can draw each
+	// group with one call. Sprites with the same texture keep their order.
+	void SortSprites();
+
+	Matrix4 mView;
+
+	// Only visible meshes are in here
+	RenderQueue mQueue;
+	// Palettes for the skinned meshes in mQueue, in a deque so they don't move
+	std::deque<MatrixPalette> mPalettes;
+
+	// In the order they're drawn, after the meshes
+	std::vector<SpriteDraw> mSprites;
+
+	// Only filled in when the lights changed since the last snapshot
+	std::vector<PointLightData> mLights;
+	bool mLightsChanged;
+	Vector3 mAmbientLight;
+	bool mAmbientLightChanged;
+
+	// Filled in by the render thread once the snapshot is drawn
+	size_t mNumCommandLists;
+	size_t mNumCommands;
+	size_t mNumSpriteDrawCalls;
+	size_t mNumStatesIssued;
+	size_t mNumStatesFiltered;
+};
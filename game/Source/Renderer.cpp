@@ -1,17 +1,53 @@
 #include "ITPEnginePCH.h"
 #include "SimdMath.h"
 
+namespace
+{
+	// Near and far planes of the 3D projection
+	const float kNearPlane = 25.0f;
+	const float kFarPlane = 10000.0f;
+
+	// Batches each command list records. Fewer than this per list and
+	// the job overhead outweighs the recording itself.
+	const size_t kBatchesPerCommandList = 128;
+}
+
 Renderer::Renderer(Game& game)
 	:mGame(game)
 	,mWindow(nullptr)
 	,mWidth(0)
 	,mHeight(0)
+	,mCullStats()
+	,mInstanceCapacity(0)
+	,mLightsDirty(true)
+	,mCommandStats()
+	,mQueueStats()
+	,mSpriteStats()
+	,mStateStats()
+	,mAmbientLightDirty(true)
+	,mBuilding(&mSnapshots[0])
+	,mPending(nullptr)
+	,mRendering(false)
+	,mStopRenderThread(false)
 {
 
 }
 
 Renderer::~Renderer()
 {
+	// Stop the render thread before anything it draws with goes away
+	if (mRenderThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mRenderMutex);
+			mStopRenderThread = true;
+		}
+		mRenderCV.notify_one();
+		mRenderThread.join();
+	}
+	mSnapshots[0].Clear();
+	mSnapshots[1].Clear();
+
 	// Clear components...
 	mDrawComponents.clear();
 	mComponents2D.clear();
@@ -25,9 +61,15 @@ Renderer::~Renderer()
 	mMeshBlendState.reset();
 
 	mSpriteShader.reset();
-	mSpriteVerts.reset();
+	mSpriteBatch.reset();
 
 	mMeshShaders.clear();
+	mInstanceBuffer.reset();
+	mInstancedLayout.reset();
+	mFrameConstants.reset();
+	mLightDataBuffer = LightBuffer();
+	mClusterBuffer = LightBuffer();
+	mLightIndexBuffer = LightBuffer();
 
 	// Shutdown the input cache and graphics driver
 	mInputLayoutCache.reset();
@@ -53,6 +95,10 @@ bool Renderer::Init(int width, int height)
 
 	mGraphicsDriver = std::make_shared<GraphicsDriver>(GetActiveWindow());
 	mInputLayoutCache = std::make_shared<InputLayoutCache>();
+	if (mGraphicsDriver->SupportsConstantBufferOffsets())
+	{
+		mFrameConstants = std::make_shared<FrameConstantBuffer>(*mGraphicsDriver);
+	}
 
 	mWidth = width;
 	mHeight = height;
@@ -67,19 +113,68 @@ bool Renderer::Init(int width, int height)
 		return false;
 	}
 
-	if (!InitSpriteVerts())
+	if (!InitLightClusters())
+	{
+		return false;
+	}
+
+	if (!InitSpriteBatch())
 	{
 		return false;
 	}
 
+	// From here on only the render thread uses the immediate context
+	mRenderThread = std::thread(&Renderer::RenderThreadLoop, this);
+
 	return true;
 }
 
 void Renderer::RenderFrame()
 {
-	Clear();
-	DrawComponents();
-	Present();
+	BuildSnapshot(*mBuilding);
+
+	// Wait for the render thread to finish the last frame, so the other
+	// snapshot is free, then hand it this one. The game can be at most
+	// one frame ahead of what's on screen.
+	{
+		std::unique_lock<std::mutex> lock(mRenderMutex);
+		mIdleCV.wait(lock, [this]
+		{
+			return mPending == nullptr && !mRendering;
+		});
+		mPending = mBuilding;
+	}
+	mRenderCV.notify_one();
+
+	mBuilding = (mBuilding == &mSnapshots[0]) ? &mSnapshots[1] : &mSnapshots[0];
+}
+
+void Renderer::RenderThreadLoop()
+{
+	std::unique_lock<std::mutex> lock(mRenderMutex);
+	while (true)
+	{
+		mRenderCV.wait(lock, [this]
+		{
+			return mStopRenderThread || mPending != nullptr;
+		});
+
+		if (mStopRenderThread)
+		{
+			return;
+		}
+
+		RenderSnapshot* snapshot = mPending;
+		mPending = nullptr;
+		mRendering = true;
+
+		lock.unlock();
+		DrawSnapshot(*snapshot);
+		lock.lock();
+
+		mRendering = false;
+		mIdleCV.notify_all();
+	}
 }
 
 void Renderer::AddComponent(DrawComponentPtr component)
@@ -117,128 +212,346 @@ void Renderer::RemoveComponent(DrawComponentPtr component)
 void Renderer::AddPointLight(PointLightComponentPtr light)
 {
 	mPointLights.insert(light);
-	UpdatePointLights();
+	mLightsDirty = true;
 }
 
 void Renderer::RemovePointLight(PointLightComponentPtr light)
 {
 	mPointLights.erase(light);
-	UpdatePointLights();
+	mLightsDirty = true;
 }
 
-void Renderer::UpdatePointLights()
+void Renderer::UpdatePointLights(const RenderSnapshot& snapshot)
 {
-	for (auto meshShader : mMeshShaders)
+	// The snapshot only has the lights if one of them changed
+	if (snapshot.mLightsChanged)
 	{
-		int i = 0;
+		mLightData = snapshot.mLights;
 
-		// Update point lights data stored in every mesh shader
-		for (auto pointLight : mPointLights)
-		{
-			meshShader.second->GetLightingConstants().mPointLights[i] = pointLight->GetData();
-			i++;
-		}
+		// Each light is read as 4 float4s
+		const size_t float4Size = sizeof(float) * 4;
+		UploadLightBuffer(mLightDataBuffer, EGF_R32G32B32A32_Float, float4Size,
+			mLightData.data(), mLightData.size() * sizeof(PointLightData) / float4Size);
+	}
 
-		// If less than 8 point lights, set the extra indices in the array as enabled = false
-		for ( ; i < 8; i++)
-		{
-			meshShader.second->GetLightingConstants().mPointLights[i] = PointLightData();
-		}
+	// The clusters are in view space, so they also have to be redone
+	// when the camera moves
+	if (snapshot.mLightsChanged || memcmp(&mClusterView, &snapshot.mView, sizeof(Matrix4)) != 0)
+	{
+		mLightClusters.Build(mLightData, snapshot.mView, mProj);
 
-		// Upload the lighting constants
-		meshShader.second->UploadLightingConstants();
+		const std::vector<LightClusters::Cluster>& clusters = mLightClusters.GetClusters();
+		UploadLightBuffer(mClusterBuffer, EGF_R32G32_UInt, sizeof(LightClusters::Cluster),
+			clusters.data(), clusters.size());
+
+		const std::vector<uint32_t>& indices = mLightClusters.GetLightIndices();
+		UploadLightBuffer(mLightIndexBuffer, EGF_R32_UInt, sizeof(uint32_t),
+			indices.data(), indices.size());
+
+		mClusterView = snapshot.mView;
+	}
+
+	// Slots 1-3 are only used for lights, so these stay bound
+	mGraphicsDriver->SetPSTexture(mLightDataBuffer.mView, 1);
+	mGraphicsDriver->SetPSTexture(mClusterBuffer.mView, 2);
+	mGraphicsDriver->SetPSTexture(mLightIndexBuffer.mView, 3);
+}
+
+void Renderer::UploadLightBuffer(LightBuffer& buffer, EGFormat format, size_t elementSize, const void* data, size_t count)
+{
+	// Grow the buffer if it's too small (it can't be empty, so it always has room for one)
+	if (!buffer.mBuffer || count > buffer.mCapacity)
+	{
+		buffer.mCapacity = max(max(count, buffer.mCapacity * 2), static_cast<size_t>(1));
+		buffer.mBuffer = mGraphicsDriver->CreateGraphicsBuffer(nullptr,
+			static_cast<int>(buffer.mCapacity * elementSize),
+			EBF_ShaderResource, ECPUAF_CanWrite, EGBU_Dynamic);
+		buffer.mView = mGraphicsDriver->CreateBufferView(buffer.mBuffer, format,
+			static_cast<uint32_t>(buffer.mCapacity));
+	}
+
+	if (count > 0)
+	{
+		void* mapped = mGraphicsDriver->MapBuffer(buffer.mBuffer);
+		memcpy(mapped, data, count * elementSize);
+		mGraphicsDriver->UnmapBuffer(buffer.mBuffer);
 	}
 }
 
 void Renderer::DrawSprite(TexturePtr texture, const Matrix4& worldTransform)
 {
-	// Set sprite shader active
-	mSpriteShader->SetActive();
+	// The whole texture, untinted
+	DrawSprite(texture, worldTransform, Vector2(0.0f, 0.0f), Vector2(1.0f, 1.0f), Vector3(1.0f, 1.0f, 1.0f));
+}
 
-	// Set world transform for sprite shader
-	mSpriteShader->GetPerObjectConstants().mWorldTransform = worldTransform;
+void Renderer::DrawSprite(TexturePtr texture, const Matrix4& worldTransform, const Vector2& uvMin, const Vector2& uvMax,
+	const Vector3& color)
+{
+	// Drawn by the render thread, after the meshes
+	RenderSnapshot::SpriteDraw sprite;
+	sprite.mTexture = texture;
+	sprite.mWorldTransform = worldTransform;
+	sprite.mUVMin = uvMin;
+	sprite.mUVMax = uvMax;
+	sprite.mColor = color;
+	mBuilding->mSprites.push_back(sprite);
+}
 
-	// Upload world transform for sprite shader to GPU
-	mSpriteShader->UploadPerObjectConstants();
+void Renderer::DrawMesh(VertexArrayPtr vertArray, TexturePtr texture, const Matrix4& worldTransform, EMeshShader type,
+	size_t lod, size_t startIndex, size_t indexCount)
+{
+	SubmitMesh(vertArray, texture, worldTransform, nullptr, type, lod, startIndex, indexCount);
+}
 
-	// Bind texture
-	mSpriteShader->BindTexture(texture, 0);
+void Renderer::DrawSkeletalMesh(VertexArrayPtr vertArray, TexturePtr texture, const Matrix4& worldTransform, const struct MatrixPalette& palette, EMeshShader type,
+	size_t lod, size_t startIndex, size_t indexCount)
+{
+	// The component keeps changing its palette, so the snapshot gets a copy
+	SubmitMesh(vertArray, texture, worldTransform, mBuilding->AddPalette(palette), type, lod, startIndex, indexCount);
+}
 
-	// Draw sprite vertices
-	DrawVertexArray(mSpriteVerts);
+void Renderer::SubmitMesh(VertexArrayPtr vertArray, TexturePtr texture, const Matrix4& worldTransform,
+	const struct MatrixPalette* palette, EMeshShader type, size_t lod, size_t startIndex, size_t indexCount)
+{
+	// Front to back within the same state, so the depth test rejects more
+	float depth = Transform(worldTransform.GetTranslation(), mView).z / kFarPlane;
+
+	RenderQueue::Command command;
+	command.mKey = RenderQueue::MakeKey(RenderQueue::EL_Opaque, type, texture.get(), vertArray.get(), lod, depth);
+	command.mVertexArray = vertArray;
+	command.mTexture = texture;
+	command.mWorldTransform = worldTransform;
+	command.mPalette = palette;
+	command.mShader = type;
+	command.mStartIndex = static_cast<uint32_t>(startIndex);
+	command.mIndexCount = static_cast<uint32_t>(indexCount);
+	mBuilding->mQueue.Submit(command);
 }
 
-void Renderer::DrawMesh(VertexArrayPtr vertArray, TexturePtr texture, const Matrix4& worldTransform, EMeshShader type)
+void Renderer::ExecuteRenderQueue(RenderSnapshot& snapshot)
 {
-	// Set active
-	mMeshShaders[type]->SetActive();
+	RenderQueue& queue = snapshot.mQueue;
+	queue.Sort();
+	UploadInstanceTransforms(queue);
+	ReserveDrawConstants(queue);
+
+	// Record the batches in chunks across the job system, each chunk into
+	// its own command list. The recording jobs also fill in the frame
+	// constants, which is safe since every batch has its own ranges.
+	const std::vector<RenderQueue::Batch>& batches = queue.GetBatches();
+	size_t numLists = (batches.size() + kBatchesPerCommandList - 1) / kBatchesPerCommandList;
+	if (mCommandLists.size() < numLists)
+	{
+		mCommandLists.resize(numLists);
+	}
+	mGame.GetJobSystem().ParallelFor(numLists, 1, [this, &queue, &batches](size_t firstList, size_t lastList)
+	{
+		for (size_t l = firstList; l < lastList; l++)
+		{
+			size_t first = l * kBatchesPerCommandList;
+			size_t last = min(first + kBatchesPerCommandList, batches.size());
+			RecordBatches(queue, mCommandLists[l], first, last);
+		}
+	});
+
+	if (mFrameConstants && mFrameConstants->IsMapped())
+	{
+		mFrameConstants->End();
+	}
 
-	// Set world transform for basic mesh shader
-	mMeshShaders[type]->GetPerObjectConstants().mWorldTransform = worldTransform;
+	// Then play them back in order
+	snapshot.mNumCommandLists = numLists;
+	snapshot.mNumCommands = 0;
+	for (size_t l = 0; l < numLists; l++)
+	{
+		ExecuteCommandList(queue, mCommandLists[l]);
+		snapshot.mNumCommands += mCommandLists[l].GetCommands().size();
+	}
+}
+
+void Renderer::RecordBatches(const RenderQueue& queue, CommandList& list, size_t first, size_t last) const
+{
+	list.Clear();
 
-	// Upload world transform for basic mesh shader to GPU
-	mMeshShaders[type]->UploadPerObjectConstants();
+	const std::vector<RenderQueue::Batch>& batches = queue.GetBatches();
+	for (size_t i = first; i < last; i++)
+	{
+		const RenderQueue::Batch& batch = batches[i];
+		const RenderQueue::Command& command = queue.GetSorted(batch.mFirst);
+		EMeshShader type = batch.mIsInstanced ? RenderQueue::GetInstancedShader(command.mShader) : command.mShader;
+		list.SetShader(mMeshShaders.find(type)->second.get());
+
+		// Instanced batches get their transforms from the instance buffer,
+		// everything else needs its per object constants
+		if (!batch.mIsInstanced && mFrameConstants)
+		{
+			const DrawConstants& constants = mDrawConstants[i];
+			Shader::PerObjectConstants perObject;
+			perObject.mWorldTransform = command.mWorldTransform;
+			perObject.mPositionScale = command.mVertexArray->GetPositionScale();
+			perObject.mPositionOffset = command.mVertexArray->GetPositionOffset();
+			mFrameConstants->Write(constants.mPerObject, &perObject, sizeof(perObject));
+			list.SetConstantRange(1, constants.mPerObject.mFirstConstant, constants.mPerObject.mNumConstants);
+
+			// Only as many bones as the skeleton has
+			if (command.mPalette)
+			{
+				mFrameConstants->Write(constants.mPalette, command.mPalette->mMatrixPalette,
+					command.mPalette->mNumBones * sizeof(SimdMatrix4));
+				list.SetConstantRange(3, constants.mPalette.mFirstConstant, constants.mPalette.mNumConstants);
+			}
+		}
+		else if (!batch.mIsInstanced)
+		{
+			list.UploadObjectConstants(batch.mFirst);
+		}
 
-	// Bind texture
-	mMeshShaders[type]->BindTexture(texture, 0);
+		list.SetTexture(command.mTexture.get());
+		list.SetVertexArray(command.mVertexArray.get(), batch.mIsInstanced);
 
-	// Draw vertex array
-	DrawVertexArray(vertArray);
+		if (batch.mIsInstanced)
+		{
+			list.DrawIndexedInstanced(command.mIndexCount, command.mStartIndex, batch.mCount, batch.mFirstInstance);
+		}
+		else
+		{
+			list.DrawIndexed(command.mIndexCount, command.mStartIndex);
+		}
+	}
 }
 
-void Renderer::DrawSkeletalMesh(VertexArrayPtr vertArray, TexturePtr texture, const Matrix4& worldTransform, const struct MatrixPalette& palette)
+void Renderer::ExecuteCommandList(const RenderQueue& queue, const CommandList& list)
 {
-	// Set active
-	mMeshShaders[EMS_Skinned]->SetActive();
+	Shader* shader = nullptr;
+	for (const auto& command : list.GetCommands())
+	{
+		switch (command.mType)
+		{
+		case CommandList::ET_SetShader:
+			shader = static_cast<Shader*>(command.mObject);
+			shader->SetActive();
+			break;
+		case CommandList::ET_SetTexture:
+			static_cast<Texture*>(command.mObject)->SetActive(0);
+			break;
+		case CommandList::ET_SetVertexArray:
+			static_cast<VertexArray*>(command.mObject)->SetActive();
+			break;
+		case CommandList::ET_SetInstanceStream:
+			// Swap in the layout that also reads the instance buffer
+			mGraphicsDriver->SetInputLayout(mInstancedLayout);
+			mGraphicsDriver->SetVertexBuffer(mInstanceBuffer, sizeof(Matrix4), 1);
+			break;
+		case CommandList::ET_SetConstantRange:
+			mGraphicsDriver->SetVSConstantBufferRange(mFrameConstants->GetBuffer(), command.mArgs[0],
+				command.mArgs[1], command.mArgs[2]);
+			break;
+		case CommandList::ET_UploadObjectConstants:
+		{
+			const RenderQueue::Command& draw = queue.GetSorted(command.mArgs[0]);
+			Shader::PerObjectConstants& perObject = shader->GetPerObjectConstants();
+			perObject.mWorldTransform = draw.mWorldTransform;
+			perObject.mPositionScale = draw.mVertexArray->GetPositionScale();
+			perObject.mPositionOffset = draw.mVertexArray->GetPositionOffset();
+			shader->UploadPerObjectConstants();
+
+			if (draw.mPalette)
+			{
+				shader->UploadMatrixPalette(*draw.mPalette);
+			}
+			break;
+		}
+		case CommandList::ET_DrawIndexed:
+			mGraphicsDriver->DrawIndexed(command.mArgs[0], command.mArgs[1], 0);
+			break;
+		case CommandList::ET_DrawIndexedInstanced:
+			mGraphicsDriver->DrawIndexedInstanced(command.mArgs[0], command.mArgs[2],
+				command.mArgs[1], 0, command.mArgs[3]);
+			break;
+		}
+	}
+}
 
-	// Set world transform for skinned mesh shader to GPU
-	mMeshShaders[EMS_Skinned]->GetPerObjectConstants().mWorldTransform = worldTransform;
+void Renderer::ReserveDrawConstants(const RenderQueue& queue)
+{
+	if (!mFrameConstants)
+	{
+		return;
+	}
 
-	// Upload world transform for skinned mesh shader to GPU
-	mMeshShaders[EMS_Skinned]->UploadPerObjectConstants();
+	const std::vector<RenderQueue::Batch>& batches = queue.GetBatches();
+	mDrawConstants.resize(batches.size());
 
-	// Upload matrix palette for skinned mesh shader to GPU
-	mMeshShaders[EMS_Skinned]->UploadMatrixPalette(palette);
+	// Work out how much space this frame needs, so it's mapped just once
+	size_t size = 0;
+	for (const auto& batch : batches)
+	{
+		const RenderQueue::Command& command = queue.GetSorted(batch.mFirst);
+		if (!batch.mIsInstanced)
+		{
+			size += FrameConstantBuffer::GetAllocationSize(sizeof(Shader::PerObjectConstants));
+			if (command.mPalette)
+			{
+				size += FrameConstantBuffer::GetAllocationSize(command.mPalette->mNumBones * sizeof(SimdMatrix4));
+			}
+		}
+	}
+	if (size == 0)
+	{
+		return;
+	}
 
-	// Bind texture
-	mMeshShaders[EMS_Skinned]->BindTexture(texture, 0);
+	// Hand out the ranges now, and let RecordBatches fill them in
+	mFrameConstants->Begin(size);
+	for (size_t i = 0; i < batches.size(); i++)
+	{
+		const RenderQueue::Command& command = queue.GetSorted(batches[i].mFirst);
+		if (batches[i].mIsInstanced)
+		{
+			continue;
+		}
 
-	// Draw vertex array
-	DrawVertexArray(vertArray);
+		mDrawConstants[i].mPerObject = mFrameConstants->Reserve(sizeof(Shader::PerObjectConstants));
+		if (command.mPalette)
+		{
+			mDrawConstants[i].mPalette = mFrameConstants->Reserve(command.mPalette->mNumBones * sizeof(SimdMatrix4));
+		}
+	}
 }
 
-void Renderer::DrawVertexArray(VertexArrayPtr vertArray)
+void Renderer::UploadInstanceTransforms(const RenderQueue& queue)
 {
-	// Set vertex array as active
-	vertArray->SetActive();
+	const std::vector<Matrix4>& transforms = queue.GetInstanceTransforms();
+	if (transforms.empty())
+	{
+		return;
+	}
+
+	// Grow the buffer if it's too small for this frame
+	if (transforms.size() > mInstanceCapacity)
+	{
+		mInstanceCapacity = max(transforms.size(), mInstanceCapacity * 2);
+		mInstanceBuffer = mGraphicsDriver->CreateGraphicsBuffer(nullptr,
+			static_cast<int>(mInstanceCapacity * sizeof(Matrix4)),
+			EBF_VertexBuffer, ECPUAF_CanWrite, EGBU_Dynamic);
+	}
 
-	// Draw indexed vertices
-	mGraphicsDriver->DrawIndexed(vertArray->GetIndexCount(), 0, 0);
+	void* data = mGraphicsDriver->MapBuffer(mInstanceBuffer);
+	memcpy(data, transforms.data(), transforms.size() * sizeof(Matrix4));
+	mGraphicsDriver->UnmapBuffer(mInstanceBuffer);
 }
 
 void Renderer::UpdateViewMatrix(const Matrix4& view)
 {
-	// Set view
+	// Set view (the shaders get it from the snapshot)
 	mView = view;
-
-	for (auto meshShader : mMeshShaders)
-	{
-		// Get view projection matrix
-		Matrix4 viewProjection = mView * mProj;
-
-		// Set per-camera constants
-		meshShader.second->GetPerCameraConstants().mViewProjection = viewProjection;
-		meshShader.second->GetPerCameraConstants().mWorldCameraPosition = mView.GetTranslation();
-	}
 }
 
 void Renderer::SetAmbientLight(const Vector3& color)
 {
-	for (auto meshShader : mMeshShaders)
-	{
-		meshShader.second->GetLightingConstants().mAmbientLight = color;
-		meshShader.second->UploadLightingConstants();
-	}
+	// Goes out with the next snapshot
+	mAmbientLight = color;
+	mAmbientLightDirty = true;
 }
 
 Vector3 Renderer::Unproject(const Vector3& screenPoint) const
@@ -253,14 +566,45 @@ Vector3 Renderer::Unproject(const Vector3& screenPoint) const
 	unprojection.Invert();
 	Vector3 unprojVec = TransformWithPerspDiv(deviceCoord, unprojection);
 
-	// Now undo the view matrix
-	Matrix4 uncamera = mView;
-	uncamera.Invert();
-	return Transform(unprojVec, uncamera);
+	// Now undo the view matrix, which is affine, so it doesn't need the full inverse
+	SimdMatrix4 uncamera(mView);
+	uncamera.InvertAffine();
+	return Transform(unprojVec, uncamera.ToMatrix4());
+}
+
+void Renderer::LogStats() const
+{
+	SDL_Log("Renderer: %u tested, %u culled, %u unbounded",
+		static_cast<unsigned>(mCullStats.mNumTested),
+		static_cast<unsigned>(mCullStats.mNumCulled),
+		static_cast<unsigned>(mCullStats.mNumUnbounded));
+	SDL_Log("  Queue: %u draws in %u calls (%u instanced)",
+		static_cast<unsigned>(mQueueStats.mNumDraws),
+		static_cast<unsigned>(mQueueStats.mNumDrawCalls),
+		static_cast<unsigned>(mQueueStats.mNumInstanced));
+	SDL_Log("  Changes unsorted/sorted: %u/%u shaders, %u/%u textures, %u/%u vertex arrays",
+		static_cast<unsigned>(mQueueStats.mUnsorted.mShaders),
+		static_cast<unsigned>(mQueueStats.mSorted.mShaders),
+		static_cast<unsigned>(mQueueStats.mUnsorted.mTextures),
+		static_cast<unsigned>(mQueueStats.mSorted.mTextures),
+		static_cast<unsigned>(mQueueStats.mUnsorted.mVertexArrays),
+		static_cast<unsigned>(mQueueStats.mSorted.mVertexArrays));
+	SDL_Log("  Commands: %u in %u lists",
+		static_cast<unsigned>(mCommandStats.mNumCommands),
+		static_cast<unsigned>(mCommandStats.mNumLists));
+	SDL_Log("  Sprites: %u in %u calls",
+		static_cast<unsigned>(mSpriteStats.mNumSprites),
+		static_cast<unsigned>(mSpriteStats.mNumDrawCalls));
+	SDL_Log("  State changes: %u sent to the device, %u filtered as redundant",
+		static_cast<unsigned>(mStateStats.mNumIssued),
+		static_cast<unsigned>(mStateStats.mNumFiltered));
 }
 
 void Renderer::Clear()
 {
+	// State change counts are per frame
+	mGraphicsDriver->ResetStateStats();
+
 	// Clear the back buffer black with an alpha of 1
 	mGraphicsDriver->ClearBackBuffer(Vector3(), 1.0f);
 
@@ -268,42 +612,156 @@ void Renderer::Clear()
 	mGraphicsDriver->ClearDepthStencil(mDepthBuffer, 1.0f);
 }
 
-void Renderer::DrawComponents()
+void Renderer::BuildSnapshot(RenderSnapshot& snapshot)
+{
+	// This snapshot was last drawn two frames ago, so these lag a bit
+	mQueueStats = snapshot.mQueue.GetStats();
+	mCommandStats.mNumLists = snapshot.mNumCommandLists;
+	mCommandStats.mNumCommands = snapshot.mNumCommands;
+	mSpriteStats.mNumSprites = snapshot.mSprites.size();
+	mSpriteStats.mNumDrawCalls = snapshot.mNumSpriteDrawCalls;
+	mStateStats.mNumIssued = snapshot.mNumStatesIssued;
+	mStateStats.mNumFiltered = snapshot.mNumStatesFiltered;
+
+	snapshot.Clear();
+	snapshot.mView = mView;
+
+	// Only copy the lights if one of them changed
+	for (auto& pointLight : mPointLights)
+	{
+		if (pointLight->IsDirty())
+		{
+			mLightsDirty = true;
+			pointLight->ClearDirty();
+		}
+	}
+
+	if (mLightsDirty)
+	{
+		for (auto& pointLight : mPointLights)
+		{
+			snapshot.mLights.push_back(pointLight->GetData());
+		}
+		snapshot.mLightsChanged = true;
+		mLightsDirty = false;
+	}
+
+	if (mAmbientLightDirty)
+	{
+		snapshot.mAmbientLight = mAmbientLight;
+		snapshot.mAmbientLightChanged = true;
+		mAmbientLightDirty = false;
+	}
+
+	// Gather the local bounds of everything that has them, and draw the rest
+	mCullComponents.clear();
+	mCullLocalBoxes.Clear();
+	mCullTransforms.clear();
+	mCullStats.mNumUnbounded = 0;
+	for (auto& comp : mDrawComponents)
+	{
+		if (comp->IsVisible())
+		{
+			Collision::AxisAlignedBox bounds;
+			if (comp->GetLocalBounds(bounds))
+			{
+				mCullComponents.push_back(comp.get());
+				mCullLocalBoxes.Add(bounds);
+				mCullTransforms.push_back(comp->GetOwner().GetWorldTransform());
+			}
+			else
+			{
+				comp->Draw(*this);
+				mCullStats.mNumUnbounded++;
+			}
+		}
+	}
+
+	// Move them all into world space at once
+	Collision::TransformBoxes(mCullLocalBoxes, mCullTransforms.data(), mCullBoxes);
+
+	// Only draw what's in the camera's frustum
+	Collision::Frustum frustum;
+	frustum.ExtractFromMatrix(mView * mProj);
+	size_t numVisible = Collision::CullBoxes(frustum, mCullBoxes, mCullVisible);
+	mCullStats.mNumTested = mCullComponents.size();
+	mCullStats.mNumCulled = mCullComponents.size() - numVisible;
+	for (size_t i = 0; i < mCullComponents.size(); i++)
+	{
+		if (mCullVisible[i])
+		{
+			mCullComponents[i]->Draw(*this);
+		}
+	}
+
+	// The 2D components
+	for (auto& comp : mComponents2D)
+	{
+		if (comp->IsVisible())
+		{
+			comp->Draw(*this);
+		}
+	}
+}
+
+void Renderer::DrawSnapshot(RenderSnapshot& snapshot)
 {
+	Clear();
+
 	// Enable depth buffering and disable blending
 	mGraphicsDriver->SetDepthStencilState(mMeshDepthState);
 	mGraphicsDriver->SetBlendState(mMeshBlendState);
 
 	// Upload per camera constants
+	Matrix4 viewProjection = snapshot.mView * mProj;
+	Vector3 cameraPosition = snapshot.mView.GetTranslation();
 	for (auto meshShader : mMeshShaders)
 	{
+		meshShader.second->GetPerCameraConstants().mViewProjection = viewProjection;
+		meshShader.second->GetPerCameraConstants().mWorldCameraPosition = cameraPosition;
 		meshShader.second->UploadPerCameraConstants();
 	}
 
-	// Update point lights
-	UpdatePointLights();
-
-	// Draw the normal components
-	for (auto& comp : mDrawComponents)
+	if (snapshot.mAmbientLightChanged)
 	{
-		if (comp->IsVisible())
+		for (auto meshShader : mMeshShaders)
 		{
-			comp->Draw(*this);
+			meshShader.second->GetLightingConstants().mAmbientLight = snapshot.mAmbientLight;
+			meshShader.second->UploadLightingConstants();
 		}
 	}
 
+	// Update point lights
+	UpdatePointLights(snapshot);
+
+	// The components only queued their meshes, so now draw them in order
+	ExecuteRenderQueue(snapshot);
+
 	// Disable depth buffering and enable blending
 	mGraphicsDriver->SetDepthStencilState(mSpriteDepthState);
 	mGraphicsDriver->SetBlendState(mSpriteBlendState);
 
-	// Draw the 2D components
-	for (auto& comp : mComponents2D)
+	// The 2D components come out of an unordered_set, so they never had
+	// a draw order to keep
+	snapshot.SortSprites();
+
+	// Draw the 2D components. The quads are transformed on the CPU, so
+	// the sprite shader's world transform stays at identity.
+	mSpriteShader->SetActive();
+	mSpriteShader->GetPerObjectConstants().mWorldTransform = Matrix4::Identity;
+	mSpriteShader->UploadPerObjectConstants();
+
+	mSpriteBatch->Begin();
+	for (const auto& sprite : snapshot.mSprites)
 	{
-		if (comp->IsVisible())
-		{
-			comp->Draw(*this);
-		}
+		mSpriteBatch->Add(sprite.mTexture, sprite.mWorldTransform, sprite.mUVMin, sprite.mUVMax, sprite.mColor);
 	}
+	mSpriteBatch->End();
+	snapshot.mNumSpriteDrawCalls = mSpriteBatch->GetStats().mNumDrawCalls;
+	snapshot.mNumStatesIssued = mGraphicsDriver->GetStateStats().mNumIssued;
+	snapshot.mNumStatesFiltered = mGraphicsDriver->GetStateStats().mNumFiltered;
+
+	Present();
 }
 
 void Renderer::Present()
@@ -311,6 +769,27 @@ void Renderer::Present()
 	mGraphicsDriver->Present();
 }
 
+bool Renderer::InitLightClusters()
+{
+	mLightClusters.Init(mWidth, mHeight, kNearPlane, kFarPlane);
+
+	// Tell the lit shaders how to find a pixel's cluster
+	for (auto meshShader : mMeshShaders)
+	{
+		Shader::LightingConstants& lighting = meshShader.second->GetLightingConstants();
+		lighting.mTileSize = LightClusters::kTileSize;
+		lighting.mNumTilesX = mLightClusters.GetNumTilesX();
+		lighting.mNumTilesY = mLightClusters.GetNumTilesY();
+		lighting.mNumSlices = LightClusters::kNumSlices;
+		lighting.mSliceScale = mLightClusters.GetSliceScale();
+		lighting.mSliceBias = mLightClusters.GetSliceBias();
+		meshShader.second->UploadLightingConstants();
+	}
+
+	mLightsDirty = true;
+	return true;
+}
+
 bool Renderer::InitFrameBuffer()
 {
 	// Render solid
@@ -338,7 +817,7 @@ bool Renderer::InitShaders()
 {
 	// Load sprite shader
 	{
-		mSpriteShader = mGame.GetAssetCache().Load<Shader>("Shaders/Sprite.hlsl");
+		mSpriteShader = mGame.GetAssetCache().Load<Shader>(ASSET_PATH("Shaders/Sprite.hlsl"));
 		if (!mSpriteShader)
 			return false;
 
@@ -346,12 +825,13 @@ bool Renderer::InitShaders()
 		InputLayoutElement spriteShaderILE[] = {
 			{ "POSITION", 0, EGF_R32G32B32_Float, 0 },
 			{ "TEXCOORD", 0, EGF_R32G32_Float, sizeof(float) * 3 },
+			{ "COLOR", 0, EGF_R8G8B8A8_UNorm, sizeof(float) * 5 },
 		};
 
-		// Create and register input layout as "positiontexcoord"
-		mInputLayoutCache->RegisterLayout("positiontexcoord",
+		// Create and register input layout as "positiontexcoordcolor"
+		mInputLayoutCache->RegisterLayout("positiontexcoordcolor",
 			mGraphicsDriver->CreateInputLayout(
-				spriteShaderILE, 2,
+				spriteShaderILE, 3,
 				mSpriteShader->GetCompiledVS()
 			)
 		);
@@ -368,10 +848,10 @@ bool Renderer::InitShaders()
 	{
 		// Set projection matrix
 		mProj = Matrix4::CreatePerspectiveFOV(Math::ToRadians(70.0f),
-			static_cast<float>(mWidth), static_cast<float>(mHeight), 25.0f, 10000.0f);
+			static_cast<float>(mWidth), static_cast<float>(mHeight), kNearPlane, kFarPlane);
 
 		// Load basic mesh shader
-		mMeshShaders[EMS_Basic] = mGame.GetAssetCache().Load<Shader>("Shaders/BasicMesh.hlsl");
+		mMeshShaders[EMS_Basic] = mGame.GetAssetCache().Load<Shader>(ASSET_PATH("Shaders/BasicMesh.hlsl"));
 
 		// Array of InputLayoutElements for basic mesh shader
 		InputLayoutElement basicMeshShaderILE[] = {
@@ -393,10 +873,10 @@ bool Renderer::InitShaders()
 	{
 		// Set projection matrix
 		mProj = Matrix4::CreatePerspectiveFOV(Math::ToRadians(70.0f),
-			static_cast<float>(mWidth), static_cast<float>(mHeight), 25.0f, 10000.0f);
+			static_cast<float>(mWidth), static_cast<float>(mHeight), kNearPlane, kFarPlane);
 
 		// Load basic mesh shader
-		mMeshShaders[EMS_Phong] = mGame.GetAssetCache().Load<Shader>("Shaders/Phong.hlsl");
+		mMeshShaders[EMS_Phong] = mGame.GetAssetCache().Load<Shader>(ASSET_PATH("Shaders/Phong.hlsl"));
 
 		// Array of InputLayoutElements for basic mesh shader
 		InputLayoutElement phongShaderILE[] = {
@@ -418,10 +898,10 @@ bool Renderer::InitShaders()
 	{
 		// Set projection matrix
 		mProj = Matrix4::CreatePerspectiveFOV(Math::ToRadians(70.0f),
-			static_cast<float>(mWidth), static_cast<float>(mHeight), 25.0f, 10000.0f);
+			static_cast<float>(mWidth), static_cast<float>(mHeight), kNearPlane, kFarPlane);
 
 		// Load skinned mesh shader
-		mMeshShaders[EMS_Skinned] = mGame.GetAssetCache().Load<Shader>("Shaders/Skinned.hlsl");
+		mMeshShaders[EMS_Skinned] = mGame.GetAssetCache().Load<Shader>(ASSET_PATH("Shaders/Skinned.hlsl"));
 		mMeshShaders[EMS_Skinned]->CreateMatrixPaletteBuffer();
 
 		// Array of InputLayoutElements for skinned mesh shader
@@ -442,28 +922,74 @@ bool Renderer::InitShaders()
 		);
 	}
 
-	return true;
-}
-
-bool Renderer::InitSpriteVerts()
-{
-	// Create the vertex array for sprites
-	float verts[] =
+	// Load the instanced versions of the basic and phong shaders
 	{
-		-0.5f, 0.5f, 0.0f, 0.0f, 0.0f,  // top left
-		0.5f, 0.5f, 0.0f, 1.0f, 0.0f,   // top right
-		0.5f, -0.5f, 0.0f, 1.0f, 1.0f,  // bottom right
-		-0.5f, -0.5f, 0.0f, 0.0f, 1.0f, // bottom left
-	};
+		mMeshShaders[EMS_BasicInstanced] = mGame.GetAssetCache().Load<Shader>(ASSET_PATH("Shaders/BasicMeshInstanced.hlsl"));
+		mMeshShaders[EMS_PhongInstanced] = mGame.GetAssetCache().Load<Shader>(ASSET_PATH("Shaders/PhongInstanced.hlsl"));
+
+		// Same vertices as positionnormaltexcoord, then a world
+		// transform per instance from slot 1
+		InputLayoutElement instancedILE[] = {
+			{ "POSITION", 0, EGF_R32G32B32_Float, 0 },
+			{ "NORMAL", 0, EGF_R32G32B32_Float, sizeof(float) * 3 },
+			{ "TEXCOORD", 0, EGF_R32G32_Float, sizeof(float) * 6 },
+			{ "WORLD", 0, EGF_R32G32B32A32_Float, 0, 1, EIC_PerInstance, 1 },
+			{ "WORLD", 1, EGF_R32G32B32A32_Float, sizeof(float) * 4, 1, EIC_PerInstance, 1 },
+			{ "WORLD", 2, EGF_R32G32B32A32_Float, sizeof(float) * 8, 1, EIC_PerInstance, 1 },
+			{ "WORLD", 3, EGF_R32G32B32A32_Float, sizeof(float) * 12, 1, EIC_PerInstance, 1 },
+		};
 
-	uint16_t indices[] =
+		mInstancedLayout = mGraphicsDriver->CreateInputLayout(
+			instancedILE, 7,
+			mMeshShaders[EMS_PhongInstanced]->GetCompiledVS()
+		);
+	}
+
+	// Load the quantized versions of the mesh shaders
+	// Positions are 16-bit unorm (padded to 4), normals are octahedral
+	// 16-bit snorm, texcoords are half floats
 	{
-		0, 1, 2, // <top left, top right, bottom right>
-		2, 3, 0, // <bottom right, bottom left, top left>
-	};
+		mMeshShaders[EMS_BasicQuantized] = mGame.GetAssetCache().Load<Shader>(ASSET_PATH("Shaders/BasicMeshQuantized.hlsl"));
+		mMeshShaders[EMS_PhongQuantized] = mGame.GetAssetCache().Load<Shader>(ASSET_PATH("Shaders/PhongQuantized.hlsl"));
+		mMeshShaders[EMS_SkinnedQuantized] = mGame.GetAssetCache().Load<Shader>(ASSET_PATH("Shaders/SkinnedQuantized.hlsl"));
+		mMeshShaders[EMS_SkinnedQuantized]->CreateMatrixPaletteBuffer();
+
+		InputLayoutElement quantizedILE[] = {
+			{ "POSITION", 0, EGF_R16G16B16A16_UNorm, 0 },
+			{ "NORMAL", 0, EGF_R16G16_SNorm, sizeof(uint16_t) * 4 },
+			{ "TEXCOORD", 0, EGF_R16G16_Float, sizeof(uint16_t) * 6 },
+		};
+
+		mInputLayoutCache->RegisterLayout("qpositionnormaltexcoord",
+			mGraphicsDriver->CreateInputLayout(
+				quantizedILE, 3,
+				mMeshShaders[EMS_PhongQuantized]->GetCompiledVS()
+			)
+		);
+
+		InputLayoutElement skinnedQuantizedILE[] = {
+			{ "POSITION", 0, EGF_R16G16B16A16_UNorm, 0 },
+			{ "NORMAL", 0, EGF_R16G16_SNorm, sizeof(uint16_t) * 4 },
+			{ "BONES", 0, EGF_R8G8B8A8_UInt, sizeof(uint16_t) * 6 },
+			{ "WEIGHTS", 0, EGF_R8G8B8A8_UNorm, sizeof(uint16_t) * 6 + sizeof(char) * 4 },
+			{ "TEXCOORD", 0, EGF_R16G16_Float, sizeof(uint16_t) * 6 + sizeof(char) * 8 },
+		};
+
+		mInputLayoutCache->RegisterLayout("qpositionnormalbonesweightstexcoord",
+			mGraphicsDriver->CreateInputLayout(
+				skinnedQuantizedILE, 5,
+				mMeshShaders[EMS_SkinnedQuantized]->GetCompiledVS()
+			)
+		);
+	}
 
-	mSpriteVerts = VertexArray::Create(GetGraphicsDriver(), GetInputLayoutCache(),
-		verts, 4, 20, "positiontexcoord", indices, 6);
+	return true;
+}
+
+bool Renderer::InitSpriteBatch()
+{
+	mSpriteBatch = std::make_shared<SpriteBatch>();
+	mSpriteBatch->Init(*mGraphicsDriver, mInputLayoutCache->GetLayout("positiontexcoordcolor"));
 
 	return true;
 }
@@ -1,10 +1,16 @@
 // Render.h
 // Tracks all the active draw components and renders
 // the scene
+// Each frame the main thread copies what's visible into a RenderSnapshot,
+// and a render thread draws it while the game simulates the next frame.
+// Only the render thread uses the device context once Init is done.
 
 #pragma once
 #include <SDL/SDL.h>
 #include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "DrawComponent.h"
 #include "Shader.h"
 #include "VertexArray.h"
@@ -14,15 +20,42 @@
 #include "InputLayoutCache.h"
 #include "PointLightComponent.h"
 #include "ShaderTypes.h"
+#include "CollisionHelpers.h"
+#include "RenderQueue.h"
+#include "FrameConstantBuffer.h"
+#include "LightClusters.h"
+#include "CommandList.h"
+#include "RenderSnapshot.h"
+#include "SpriteBatch.h"
 
 class Renderer
 {
 public:
+	// What frustum culling did last frame
+	struct CullStats
+	{
+		// Components with bounds that were tested
+		size_t mNumTested;
+		// ...and how many of those were off screen
+		size_t mNumCulled;
+		// Components without bounds, which are always drawn
+		size_t mNumUnbounded;
+	};
+
+	// How the render queue was recorded (a couple of frames back)
+	struct CommandStats
+	{
+		size_t mNumLists;
+		size_t mNumCommands;
+	};
+
 	Renderer(class Game& game);
 	~Renderer();
 
 	bool Init(int width, int height);
 
+	// Snapshots the scene and hands it to the render thread. Blocks if
+	// the render thread is still on the previous frame.
 	void RenderFrame();
 
 	void AddComponent(DrawComponentPtr component);
@@ -34,12 +67,23 @@ public:
 	int GetWidth() const { return mWidth; }
 	int GetHeight() const { return mHeight; }
 
+	// Called by the components while the snapshot is built
 	void DrawSprite(TexturePtr texture, const Matrix4& worldTransform);
-	void DrawMesh(VertexArrayPtr vertArray, TexturePtr texture, const Matrix4& worldTransform, EMeshShader type = EMS_Basic);
-	void DrawSkeletalMesh(VertexArrayPtr vertArray, TexturePtr texture, const Matrix4& worldTransform, const struct MatrixPalette& palette);
-	void DrawVertexArray(VertexArrayPtr vertArray);
+	// Draws the [uvMin, uvMax] part of texture, multiplied by color
+	void DrawSprite(TexturePtr texture, const Matrix4& worldTransform, const Vector2& uvMin, const Vector2& uvMax,
+		const Vector3& color);
+	// The mesh draws go into the render queue, which is sorted and drawn
+	// once all the components have submitted theirs
+	// They take the LOD and its range of the index buffer, since a mesh's
+	// index buffer holds all of its LODs back to back
+	void DrawMesh(VertexArrayPtr vertArray, TexturePtr texture, const Matrix4& worldTransform, EMeshShader type,
+		size_t lod, size_t startIndex, size_t indexCount);
+	void DrawSkeletalMesh(VertexArrayPtr vertArray, TexturePtr texture, const Matrix4& worldTransform, const struct MatrixPalette& palette, EMeshShader type,
+		size_t lod, size_t startIndex, size_t indexCount);
 
 	void UpdateViewMatrix(const Matrix4& view);
+	const Matrix4& GetViewMatrix() const { return mView; }
+	const Matrix4& GetProjectionMatrix() const { return mProj; }
 	void SetAmbientLight(const Vector3& color);
 
 	// Given a screen space point, unprojects it into world space,
@@ -50,18 +94,50 @@ public:
 	// z = [0, 1] -- 0 means near plane, 1 means far plane
 	Vector3 Unproject(const Vector3& screenPoint) const;
 
+	const CullStats& GetCullStats() const { return mCullStats; }
+	const RenderQueue::Stats& GetQueueStats() const { return mQueueStats; }
+	const CommandStats& GetCommandStats() const { return mCommandStats; }
+	const SpriteBatch::Stats& GetSpriteStats() const { return mSpriteStats; }
+	// The driver's counts, copied out of the snapshot since the render
+	// thread is the one that writes them
+	const GraphicsDriver::StateStats& GetStateStats() const { return mStateStats; }
+	// SDL_Logs all of the above
+	void LogStats() const;
+
 	GraphicsDriver& GetGraphicsDriver() { return *mGraphicsDriver; }
 	InputLayoutCache& GetInputLayoutCache() { return *mInputLayoutCache; }
 private:
+	// Main thread: culls the components and has the visible ones draw into snapshot
+	void BuildSnapshot(RenderSnapshot& snapshot);
+
+	// Render thread: waits for snapshots and draws them
+	void RenderThreadLoop();
+	void DrawSnapshot(RenderSnapshot& snapshot);
 	void Clear();
-	void DrawComponents();
 	void Present();
 
 	bool InitFrameBuffer();
 	bool InitShaders();
-	bool InitSpriteVerts();
-
-	void UpdatePointLights();
+	bool InitSpriteBatch();
+	bool InitLightClusters();
+
+	// Uploads the point lights if any changed, and reassigns them to
+	// clusters if they or the camera moved
+	void UpdatePointLights(const RenderSnapshot& snapshot);
+
+	// Adds a mesh draw to the snapshot's render queue
+	void SubmitMesh(VertexArrayPtr vertArray, TexturePtr texture, const Matrix4& worldTransform,
+		const struct MatrixPalette* palette, EMeshShader type, size_t lod, size_t startIndex, size_t indexCount);
+	// Sorts the render queue and draws it, skipping redundant state changes
+	void ExecuteRenderQueue(RenderSnapshot& snapshot);
+	// Copies this frame's instance transforms into mInstanceBuffer
+	void UploadInstanceTransforms(const RenderQueue& queue);
+	// Maps mFrameConstants and gives every non-instanced batch its ranges
+	void ReserveDrawConstants(const RenderQueue& queue);
+	// Records batches [first, last) into list. Called from the job system,
+	// so it only writes to list and the batches' own constant ranges.
+	void RecordBatches(const RenderQueue& queue, CommandList& list, size_t first, size_t last) const;
+	void ExecuteCommandList(const RenderQueue& queue, const CommandList& list);
 
 	std::shared_ptr<GraphicsDriver> mGraphicsDriver;
 	std::shared_ptr<InputLayoutCache> mInputLayoutCache;
@@ -71,6 +147,84 @@ private:
 
 	std::unordered_set<PointLightComponentPtr> mPointLights;
 
+	// A buffer the pixel shaders read the lights through
+	struct LightBuffer
+	{
+		LightBuffer()
+			:mCapacity(0)
+		{
+		}
+
+		GraphicsBufferPtr mBuffer;
+		GraphicsTexturePtr mView;
+		// In elements
+		size_t mCapacity;
+	};
+	// Fills buffer with count elements, growing it if needed
+	void UploadLightBuffer(LightBuffer& buffer, EGFormat format, size_t elementSize, const void* data, size_t count);
+
+	// The render thread's copy of the lights
+	LightClusters mLightClusters;
+	std::vector<PointLightData> mLightData;
+	LightBuffer mLightDataBuffer;
+	LightBuffer mClusterBuffer;
+	LightBuffer mLightIndexBuffer;
+	// Set when a light is added or removed, cleared once the lights are in a snapshot
+	bool mLightsDirty;
+	// The view matrix the clusters were built for
+	Matrix4 mClusterView;
+
+	// Scratch space for culling, kept around so it doesn't reallocate
+	std::vector<DrawComponent*> mCullComponents;
+	Collision::BoxStreams mCullLocalBoxes;
+	std::vector<Matrix4> mCullTransforms;
+	Collision::BoxStreams mCullBoxes;
+	std::vector<uint8_t> mCullVisible;
+	CullStats mCullStats;
+
+	// Per-instance world transforms for instanced draws, refilled every frame
+	GraphicsBufferPtr mInstanceBuffer;
+	size_t mInstanceCapacity;
+	// positionnormaltexcoord, plus the instance transforms in slot 1
+	InputLayoutPtr mInstancedLayout;
+
+	// Where each batch's constants went in mFrameConstants
+	struct DrawConstants
+	{
+		FrameConstantBuffer::Range mPerObject;
+		FrameConstantBuffer::Range mPalette;
+	};
+	// Null if the device can't bind constant buffer ranges, in which
+	// case each draw uploads its constants to the shader's own buffers
+	std::shared_ptr<FrameConstantBuffer> mFrameConstants;
+	std::vector<DrawConstants> mDrawConstants;
+
+	// The render queue is recorded into these in parallel, then replayed in order
+	std::vector<CommandList> mCommandLists;
+	CommandStats mCommandStats;
+	RenderQueue::Stats mQueueStats;
+	SpriteBatch::Stats mSpriteStats;
+	GraphicsDriver::StateStats mStateStats;
+
+	// Set by SetAmbientLight, sent with the next snapshot
+	Vector3 mAmbientLight;
+	bool mAmbientLightDirty;
+
+	// One snapshot is being built while the other is drawn
+	RenderSnapshot mSnapshots[2];
+	RenderSnapshot* mBuilding;
+	// Guarded by mRenderMutex
+	RenderSnapshot* mPending;
+	bool mRendering;
+	bool mStopRenderThread;
+
+	std::thread mRenderThread;
+	std::mutex mRenderMutex;
+	// Signaled when there's a snapshot to draw (or it's time to stop)
+	std::condition_variable mRenderCV;
+	// Signaled when the render thread finishes a snapshot
+	std::condition_variable mIdleCV;
+
 	std::unordered_map<EMeshShader, ShaderPtr> mMeshShaders;
 
 	// View-projection matrix
@@ -92,7 +246,7 @@ private:
 	BlendStatePtr mMeshBlendState;
 
 	ShaderPtr mSpriteShader;
-	VertexArrayPtr mSpriteVerts;
+	std::shared_ptr<SpriteBatch> mSpriteBatch;
 
 	class Game& mGame;
 
@@ -0,0 +1,61 @@
+#include "ITPEnginePCH.h"
+#include "SelfTest.h"
+
+namespace
+{
+	int sNumChecks = 0;
+	int sNumFailures = 0;
+}
+
+void SelfTest::Check(bool condition, const char* expression, const char* file, int line)
+{
+	sNumChecks++;
+	if (!condition)
+	{
+		sNumFailures++;
+		SDL_Log("FAILED: %s (%s:%d)", expression, file, line);
+	}
+}
+
+bool SelfTest::IsNear(float a, float b, float tolerance)
+{
+	return Math::Abs(a - b) <= tolerance;
+}
+
+bool SelfTest::IsNear(const Matrix4& a, const Matrix4& b, float tolerance)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			if (!IsNear(a.mat[i][j], b.mat[i][j], tolerance))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int SelfTest::RunAll()
+{
+	sNumChecks = 0;
+	sNumFailures = 0;
+
+	// Fixed seed, so a failure can be reproduced
+	Random::Seed(1234);
+
+	RunMathTests();
+	RunCollisionTests();
+	RunVertexQuantizationTests();
+	RunMeshTests();
+	RunMeshOptimizerTests();
+	RunLightClustersTests();
+	RunCommandListTests();
+	RunRenderQueueTests();
+	RunSpriteBatchTests();
+	RunGlyphAtlasTests();
+
+	SDL_Log("Self test: %d checks, %d failed", sNumChecks, sNumFailures);
+	return sNumFailures;
+}
@@ -0,0 +1,43 @@
+// SelfTest.h
+// Headless checks for engine code that doesn't need a window or a
+// device. "Game -selftest" runs them all and exits with the number of
+// failed checks, so they can also run on a build machine.
+// Use SELF_CHECK inside the Run*Tests functions.
+
+#pragma once
+#include "Math.h"
+
+namespace SelfTest
+{
+	// Logs a failure if condition is false
+	void Check(bool condition, const char* expression, const char* file, int line);
+
+	bool IsNear(float a, float b, float tolerance);
+	bool IsNear(const Matrix4& a, const Matrix4& b, float tolerance);
+
+	// SIMD math against the scalar Matrix4 versions
+	void RunMathTests();
+	// Batched box transforms and frustum culling against brute force
+	void RunCollisionTests();
+	// Quantized vertices decoded the way the shaders decode them
+	void RunVertexQuantizationTests();
+	// Screen size and LOD selection
+	void RunMeshTests();
+	// Index reordering, dedup and simplification on generated grids
+	void RunMeshOptimizerTests();
+	// Light culling against every light at random points
+	void RunLightClustersTests();
+	// Command recording, on one thread and in parallel
+	void RunCommandListTests();
+	// Sort keys, the radix sort and batching
+	void RunRenderQueueTests();
+	// Sprite grouping by texture, without a device
+	void RunSpriteBatchTests();
+	// Glyph packing and UVs, without a font
+	void RunGlyphAtlasTests();
+
+	// Runs everything above, and returns the number of failed checks
+	int RunAll();
+}
+
+#define SELF_CHECK(expr) SelfTest::Check((expr), #expr, __FILE__, __LINE__)
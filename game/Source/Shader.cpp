@@ -41,7 +41,7 @@ void Shader::CreateMatrixPaletteBuffer()
 {
 	MatrixPalette matrixPalette;
 	mMatrixPaletteBuffer = mGraphicsDriver.CreateGraphicsBuffer(
-		&matrixPalette, sizeof(matrixPalette),
+		matrixPalette.mMatrixPalette, sizeof(matrixPalette.mMatrixPalette),
 		EBF_ConstantBuffer, ECPUAF_CanWrite, EGBU_Dynamic);
 }
 
@@ -68,8 +68,9 @@ void Shader::UploadLightingConstants()
 
 void Shader::UploadMatrixPalette(const struct MatrixPalette& palette)
 {
+	// The shader only reads the bones the skeleton has
 	void* buffer = mGraphicsDriver.MapBuffer(mMatrixPaletteBuffer);
-	memcpy(buffer, &palette, sizeof(palette));
+	memcpy(buffer, palette.mMatrixPalette, palette.mNumBones * sizeof(SimdMatrix4));
 	mGraphicsDriver.UnmapBuffer(mMatrixPaletteBuffer);
 }
 
@@ -109,3 +110,13 @@ bool Shader::Load(const char* fileName, class AssetCache* cache)
 
 	return true;
 }
+
+size_t Shader::GetMemorySize() const
+{
+	size_t size = sizeof(Shader) + mCompiledVS.capacity() + mCompiledPS.capacity();
+	if (mMatrixPaletteBuffer)
+	{
+		size += sizeof(MatrixPalette::mMatrixPalette);
+	}
+	return size;
+}
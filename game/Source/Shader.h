@@ -23,13 +23,25 @@ public:
 	struct PerObjectConstants
 	{
 		Matrix4 mWorldTransform;
+		// Undoes position quantization (see VertexArray)
+		Vector3 mPositionScale;
+		float mPadding0;
+		Vector3 mPositionOffset;
+		float mPadding1;
 	};
 	
+	// The point lights themselves are in buffers the Renderer binds,
+	// this just says how to find a pixel's cluster (see LightClusters)
 	struct LightingConstants
 	{
-		PointLightData mPointLights[8];
 		Vector3 mAmbientLight;
-		float mPadding;
+		uint32_t mTileSize;
+		uint32_t mNumTilesX;
+		uint32_t mNumTilesY;
+		uint32_t mNumSlices;
+		float mSliceScale;
+		float mSliceBias;
+		float mPadding[3];
 	};
 
 	Shader(class Game& game);
@@ -53,6 +65,7 @@ public:
 
 	const std::vector<char>& GetCompiledVS() const { return mCompiledVS; }
 	const std::vector<char>& GetCompiledPS() const { return mCompiledPS; }
+	size_t GetMemorySize() const override;
 protected:
 	bool Load(const char* fileName, class AssetCache* cache) override;
 private:
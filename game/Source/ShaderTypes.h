@@ -4,4 +4,14 @@ enum EMeshShader
 	EMS_Basic = 0,
 	EMS_Phong,
 	EMS_Skinned,
+	// Same shaders, but reading quantized vertices (see VertexQuantization.h)
+	// These stay in the same order as above, so X + EMS_BasicQuantized
+	// is the quantized version of X
+	EMS_BasicQuantized,
+	EMS_PhongQuantized,
+	EMS_SkinnedQuantized,
+	// Read their world transforms from a per-instance vertex buffer
+	// The Renderer picks these itself when it batches draws together
+	EMS_BasicInstanced,
+	EMS_PhongInstanced,
 };
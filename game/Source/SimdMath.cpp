@@ -2,9 +2,104 @@
 
 void SimdMatrix4::LoadFromQuaternion(const Quaternion& quat)
 {
-	// Sanjay: Don't have time to implement this properly
-	Matrix4 temp = Matrix4::CreateFromQuaternion(quat);
-	*this = SimdMatrix4(temp);
+	// Same result as Matrix4::CreateFromQuaternion, but built from
+	// shuffles of a handful of products rather than 27 scalar ops
+	const __m128 mask3 = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+	const __m128 one3 = _mm_setr_ps(1.0f, 1.0f, 1.0f, 0.0f);
+
+	__m128 q = _mm_loadu_ps(&quat.x);
+	__m128 q2 = _mm_add_ps(q, q);
+
+	// diag = <1 - 2yy - 2zz, 1 - 2xx - 2zz, 1 - 2xx - 2yy, 0>
+	__m128 sq2 = _mm_mul_ps(q, q2);
+	__m128 v0 = _mm_and_ps(_mm_shuffle_ps(sq2, sq2, _MM_SHUFFLER(1, 0, 0, 3)), mask3);
+	__m128 v1 = _mm_and_ps(_mm_shuffle_ps(sq2, sq2, _MM_SHUFFLER(2, 2, 1, 3)), mask3);
+	__m128 diag = _mm_sub_ps(_mm_sub_ps(one3, v0), v1);
+
+	// <2xz, 2xy, 2yz, -> and <2wy, 2wz, 2wx, ->
+	v0 = _mm_mul_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLER(0, 0, 1, 3)),
+		_mm_shuffle_ps(q2, q2, _MM_SHUFFLER(2, 1, 2, 3)));
+	v1 = _mm_mul_ps(Simd::Splat<3>(q),
+		_mm_shuffle_ps(q2, q2, _MM_SHUFFLER(1, 2, 0, 3)));
+	__m128 sum = _mm_add_ps(v0, v1);
+	__m128 diff = _mm_sub_ps(v0, v1);
+
+	// <2xy + 2wz, 2xz - 2wy, 2xy - 2wz, 2yz + 2wx>
+	v0 = _mm_shuffle_ps(sum, diff, _MM_SHUFFLER(1, 2, 0, 1));
+	v0 = _mm_shuffle_ps(v0, v0, _MM_SHUFFLER(0, 2, 3, 1));
+	// <2xz + 2wy, 2yz - 2wx, 2xz + 2wy, 2yz - 2wx>
+	v1 = _mm_shuffle_ps(sum, diff, _MM_SHUFFLER(0, 0, 2, 2));
+	v1 = _mm_shuffle_ps(v1, v1, _MM_SHUFFLER(0, 2, 0, 2));
+
+	__m128 row = _mm_shuffle_ps(diag, v0, _MM_SHUFFLER(0, 3, 0, 1));
+	mRows[0] = _mm_shuffle_ps(row, row, _MM_SHUFFLER(0, 2, 3, 1));
+
+	row = _mm_shuffle_ps(diag, v0, _MM_SHUFFLER(1, 3, 2, 3));
+	mRows[1] = _mm_shuffle_ps(row, row, _MM_SHUFFLER(2, 0, 3, 1));
+
+	mRows[2] = _mm_shuffle_ps(v1, diag, _MM_SHUFFLER(0, 1, 2, 3));
+
+	mRows[3] = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+// a x b on the first three components of each vector
+static inline __m128 Cross3(__m128 a, __m128 b)
+{
+	__m128 result = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLER(1, 2, 0, 3)),
+		_mm_shuffle_ps(b, b, _MM_SHUFFLER(2, 0, 1, 3)));
+	return _mm_sub_ps(result, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLER(2, 0, 1, 3)),
+		_mm_shuffle_ps(b, b, _MM_SHUFFLER(1, 2, 0, 3))));
+}
+
+void SimdMatrix4::InvertAffine()
+{
+	// The inverse of the upper 3x3 has the cross products of pairs
+	// of rows as its columns, divided by the determinant
+	__m128 c0 = Cross3(mRows[1], mRows[2]);
+	__m128 c1 = Cross3(mRows[2], mRows[0]);
+	__m128 c2 = Cross3(mRows[0], mRows[1]);
+	__m128 det = _mm_dp_ps(mRows[0], c0, 0x7F);
+	__m128 invDet = _mm_div_ps(_mm_set_ps1(1.0f), det);
+
+	// Zero w, then transpose the cross products into rows
+	const __m128 mask3 = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+	c0 = _mm_and_ps(_mm_mul_ps(c0, invDet), mask3);
+	c1 = _mm_and_ps(_mm_mul_ps(c1, invDet), mask3);
+	c2 = _mm_and_ps(_mm_mul_ps(c2, invDet), mask3);
+	__m128 c3 = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+	// New translation is -t * inverse(upper 3x3)
+	__m128 trans = mRows[3];
+	__m128 newTrans = _mm_mul_ps(Simd::Splat<0>(trans), c0);
+	newTrans = Simd::MulAdd(Simd::Splat<1>(trans), c1, newTrans);
+	newTrans = Simd::MulAdd(Simd::Splat<2>(trans), c2, newTrans);
+
+	mRows[0] = c0;
+	mRows[1] = c1;
+	mRows[2] = c2;
+	mRows[3] = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), newTrans);
+}
+
+void SimdMatrix4::InvertRigid()
+{
+	// Inverse rotation is just the transpose
+	__m128 r0 = mRows[0];
+	__m128 r1 = mRows[1];
+	__m128 r2 = mRows[2];
+	__m128 r3 = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+	// New translation is -t * transpose(rotation)
+	__m128 trans = mRows[3];
+	__m128 newTrans = _mm_mul_ps(Simd::Splat<0>(trans), r0);
+	newTrans = Simd::MulAdd(Simd::Splat<1>(trans), r1, newTrans);
+	newTrans = Simd::MulAdd(Simd::Splat<2>(trans), r2, newTrans);
+
+	mRows[0] = r0;
+	mRows[1] = r1;
+	mRows[2] = r2;
+	mRows[3] = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), newTrans);
 }
 
 void SimdMatrix4::Invert()
@@ -97,3 +192,80 @@ void SimdMatrix4::Invert()
 	minor3 = _mm_mul_ps(det, minor3);
 	mRows[3] = minor3;
 }
+
+void TransformPoints(const float* in, float* out, size_t count, const SimdMatrix4& mat)
+{
+	__m128 r0 = mat.mRows[0];
+	__m128 r1 = mat.mRows[1];
+	__m128 r2 = mat.mRows[2];
+	__m128 r3 = mat.mRows[3];
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* p = in + i * 3;
+		__m128 result = Simd::MulAdd(_mm_set_ps1(p[0]), r0, r3);
+		result = Simd::MulAdd(_mm_set_ps1(p[1]), r1, result);
+		result = Simd::MulAdd(_mm_set_ps1(p[2]), r2, result);
+
+		// Store xy, then z
+		float* o = out + i * 3;
+		_mm_storel_pi(reinterpret_cast<__m64*>(o), result);
+		_mm_store_ss(o + 2, _mm_movehl_ps(result, result));
+	}
+}
+
+void TransformPointsSoA(const float* inX, const float* inY, const float* inZ,
+	float* outX, float* outY, float* outZ, size_t count, const SimdMatrix4& mat)
+{
+	// Pull the 12 matrix entries we need into scalars
+	alignas(16) float m[4][4];
+	_mm_store_ps(m[0], mat.mRows[0]);
+	_mm_store_ps(m[1], mat.mRows[1]);
+	_mm_store_ps(m[2], mat.mRows[2]);
+	_mm_store_ps(m[3], mat.mRows[3]);
+
+	size_t i = 0;
+#if MATH_AVX2
+	// Eight points at a time
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 x = _mm256_loadu_ps(inX + i);
+		__m256 y = _mm256_loadu_ps(inY + i);
+		__m256 z = _mm256_loadu_ps(inZ + i);
+		for (int c = 0; c < 3; c++)
+		{
+			__m256 result = _mm256_fmadd_ps(x, _mm256_set1_ps(m[0][c]), _mm256_set1_ps(m[3][c]));
+			result = _mm256_fmadd_ps(y, _mm256_set1_ps(m[1][c]), result);
+			result = _mm256_fmadd_ps(z, _mm256_set1_ps(m[2][c]), result);
+			float* outStream = (c == 0) ? outX : ((c == 1) ? outY : outZ);
+			_mm256_storeu_ps(outStream + i, result);
+		}
+	}
+#endif
+	// Four points at a time
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(inX + i);
+		__m128 y = _mm_loadu_ps(inY + i);
+		__m128 z = _mm_loadu_ps(inZ + i);
+		for (int c = 0; c < 3; c++)
+		{
+			__m128 result = Simd::MulAdd(x, _mm_set_ps1(m[0][c]), _mm_set_ps1(m[3][c]));
+			result = Simd::MulAdd(y, _mm_set_ps1(m[1][c]), result);
+			result = Simd::MulAdd(z, _mm_set_ps1(m[2][c]), result);
+			float* outStream = (c == 0) ? outX : ((c == 1) ? outY : outZ);
+			_mm_storeu_ps(outStream + i, result);
+		}
+	}
+
+	// Leftovers
+	for (; i < count; i++)
+	{
+		float x = inX[i];
+		float y = inY[i];
+		float z = inZ[i];
+		outX[i] = x * m[0][0] + y * m[1][0] + z * m[2][0] + m[3][0];
+		outY[i] = x * m[0][1] + y * m[1][1] + z * m[2][1] + m[3][1];
+		outZ[i] = x * m[0][2] + y * m[1][2] + z * m[2][2] + m[3][2];
+	}
+}
@@ -141,38 +141,36 @@ public:
 	// Load from a Matrix4 into this SimdMatrix4
 	void FromMatrix4(const Matrix4& mat)
 	{
-		// We can't assume that mat is aligned, so
-		// we can't use mm_set_ps
-		memcpy(mRows, mat.mat, sizeof(float) * 16);
+		// We can't assume that mat is aligned
+		mRows[0] = _mm_loadu_ps(mat.mat[0]);
+		mRows[1] = _mm_loadu_ps(mat.mat[1]);
+		mRows[2] = _mm_loadu_ps(mat.mat[2]);
+		mRows[3] = _mm_loadu_ps(mat.mat[3]);
 	}
 
 	// Convert this SimdMatrix4 to a Matrix4
-	Matrix4 ToMatrix4()
+	Matrix4 ToMatrix4() const
 	{
-		return Matrix4(mRows);
+		Matrix4 retVal;
+		_mm_storeu_ps(retVal.mat[0], mRows[0]);
+		_mm_storeu_ps(retVal.mat[1], mRows[1]);
+		_mm_storeu_ps(retVal.mat[2], mRows[2]);
+		_mm_storeu_ps(retVal.mat[3], mRows[3]);
+		return retVal;
 	}
 
 	// this = this * other
 	void Mul(const SimdMatrix4& other)
 	{
-		SimdMatrix4 tempA = *this;
-		SimdMatrix4 tempB = other;
+		// Copy other's rows first in case &other == this
+		__m128 b0 = other.mRows[0];
+		__m128 b1 = other.mRows[1];
+		__m128 b2 = other.mRows[2];
+		__m128 b3 = other.mRows[3];
 
 		for (int i = 0; i < 4; i++)
 		{
-			__m128 brod0 = _mm_shuffle_ps(tempA.mRows[i], tempA.mRows[i], _MM_SHUFFLE(0, 0, 0, 0));
-			__m128 brod1 = _mm_shuffle_ps(tempA.mRows[i], tempA.mRows[i], _MM_SHUFFLE(1, 1, 1, 1));
-			__m128 brod2 = _mm_shuffle_ps(tempA.mRows[i], tempA.mRows[i], _MM_SHUFFLE(2, 2, 2, 2));
-			__m128 brod3 = _mm_shuffle_ps(tempA.mRows[i], tempA.mRows[i], _MM_SHUFFLE(3, 3, 3, 3));
-			__m128 row =
-				_mm_add_ps(
-					_mm_add_ps(
-						_mm_mul_ps(brod0, tempB.mRows[0]),
-						_mm_mul_ps(brod1, tempB.mRows[1])),
-					_mm_add_ps(
-						_mm_mul_ps(brod2, tempB.mRows[2]),
-						_mm_mul_ps(brod3, tempB.mRows[3])));
-			mRows[i] = row;
+			mRows[i] = Simd::MulRows(mRows[i], b0, b1, b2, b3);
 		}
 	}
 
@@ -286,26 +284,14 @@ public:
 	// Loads a matrix from a quaternion into this
 	void LoadFromQuaternion(const Quaternion& quat);
 
+	// Loads Scale * Rotation * Translation into this
 	void LoadTransform(float s, Vector3 trans, Quaternion q)
 	{
-		__m128 scalarVec = _mm_set_ps1(s);
+		LoadFromQuaternion(q);
 
-		mRows[0] = _mm_setr_ps(
-			1.0f - 2.0f * (q.y * q.y + q.z * q.z),
-			2.0f * (q.x * q.y + q.w * q.z),
-			2.0f * (q.x * q.z - q.w * q.y), 0.0f);
+		__m128 scalarVec = _mm_set_ps1(s);
 		mRows[0] = _mm_mul_ps(mRows[0], scalarVec);
-
-		mRows[1] = _mm_setr_ps(
-			2.0f * (q.x * q.y - q.w * q.z),
-			1.0f - 2.0f * (q.x * q.x + q.z * q.z),
-			2.0f * (q.y * q.z + q.w * q.x), 0.0f);
 		mRows[1] = _mm_mul_ps(mRows[1], scalarVec);
-
-		mRows[2] = _mm_setr_ps(
-			2.0f * (q.x * q.z + q.w * q.y),
-			2.0f * (q.y * q.z - q.w * q.x),
-			1.0f - 2.0f * (q.x * q.x + q.y * q.y), 0.0f);
 		mRows[2] = _mm_mul_ps(mRows[2], scalarVec);
 
 		mRows[3] = _mm_setr_ps(trans.x, trans.y, trans.z, 1.0f);
@@ -314,26 +300,39 @@ public:
 	// Inverts this matrix
 	void Invert();
 
+	// Inverts this matrix, assuming the last column is <0, 0, 0, 1>
+	// (any mix of scale, rotation and translation)
+	void InvertAffine();
+
+	// Inverts this matrix, assuming it's only a rotation and translation
+	// (such as a bone transform). Much cheaper than a full Invert.
+	void InvertRigid();
+
 	friend SimdVector3 Transform(const SimdVector3& vec, const class SimdMatrix4& mat, float w);
+	friend void TransformPoints(const float* in, float* out, size_t count, const SimdMatrix4& mat);
+	friend void TransformPointsSoA(const float* inX, const float* inY, const float* inZ,
+		float* outX, float* outY, float* outZ, size_t count, const SimdMatrix4& mat);
 };
 
 inline SimdVector3 Transform(const SimdVector3& vec, const SimdMatrix4& mat, float w = 1.0f)
 {	
 	// To apply a transformation to a vector, multiply vector * transformation matrix.
-
-	// transpose matrix for multiplication
-	SimdMatrix4 transformMatrix = mat;
-	transformMatrix.Transpose();
+	// Row vector times matrix is just a weighted sum of the rows, so
+	// there's no need to transpose first.
 
 	// add w-value to vector (homogeneous coordinates)
-	__m128 tempVec = _mm_insert_ps(vec.mVec, _mm_setr_ps(0.0f, 0.0f, 0.0f, w), 0xF0);
-
-	// multiply vector * transform matrix
-	__m128 result = tempVec;
-	result = _mm_insert_ps(result, _mm_dp_ps(tempVec, transformMatrix.mRows[0], 0xF8), 0xC0);
-	result = _mm_insert_ps(result, _mm_dp_ps(tempVec, transformMatrix.mRows[1], 0xF8), 0xD0);
-	result = _mm_insert_ps(result, _mm_dp_ps(tempVec, transformMatrix.mRows[2], 0xF8), 0xE0);
-	result = _mm_insert_ps(result, _mm_dp_ps(tempVec, transformMatrix.mRows[3], 0xF8), 0xF0);
+	__m128 tempVec = _mm_blend_ps(vec.mVec, _mm_set_ps1(w), 0x8);
 
-	return SimdVector3(result);
+	return SimdVector3(Simd::MulRows(tempVec,
+		mat.mRows[0], mat.mRows[1], mat.mRows[2], mat.mRows[3]));
 }
+
+// Batch transforms, for bulk work like skinning or bounds updates.
+// These treat every input as a point (w = 1), and in may equal out.
+
+// Transforms count packed xyz points (3 floats each)
+void TransformPoints(const float* in, float* out, size_t count, const SimdMatrix4& mat);
+
+// Same as above, but over separate x, y and z streams
+void TransformPointsSoA(const float* inX, const float* inY, const float* inZ,
+	float* outX, float* outY, float* outZ, size_t count, const SimdMatrix4& mat);
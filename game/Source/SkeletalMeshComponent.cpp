@@ -12,8 +12,11 @@ void SkeletalMeshComponent::Draw(class Renderer& render)
 {
 	if (mMesh)
 	{
+		size_t lodIndex = SelectLod(render);
+		const MeshLod& lod = mMesh->GetLod(lodIndex);
 		render.DrawSkeletalMesh(mMesh->GetVertexArray(), mMesh->GetTexture(mTextureIndex),
-			mOwner.GetWorldTransform(), mPalette);
+			mOwner.GetWorldTransform(), mPalette, mMesh->GetShaderType(),
+			lodIndex, lod.mStartIndex, lod.mIndexCount);
 	}
 }
 
@@ -77,7 +80,7 @@ void SkeletalMeshComponent::SetProperties(const rapidjson::Value& properties)
 void SkeletalMeshComponent::ComputeMatrixPalette()
 {
 	// Get global inverse bind poses
-	std::vector<SimdMatrix4> globalInvBindPose = mSkeleton->GetGlobalInvBindPoses();
+	const std::vector<SimdMatrix4>& globalInvBindPose = mSkeleton->GetGlobalInvBindPoses();
 
 	// Get global poses
 	std::vector<SimdMatrix4> animationPose;
@@ -96,4 +99,5 @@ void SkeletalMeshComponent::ComputeMatrixPalette()
 		mPalette.mMatrixPalette[i] = globalInvBindPose[i];
 		mPalette.mMatrixPalette[i].Mul(animationPose[i]);
 	}
+	mPalette.mNumBones = mAnimation->GetNumBones();
 }
@@ -1,6 +1,12 @@
 #include "ITPEnginePCH.h"
 #include <SDL/SDL_log.h>
 
+namespace
+{
+	// Bump this whenever the cooked layout (or the parsing) changes
+	const uint32_t kCookedSkelVersion = 1;
+}
+
 Skeleton::Skeleton(class Game& game)
 	:Asset(game)
 {
@@ -9,7 +15,7 @@ Skeleton::Skeleton(class Game& game)
 
 bool Skeleton::Load(const char* fileName, class AssetCache* cache)
 {
-	std::ifstream file(fileName);
+	std::ifstream file(fileName, std::ios::binary);
 	if (!file.is_open())
 	{
 		SDL_Log("File not found: Skeleton %s", fileName);
@@ -19,6 +25,42 @@ bool Skeleton::Load(const char* fileName, class AssetCache* cache)
 	std::stringstream fileStream;
 	fileStream << file.rdbuf();
 	std::string contents = fileStream.str();
+
+	// Try the cooked version first
+	AssetDiskCache& diskCache = cache->GetDiskCache();
+	uint64_t sourceHash = AssetDiskCache::HashContents(contents.data(), contents.size());
+	std::vector<char> cooked;
+	bool uncooked = false;
+	if (diskCache.Load("itpskel", kCookedSkelVersion, sourceHash, cooked))
+	{
+		CookedReader reader(cooked);
+		uncooked = Uncook(reader);
+		if (!uncooked)
+		{
+			SDL_Log("Skeleton %s: cooked data is corrupt, reparsing", fileName);
+		}
+	}
+
+	if (!uncooked)
+	{
+		if (!ParseJson(fileName, contents))
+		{
+			return false;
+		}
+
+		CookedWriter writer;
+		Cook(writer);
+		diskCache.Store("itpskel", kCookedSkelVersion, sourceHash, writer.GetData());
+	}
+
+	// Now that we have the bones
+	ComputeGlobalInvBindPose();
+
+	return true;
+}
+
+bool Skeleton::ParseJson(const char* fileName, const std::string& contents)
+{
 	rapidjson::StringStream jsonStr(contents.c_str());
 	rapidjson::Document doc;
 	doc.ParseStream(jsonStr);
@@ -52,6 +94,7 @@ bool Skeleton::Load(const char* fileName, class AssetCache* cache)
 
 	DbgAssert(count <= MAX_SKELETON_BONES, "Skeleton exceeds maximum allowed bones.");
 
+	mBones.clear();
 	mBones.reserve(count);
 
 	const rapidjson::Value& bones = doc["bones"];
@@ -111,16 +154,59 @@ bool Skeleton::Load(const char* fileName, class AssetCache* cache)
 		mBones.emplace_back(temp);
 	}
 
-	// Now that we have the bones
-	ComputeGlobalInvBindPose();
-
 	return true;
 }
 
+void Skeleton::Cook(CookedWriter& writer) const
+{
+	writer.Write(static_cast<uint32_t>(mBones.size()));
+	for (const auto& bone : mBones)
+	{
+		writer.Write(bone.mLocalBindPose);
+		writer.WriteString(bone.mName);
+		writer.Write(static_cast<int32_t>(bone.mParent));
+	}
+}
+
+bool Skeleton::Uncook(CookedReader& reader)
+{
+	uint32_t count = 0;
+	if (!reader.Read(count) || count == 0 || count > MAX_SKELETON_BONES)
+	{
+		return false;
+	}
+
+	mBones.resize(count);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		Bone& bone = mBones[i];
+		int32_t parent = 0;
+		if (!reader.Read(bone.mLocalBindPose) ||
+			!reader.ReadString(bone.mName) ||
+			!reader.Read(parent))
+		{
+			return false;
+		}
+
+		// ComputeGlobalInvBindPose needs every parent before its children
+		// (the root's parent is never read)
+		if (i > 0 && (parent < 0 || parent >= static_cast<int32_t>(i)))
+		{
+			return false;
+		}
+		bone.mParent = parent;
+	}
+
+	return reader.IsAtEnd();
+}
+
 void Skeleton::ComputeGlobalInvBindPose()
 {
+	mGlobalBindPoses.reserve(mBones.size());
+	mGlobalInvBindPoses.reserve(mBones.size());
+
 	// Compute global bind pose for first element
-	mGlobalInvBindPoses.emplace_back(mBones[0].mLocalBindPose.ToSimdMatrix());
+	mGlobalBindPoses.emplace_back(mBones[0].mLocalBindPose.ToSimdMatrix());
 
 	// Compute global bind pose for all other elements
 	for (unsigned int i = 1; i < mBones.size(); i++)
@@ -129,14 +215,28 @@ void Skeleton::ComputeGlobalInvBindPose()
 		SimdMatrix4 bindPoseMatrix = mBones[i].mLocalBindPose.ToSimdMatrix();
 
 		// Global bind pose
-		bindPoseMatrix.Mul(SimdMatrix4(mGlobalInvBindPoses[mBones[i].mParent]));
-		mGlobalInvBindPoses.emplace_back(bindPoseMatrix);
+		bindPoseMatrix.Mul(mGlobalBindPoses[mBones[i].mParent]);
+		mGlobalBindPoses.emplace_back(bindPoseMatrix);
 	}
 
 	// Inverse global bind poses
-	for (unsigned int i = 0; i < mGlobalInvBindPoses.size(); i++)
+	// Bind poses are only rotation and translation, so we can skip the full inverse
+	for (unsigned int i = 0; i < mGlobalBindPoses.size(); i++)
 	{
-		mGlobalInvBindPoses[i].Invert();
+		SimdMatrix4 invBindPose = mGlobalBindPoses[i];
+		invBindPose.InvertRigid();
+		mGlobalInvBindPoses.emplace_back(invBindPose);
 	}
 }
 
+size_t Skeleton::GetMemorySize() const
+{
+	size_t size = sizeof(Skeleton) + mBones.capacity() * sizeof(Bone);
+	for (const auto& bone : mBones)
+	{
+		size += bone.mName.capacity();
+	}
+	size += mGlobalBindPoses.capacity() * sizeof(SimdMatrix4);
+	size += mGlobalInvBindPoses.capacity() * sizeof(SimdMatrix4);
+	return size;
+}
@@ -17,17 +17,25 @@ public:
 	Skeleton(class Game& game);
 
 	bool Load(const char* fileName, class AssetCache* cache) override;
+	size_t GetMemorySize() const override;
 
 	size_t GetNumBones() const { return mBones.size(); }
 	const Bone& GetBone(size_t idx) const { return mBones[idx]; }
 	const std::vector<Bone>& GetBones() const { return mBones; }
 
+	const std::vector<SimdMatrix4>& GetGlobalBindPoses() const { return mGlobalBindPoses; }
 	const std::vector<SimdMatrix4>& GetGlobalInvBindPoses() const { return mGlobalInvBindPoses; }
 protected:
 	// Automatically called once the skeleton has been loaded
 	void ComputeGlobalInvBindPose();
 private:
+	// Parses the json version of the file
+	bool ParseJson(const char* fileName, const std::string& contents);
+	void Cook(class CookedWriter& writer) const;
+	bool Uncook(class CookedReader& reader);
+
 	std::vector<Bone> mBones;
+	std::vector<SimdMatrix4> mGlobalBindPoses;
 	std::vector<SimdMatrix4> mGlobalInvBindPoses;
 };
 
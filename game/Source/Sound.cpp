@@ -29,3 +29,13 @@ bool Sound::Load(const char* fileName, class AssetCache* cache)
 
 	return true;
 }
+
+size_t Sound::GetMemorySize() const
+{
+	size_t size = sizeof(Sound);
+	if (mData)
+	{
+		size += sizeof(Mix_Chunk) + mData->alen;
+	}
+	return size;
+}
@@ -9,6 +9,7 @@ public:
 	virtual ~Sound();
 
 	bool Load(const char* fileName, class AssetCache* cache) override;
+	size_t GetMemorySize() const override;
 
 	struct Mix_Chunk* GetData() { return mData; }
 private:
@@ -0,0 +1,115 @@
+#include "ITPEnginePCH.h"
+#include "SpriteBatch.h"
+
+namespace
+{
+	// Enough for a typical HUD before it has to grow
+	const size_t kInitialCapacity = 256;
+
+	// To R8G8B8A8_UNorm, with an alpha of 1
+	uint32_t PackColor(const Vector3& color)
+	{
+		uint32_t r = static_cast<uint32_t>(Math::Clamp(color.x, 0.0f, 1.0f) * 255.0f + 0.5f);
+		uint32_t g = static_cast<uint32_t>(Math::Clamp(color.y, 0.0f, 1.0f) * 255.0f + 0.5f);
+		uint32_t b = static_cast<uint32_t>(Math::Clamp(color.z, 0.0f, 1.0f) * 255.0f + 0.5f);
+		return r | (g << 8) | (b << 16) | (0xffu << 24);
+	}
+}
+
+SpriteBatch::SpriteBatch()
+	:mGraphics(nullptr)
+	,mCapacity(0)
+	,mStats()
+{
+
+}
+
+void SpriteBatch::Init(GraphicsDriver& graphics, InputLayoutPtr inputLayout)
+{
+	mGraphics = &graphics;
+	mInputLayout = inputLayout;
+
+	// Every quad is <top left, top right, bottom right>, <bottom right, bottom left, top left>
+	std::vector<uint16_t> indices(kMaxSpritesPerDraw * 6);
+	for (size_t i = 0; i < kMaxSpritesPerDraw; i++)
+	{
+		uint16_t first = static_cast<uint16_t>(i * 4);
+		indices[i * 6 + 0] = first;
+		indices[i * 6 + 1] = first + 1;
+		indices[i * 6 + 2] = first + 2;
+		indices[i * 6 + 3] = first + 2;
+		indices[i * 6 + 4] = first + 3;
+		indices[i * 6 + 5] = first;
+	}
+
+	mIndexBuffer = mGraphics->CreateGraphicsBuffer(indices.data(),
+		static_cast<int>(indices.size() * sizeof(uint16_t)),
+		EBF_IndexBuffer, ECPUAF_Neither, EGBU_Immutable);
+}
+
+void SpriteBatch::Begin()
+{
+	mVerts.clear();
+	mRuns.clear();
+}
+
+void SpriteBatch::Add(TexturePtr texture, const Matrix4& worldTransform, const Vector2& uvMin, const Vector2& uvMax,
+	const Vector3& color)
+{
+	// Start a new draw when the texture changes
+	if (mRuns.empty() || mRuns.back().mTexture != texture || mRuns.back().mCount == kMaxSpritesPerDraw)
+	{
+		Run run;
+		run.mTexture = texture;
+		run.mFirst = mVerts.size() / 4;
+		run.mCount = 0;
+		mRuns.push_back(run);
+	}
+	mRuns.back().mCount++;
+
+	uint32_t packed = PackColor(color);
+	Vertex quad[4] =
+	{
+		{ Transform(Vector3(-0.5f, 0.5f, 0.0f), worldTransform), uvMin.x, uvMin.y, packed },  // top left
+		{ Transform(Vector3(0.5f, 0.5f, 0.0f), worldTransform), uvMax.x, uvMin.y, packed },   // top right
+		{ Transform(Vector3(0.5f, -0.5f, 0.0f), worldTransform), uvMax.x, uvMax.y, packed },  // bottom right
+		{ Transform(Vector3(-0.5f, -0.5f, 0.0f), worldTransform), uvMin.x, uvMax.y, packed }, // bottom left
+	};
+	mVerts.insert(mVerts.end(), quad, quad + 4);
+}
+
+void SpriteBatch::End()
+{
+	size_t numSprites = mVerts.size() / 4;
+	mStats.mNumSprites = numSprites;
+	mStats.mNumDrawCalls = mRuns.size();
+	if (numSprites == 0)
+	{
+		return;
+	}
+
+	// Grow the buffer if it's too small for this frame
+	if (numSprites > mCapacity)
+	{
+		mCapacity = max(max(numSprites, mCapacity * 2), kInitialCapacity);
+		mVertexBuffer = mGraphics->CreateGraphicsBuffer(nullptr,
+			static_cast<int>(mCapacity * 4 * sizeof(Vertex)),
+			EBF_VertexBuffer, ECPUAF_CanWrite, EGBU_Dynamic);
+	}
+
+	// All the quads go up in one map
+	void* data = mGraphics->MapBuffer(mVertexBuffer);
+	memcpy(data, mVerts.data(), mVerts.size() * sizeof(Vertex));
+	mGraphics->UnmapBuffer(mVertexBuffer);
+
+	mGraphics->SetInputLayout(mInputLayout);
+	mGraphics->SetVertexBuffer(mVertexBuffer, sizeof(Vertex));
+	mGraphics->SetIndexBuffer(mIndexBuffer, EIF_UInt16);
+
+	// Each run indexes from the start of the index buffer, offset to its first vertex
+	for (const auto& run : mRuns)
+	{
+		run.mTexture->SetActive(0);
+		mGraphics->DrawIndexed(static_cast<int>(run.mCount * 6), 0, static_cast<int>(run.mFirst * 4));
+	}
+}
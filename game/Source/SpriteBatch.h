@@ -0,0 +1,74 @@
+// SpriteBatch.h
+// Writes sprite quads into one dynamic vertex buffer instead of drawing
+// each one on its own. Sprites in a row with the same texture go out in
+// a single draw call, so the 2D pass costs a draw per texture change
+// rather than one per sprite.
+
+#pragma once
+#include "GraphicsDriver.h"
+#include "Texture.h"
+#include <vector>
+
+class SpriteBatch
+{
+public:
+	// As many quads as 16-bit indices can address
+	static const size_t kMaxSpritesPerDraw = 16384;
+
+	// What the last End drew
+	struct Stats
+	{
+		size_t mNumSprites;
+		size_t mNumDrawCalls;
+	};
+
+	// Sprites in a row that share a texture, which End draws with one call
+	struct Run
+	{
+		TexturePtr mTexture;
+		size_t mFirst;
+		size_t mCount;
+	};
+
+	SpriteBatch();
+
+	// inputLayout has to be positiontexcoordcolor. Begin and Add work
+	// without this, so the batching can be checked without a device.
+	void Init(GraphicsDriver& graphics, InputLayoutPtr inputLayout);
+
+	void Begin();
+	// worldTransform places the unit quad, which is centered on the origin.
+	// [uvMin, uvMax] is the part of the texture it shows, and color tints it.
+	void Add(TexturePtr texture, const Matrix4& worldTransform, const Vector2& uvMin, const Vector2& uvMax,
+		const Vector3& color);
+	// Uploads the quads and draws them in the order they were added. The
+	// sprite shader has to be active, with an identity world transform
+	// (the quads are already transformed).
+	void End();
+
+	const Stats& GetStats() const { return mStats; }
+	// The draws End will make for what's been added since Begin
+	const std::vector<Run>& GetRuns() const { return mRuns; }
+private:
+	// Same layout as positiontexcoordcolor
+	struct Vertex
+	{
+		Vector3 mPos;
+		float mU;
+		float mV;
+		// RGBA, 8 bits each
+		uint32_t mColor;
+	};
+
+	GraphicsDriver* mGraphics;
+	InputLayoutPtr mInputLayout;
+	GraphicsBufferPtr mVertexBuffer;
+	// Two triangles per quad, the same for every quad
+	GraphicsBufferPtr mIndexBuffer;
+	// In sprites
+	size_t mCapacity;
+
+	std::vector<Vertex> mVerts;
+	std::vector<Run> mRuns;
+	Stats mStats;
+};
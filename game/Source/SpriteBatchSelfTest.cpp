@@ -0,0 +1,91 @@
+#include "ITPEnginePCH.h"
+#include "SelfTest.h"
+#include "SpriteBatch.h"
+#include "RenderSnapshot.h"
+
+namespace
+{
+	// The batch only compares these, so they never get used. The aliasing
+	// constructor gives a pointer that doesn't own (or touch) anything.
+	TexturePtr FakeTexture(uintptr_t id)
+	{
+		return TexturePtr(TexturePtr(), reinterpret_cast<Texture*>(0x1000 + id * 16));
+	}
+
+	// The color's red channel tags each sprite with its submission order
+	RenderSnapshot::SpriteDraw MakeSprite(uintptr_t texture, int order)
+	{
+		RenderSnapshot::SpriteDraw sprite;
+		sprite.mTexture = FakeTexture(texture);
+		sprite.mWorldTransform = Matrix4::Identity;
+		sprite.mUVMin = Vector2(0.0f, 0.0f);
+		sprite.mUVMax = Vector2(1.0f, 1.0f);
+		sprite.mColor = Vector3(static_cast<float>(order), 0.0f, 0.0f);
+		return sprite;
+	}
+
+	void AddSprites(SpriteBatch& batch, const std::vector<RenderSnapshot::SpriteDraw>& sprites)
+	{
+		batch.Begin();
+		for (const auto& sprite : sprites)
+		{
+			batch.Add(sprite.mTexture, sprite.mWorldTransform, sprite.mUVMin, sprite.mUVMax, sprite.mColor);
+		}
+	}
+}
+
+void SelfTest::RunSpriteBatchTests()
+{
+	// Begin and Add don't need a device, so there's no Init here
+	SpriteBatch batch;
+
+	// Without sorting, every texture change starts a new draw
+	const uintptr_t textures[] = { 1, 2, 1, 3, 2, 2, 1, 3 };
+	const size_t numSprites = sizeof(textures) / sizeof(textures[0]);
+	RenderSnapshot snapshot;
+	for (size_t i = 0; i < numSprites; i++)
+	{
+		snapshot.mSprites.push_back(MakeSprite(textures[i], static_cast<int>(i)));
+	}
+	AddSprites(batch, snapshot.mSprites);
+	SELF_CHECK(batch.GetRuns().size() == 7);
+
+	// Sorted, it's one draw per texture, and each texture's sprites are
+	// still in the order they came in
+	snapshot.SortSprites();
+	AddSprites(batch, snapshot.mSprites);
+	const std::vector<SpriteBatch::Run>& runs = batch.GetRuns();
+	SELF_CHECK(runs.size() == 3);
+	bool runsMatch = runs.size() == 3;
+	size_t nextFirst = 0;
+	for (size_t r = 0; r < runs.size() && runsMatch; r++)
+	{
+		runsMatch &= runs[r].mFirst == nextFirst && runs[r].mCount > 0;
+		for (size_t i = runs[r].mFirst; i < runs[r].mFirst + runs[r].mCount && runsMatch; i++)
+		{
+			runsMatch &= snapshot.mSprites[i].mTexture == runs[r].mTexture;
+		}
+		nextFirst += runs[r].mCount;
+	}
+	SELF_CHECK(runsMatch && nextFirst == numSprites);
+
+	bool keptOrder = true;
+	for (size_t i = 1; i < snapshot.mSprites.size(); i++)
+	{
+		const RenderSnapshot::SpriteDraw& prev = snapshot.mSprites[i - 1];
+		const RenderSnapshot::SpriteDraw& cur = snapshot.mSprites[i];
+		keptOrder &= prev.mTexture != cur.mTexture || prev.mColor.x < cur.mColor.x;
+	}
+	SELF_CHECK(keptOrder);
+
+	// A run that outgrows the index buffer gets split
+	std::vector<RenderSnapshot::SpriteDraw> many(SpriteBatch::kMaxSpritesPerDraw + 5, MakeSprite(1, 0));
+	AddSprites(batch, many);
+	SELF_CHECK(batch.GetRuns().size() == 2);
+	SELF_CHECK(batch.GetRuns()[0].mCount == SpriteBatch::kMaxSpritesPerDraw &&
+		batch.GetRuns()[1].mFirst == SpriteBatch::kMaxSpritesPerDraw && batch.GetRuns()[1].mCount == 5);
+
+	// Begin starts over
+	batch.Begin();
+	SELF_CHECK(batch.GetRuns().empty());
+}
@@ -31,6 +31,13 @@ bool Texture::Load(const char* fileName, class AssetCache* cache)
 	return true;
 }
 
+size_t Texture::GetMemorySize() const
+{
+	// Assume 32-bit texels plus a full mip chain (an extra third)
+	size_t texels = static_cast<size_t>(mWidth) * static_cast<size_t>(mHeight);
+	return sizeof(Texture) + texels * 4 * 4 / 3;
+}
+
 std::shared_ptr<Texture> Texture::CreateFromSurface(class Game& game, struct SDL_Surface* surface)
 {
 	TexturePtr tex = std::make_shared<Texture>(game);
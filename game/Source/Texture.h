@@ -18,10 +18,12 @@ public:
 	void SetActive(int slot);
 
 	// Helper to create a texture from an SDL surface --
-	// This should only really be used by FontComponent
+	// This should only really be used by GlyphAtlas
 	// Note: It's assumed the surface is BGRA, since that's what
 	// SDL_ttf creates
 	static std::shared_ptr<Texture> CreateFromSurface(class Game& game, struct SDL_Surface* surface);
+
+	size_t GetMemorySize() const override;
 protected:
 	bool Load(const char* fileName, class AssetCache* cache) override;
 private:
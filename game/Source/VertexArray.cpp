@@ -13,10 +13,13 @@ VertexArray::VertexArray(GraphicsDriver& graphics, InputLayoutCache& inputCache,
 	const void* verts, size_t vertCount, size_t vertSize, const std::string& inputLayoutName,
 	const void* indices, size_t indexCount, size_t indexSize)
 	:mGraphics(graphics)
+	,mPositionScale(1.0f, 1.0f, 1.0f)
+	,mPositionOffset(Vector3::Zero)
 {
 	mVertexCount = vertCount;
 	mVertexSize = vertSize;
 	mIndexCount = indexCount;
+	mIndexSize = indexSize;
 
 	// Get layout from input cache and save it in mInputLayout
 	mInputLayout = inputCache.GetLayout(inputLayoutName);
@@ -44,9 +47,15 @@ VertexArray::~VertexArray()
 
 }
 
+void VertexArray::SetPositionDequantization(const Vector3& scale, const Vector3& offset)
+{
+	mPositionScale = scale;
+	mPositionOffset = offset;
+}
+
 void VertexArray::SetActive()
 {
 	mGraphics.SetInputLayout(mInputLayout);
 	mGraphics.SetVertexBuffer(mVertexBuffer, mVertexSize);
-	mGraphics.SetIndexBuffer(mIndexBuffer);
+	mGraphics.SetIndexBuffer(mIndexBuffer, mIndexSize == 4 ? EIF_UInt32 : EIF_UInt16);
 }
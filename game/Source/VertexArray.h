@@ -25,8 +25,15 @@ public:
 	size_t GetVertexCount() const { return mVertexCount; }
 	size_t GetVertexSize() const { return mVertexSize; }
 	size_t GetIndexCount() const { return mIndexCount; }
+	size_t GetIndexSize() const { return mIndexSize; }
 	GraphicsBufferPtr GetVertexBuffer() const { return mVertexBuffer; }
 	GraphicsBufferPtr GetIndexBuffer() const { return mIndexBuffer; }
+
+	// For quantized positions: position = stored * scale + offset
+	// Defaults to a scale of one and no offset
+	void SetPositionDequantization(const Vector3& scale, const Vector3& offset);
+	const Vector3& GetPositionScale() const { return mPositionScale; }
+	const Vector3& GetPositionOffset() const { return mPositionOffset; }
 private:
 	GraphicsDriver& mGraphics;
 	GraphicsBufferPtr mVertexBuffer;
@@ -35,4 +42,7 @@ private:
 	size_t mVertexCount;
 	size_t mVertexSize;
 	size_t mIndexCount;
+	size_t mIndexSize;
+	Vector3 mPositionScale;
+	Vector3 mPositionOffset;
 };
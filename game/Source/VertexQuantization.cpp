@@ -0,0 +1,225 @@
+#include "ITPEnginePCH.h"
+#include "VertexQuantization.h"
+
+namespace
+{
+	// Layouts of the vertices before and after quantization
+	const size_t kFloatVertexSize = sizeof(float) * 8;
+	const size_t kSkinnedFloatVertexSize = sizeof(float) * 8 + 8;
+	const size_t kQuantizedVertexSize = sizeof(uint16_t) * 8;
+	const size_t kSkinnedQuantizedVertexSize = sizeof(uint16_t) * 8 + 8;
+
+	float Sign(float value)
+	{
+		return value >= 0.0f ? 1.0f : -1.0f;
+	}
+}
+
+uint16_t VertexQuantization::FloatToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint32_t sign = (bits >> 16) & 0x8000;
+	int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+	uint32_t mantissa = bits & 0x7fffff;
+
+	if (exponent >= 31)
+	{
+		// Too big (or inf/nan), so clamp to the largest half
+		return static_cast<uint16_t>(sign | 0x7bff);
+	}
+	else if (exponent <= 0)
+	{
+		if (exponent < -10)
+		{
+			// Too small even for a denormal
+			return static_cast<uint16_t>(sign);
+		}
+
+		// Denormal, with the implicit 1 made explicit
+		mantissa |= 0x800000;
+		uint32_t shift = static_cast<uint32_t>(14 - exponent);
+		uint32_t halfMantissa = mantissa >> shift;
+		// Round to nearest
+		if ((mantissa >> (shift - 1)) & 1)
+		{
+			halfMantissa++;
+		}
+		return static_cast<uint16_t>(sign | halfMantissa);
+	}
+
+	uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+	// Round to nearest (a carry into the exponent is still correct)
+	if (mantissa & 0x1000)
+	{
+		half++;
+	}
+	return static_cast<uint16_t>(half);
+}
+
+float VertexQuantization::HalfToFloat(uint16_t value)
+{
+	uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1f;
+	uint32_t mantissa = value & 0x3ff;
+
+	uint32_t bits;
+	if (exponent == 0)
+	{
+		if (mantissa == 0)
+		{
+			bits = sign;
+		}
+		else
+		{
+			// Normalize the denormal
+			exponent = 127 - 15 + 1;
+			while ((mantissa & 0x400) == 0)
+			{
+				mantissa <<= 1;
+				exponent--;
+			}
+			mantissa &= 0x3ff;
+			bits = sign | (exponent << 23) | (mantissa << 13);
+		}
+	}
+	else if (exponent == 31)
+	{
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+	}
+
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+uint16_t VertexQuantization::QuantizeUnorm16(float value, float min, float extent)
+{
+	if (extent <= 0.0f)
+	{
+		return 0;
+	}
+
+	float normalized = Math::Clamp((value - min) / extent, 0.0f, 1.0f);
+	return static_cast<uint16_t>(normalized * 65535.0f + 0.5f);
+}
+
+int16_t VertexQuantization::QuantizeSnorm16(float value)
+{
+	float clamped = Math::Clamp(value, -1.0f, 1.0f);
+	return static_cast<int16_t>(clamped * 32767.0f + (clamped >= 0.0f ? 0.5f : -0.5f));
+}
+
+Vector2 VertexQuantization::EncodeOctahedral(const Vector3& normal)
+{
+	// Project onto the octahedron |x| + |y| + |z| = 1
+	float invL1 = 1.0f / (Math::Abs(normal.x) + Math::Abs(normal.y) + Math::Abs(normal.z));
+	Vector2 result(normal.x * invL1, normal.y * invL1);
+
+	// Fold the lower half over the diagonals
+	if (normal.z < 0.0f)
+	{
+		float x = result.x;
+		result.x = (1.0f - Math::Abs(result.y)) * Sign(x);
+		result.y = (1.0f - Math::Abs(x)) * Sign(result.y);
+	}
+	return result;
+}
+
+Vector3 VertexQuantization::DecodeOctahedral(const Vector2& encoded)
+{
+	Vector3 result(encoded.x, encoded.y, 1.0f - Math::Abs(encoded.x) - Math::Abs(encoded.y));
+	if (result.z < 0.0f)
+	{
+		float x = result.x;
+		result.x = (1.0f - Math::Abs(result.y)) * Sign(x);
+		result.y = (1.0f - Math::Abs(x)) * Sign(result.y);
+	}
+	result.Normalize();
+	return result;
+}
+
+size_t VertexQuantization::GetQuantizedSize(size_t vertexSize, bool isSkinned)
+{
+	if (!isSkinned && vertexSize == kFloatVertexSize)
+	{
+		return kQuantizedVertexSize;
+	}
+	else if (isSkinned && vertexSize == kSkinnedFloatVertexSize)
+	{
+		return kSkinnedQuantizedVertexSize;
+	}
+	return 0;
+}
+
+bool VertexQuantization::QuantizeVertices(const uint8_t* vertices, size_t count, size_t vertexSize,
+	bool isSkinned, const Vector3& boundsMin, const Vector3& boundsMax,
+	std::vector<uint8_t>& outVertices, Vector3& outScale, Vector3& outOffset)
+{
+	size_t quantizedSize = GetQuantizedSize(vertexSize, isSkinned);
+	if (quantizedSize == 0)
+	{
+		return false;
+	}
+
+	Vector3 extent = boundsMax - boundsMin;
+	outOffset = boundsMin;
+	// The unorm input layout already divides by 65535
+	outScale = extent;
+	outVertices.resize(count * quantizedSize);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const uint8_t* in = vertices + i * vertexSize;
+		uint8_t* out = outVertices.data() + i * quantizedSize;
+
+		float floats[6];
+		memcpy(floats, in, sizeof(floats));
+		in += sizeof(floats);
+
+		// Position, padded out to four components
+		uint16_t pos[4];
+		pos[0] = QuantizeUnorm16(floats[0], boundsMin.x, extent.x);
+		pos[1] = QuantizeUnorm16(floats[1], boundsMin.y, extent.y);
+		pos[2] = QuantizeUnorm16(floats[2], boundsMin.z, extent.z);
+		pos[3] = 0;
+		memcpy(out, pos, sizeof(pos));
+		out += sizeof(pos);
+
+		// Normal
+		Vector3 normal(floats[3], floats[4], floats[5]);
+		if (normal.LengthSq() > 0.0f)
+		{
+			normal.Normalize();
+		}
+		else
+		{
+			normal = Vector3::UnitZ;
+		}
+		Vector2 encoded = EncodeOctahedral(normal);
+		int16_t packedNormal[2] = { QuantizeSnorm16(encoded.x), QuantizeSnorm16(encoded.y) };
+		memcpy(out, packedNormal, sizeof(packedNormal));
+		out += sizeof(packedNormal);
+
+		// Bones and weights are already bytes
+		if (isSkinned)
+		{
+			memcpy(out, in, 8);
+			out += 8;
+			in += 8;
+		}
+
+		// Texcoord
+		float tex[2];
+		memcpy(tex, in, sizeof(tex));
+		uint16_t packedTex[2] = { FloatToHalf(tex[0]), FloatToHalf(tex[1]) };
+		memcpy(out, packedTex, sizeof(packedTex));
+	}
+
+	return true;
+}
@@ -0,0 +1,42 @@
+// VertexQuantization.h
+// Packs mesh vertices into a smaller format for the GPU:
+// - Positions: 16-bit unorm, relative to the mesh's bounding box
+// - Normals: octahedral encoding in two 16-bit snorms
+// - Texcoords: half floats
+// The Quantized shader variants undo this in the vertex shader.
+// Nothing here touches the GPU, so it can be run (and tested) headless.
+
+#pragma once
+#include "Math.h"
+#include <cstdint>
+#include <vector>
+
+namespace VertexQuantization
+{
+	uint16_t FloatToHalf(float value);
+	float HalfToFloat(uint16_t value);
+
+	// Maps value in [min, min + extent] to [0, 65535]
+	uint16_t QuantizeUnorm16(float value, float min, float extent);
+	// Maps value in [-1, 1] to [-32767, 32767]
+	int16_t QuantizeSnorm16(float value);
+
+	// Encodes a unit length normal as two values in [-1, 1]
+	Vector2 EncodeOctahedral(const Vector3& normal);
+	Vector3 DecodeOctahedral(const Vector2& encoded);
+
+	// Size of a quantized vertex, given the size of the float vertex
+	// (32 bytes for position/normal/texcoord, 40 for skinned)
+	// Returns 0 if the layout isn't one we can quantize
+	size_t GetQuantizedSize(size_t vertexSize, bool isSkinned);
+
+	// Quantizes count vertices. The source layout is position (3 floats),
+	// normal (3 floats), bones and weights (8 bytes, skinned only),
+	// then texcoord (2 floats). Returns false for any other layout.
+	// outScale/outOffset turn the unorm positions back into model space:
+	// position = (quantized / 65535) * outScale + outOffset
+	// The GPU does the divide when it reads the R16G16B16A16_UNORM input.
+	bool QuantizeVertices(const uint8_t* vertices, size_t count, size_t vertexSize,
+		bool isSkinned, const Vector3& boundsMin, const Vector3& boundsMax,
+		std::vector<uint8_t>& outVertices, Vector3& outScale, Vector3& outOffset);
+}
@@ -0,0 +1,91 @@
+#include "ITPEnginePCH.h"
+#include "SelfTest.h"
+#include "VertexQuantization.h"
+
+namespace
+{
+	const int kNumVertices = 1000;
+
+	// What the Quantized vertex shaders do with a position: the
+	// R16G16B16A16_UNORM input turns it into [0, 1], then DequantizePosition
+	float DecodePosition(uint16_t quantized, float scale, float offset)
+	{
+		return (quantized / 65535.0f) * scale + offset;
+	}
+}
+
+void SelfTest::RunVertexQuantizationTests()
+{
+	Vector3 boundsMin(-120.0f, -3.5f, 0.25f);
+	Vector3 boundsMax(80.0f, 42.0f, 900.0f);
+	Vector3 extent = boundsMax - boundsMin;
+
+	// Plain float vertices: position, normal, texcoord
+	std::vector<float> floats;
+	for (int i = 0; i < kNumVertices; i++)
+	{
+		Vector3 pos = Random::GetVector(boundsMin, boundsMax);
+		// Make sure the corners themselves round trip
+		if (i == 0)
+		{
+			pos = boundsMin;
+		}
+		else if (i == 1)
+		{
+			pos = boundsMax;
+		}
+		Vector3 normal = Random::GetVector(Vector3(-1.0f, -1.0f, -1.0f), Vector3(1.0f, 1.0f, 1.0f));
+		float values[8] = { pos.x, pos.y, pos.z, normal.x, normal.y, normal.z,
+			Random::GetFloatRange(0.0f, 1.0f), Random::GetFloatRange(0.0f, 1.0f) };
+		floats.insert(floats.end(), values, values + 8);
+	}
+
+	std::vector<uint8_t> quantized;
+	Vector3 scale;
+	Vector3 offset;
+	bool quantizeWorked = VertexQuantization::QuantizeVertices(
+		reinterpret_cast<const uint8_t*>(floats.data()), kNumVertices, sizeof(float) * 8, false,
+		boundsMin, boundsMax, quantized, scale, offset);
+	SELF_CHECK(quantizeWorked);
+	if (!quantizeWorked)
+	{
+		return;
+	}
+
+	// Decoding with the shader's formula lands within half a step (plus
+	// float slop) of the original position
+	size_t quantizedSize = VertexQuantization::GetQuantizedSize(sizeof(float) * 8, false);
+	Vector3 tolerance = extent * (0.5f / 65535.0f) + Vector3(1e-4f, 1e-4f, 1e-4f);
+	bool positionsRoundTrip = true;
+	for (int i = 0; i < kNumVertices; i++)
+	{
+		uint16_t pos[4];
+		memcpy(pos, quantized.data() + i * quantizedSize, sizeof(pos));
+		const float* original = floats.data() + i * 8;
+		positionsRoundTrip &= IsNear(DecodePosition(pos[0], scale.x, offset.x), original[0], tolerance.x) &&
+			IsNear(DecodePosition(pos[1], scale.y, offset.y), original[1], tolerance.y) &&
+			IsNear(DecodePosition(pos[2], scale.z, offset.z), original[2], tolerance.z);
+	}
+	SELF_CHECK(positionsRoundTrip);
+
+	// Same thing through QuantizeUnorm16 directly, at the ends of the range
+	SELF_CHECK(VertexQuantization::QuantizeUnorm16(boundsMin.x, boundsMin.x, extent.x) == 0);
+	SELF_CHECK(VertexQuantization::QuantizeUnorm16(boundsMax.x, boundsMin.x, extent.x) == 65535);
+	SELF_CHECK(IsNear(DecodePosition(65535, scale.x, offset.x), boundsMax.x, 1e-4f));
+
+	// Normals survive octahedral encoding to within a degree or so
+	bool normalsRoundTrip = true;
+	for (int i = 0; i < kNumVertices; i++)
+	{
+		int16_t packed[2];
+		memcpy(packed, quantized.data() + i * quantizedSize + sizeof(uint16_t) * 4, sizeof(packed));
+		Vector3 decoded = VertexQuantization::DecodeOctahedral(
+			Vector2(packed[0] / 32767.0f, packed[1] / 32767.0f));
+
+		const float* original = floats.data() + i * 8;
+		Vector3 normal(original[3], original[4], original[5]);
+		normal.Normalize();
+		normalsRoundTrip &= Dot(decoded, normal) > 0.9998f;
+	}
+	SELF_CHECK(normalsRoundTrip);
+}
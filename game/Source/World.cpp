@@ -12,39 +12,121 @@ World::~World()
 
 void World::AddActor(ActorPtr actor)
 {
-	mActors.emplace(actor);
+	mSpawnCommands.emplace_back(actor);
+}
+
+void World::DestroyActor(ActorPtr actor)
+{
+	mDestroyCommands.emplace_back(actor);
 }
 
 void World::Tick(float deltaTime)
 {
-	// Tick a copy of the actor pointers, in case any actor adds more actors
-	auto actors = mActors;
-	for (auto& actor : actors)
+	// Pick up anything spawned since the last frame
+	FlushCommands();
+
+	// Nothing can add or remove from mActors until the next
+	// sync point, so it's safe to tick the list in place
+	for (auto& actor : mActors)
 	{
 		actor->TickInternal(deltaTime);
 	}
 
-	// Remove any actors that are dead
-	auto iter = mActors.begin();
-	while (iter != mActors.end())
+	UpdateTransforms();
+
+	FlushCommands();
+}
+
+void World::RemoveAllActors()
+{
+	FlushCommands();
+
+	// Drop pending transform updates first, so nothing is left pointing
+	// at the actors (queued children aren't in mActors)
+	for (Actor* actor : mTransformQueue)
 	{
-		if (!(*iter)->IsAlive())
+		if (actor)
 		{
-			(*iter)->EndPlay();
-			iter = mActors.erase(iter);
+			actor->mTransformQueued = false;
 		}
-		else
+	}
+	mTransformQueue.clear();
+
+	for (auto& actor : mActors)
+	{
+		actor->mWorldIndex = -1;
+		actor->EndPlay();
+	}
+	mActors.clear();
+	mSpawnCommands.clear();
+	mDestroyCommands.clear();
+}
+
+void World::QueueTransformUpdate(Actor* actor)
+{
+	mTransformQueue.emplace_back(actor);
+}
+
+void World::CancelTransformUpdate(Actor* actor)
+{
+	// Only happens if an actor is destroyed mid-frame, so a linear search is fine
+	for (auto& queued : mTransformQueue)
+	{
+		if (queued == actor)
 		{
-			++iter;
+			queued = nullptr;
 		}
 	}
 }
 
-void World::RemoveAllActors()
+void World::UpdateTransforms()
 {
-	for (auto& actor : mActors)
+	// OnUpdatedTransform may move other actors, so this can grow as we go
+	for (size_t i = 0; i < mTransformQueue.size(); i++)
+	{
+		Actor* actor = mTransformQueue[i];
+		if (actor)
+		{
+			actor->NotifyUpdatedTransform();
+		}
+	}
+	mTransformQueue.clear();
+}
+
+void World::FlushCommands()
+{
+	// Spawns first, so an actor that is spawned and killed
+	// in the same frame still gets a matching EndPlay
+	for (auto& actor : mSpawnCommands)
 	{
+		actor->mWorldIndex = static_cast<int>(mActors.size());
+		mActors.emplace_back(actor);
+	}
+	mSpawnCommands.clear();
+
+	// EndPlay may record more commands, so don't use iterators here
+	for (size_t i = 0; i < mDestroyCommands.size(); i++)
+	{
+		ActorPtr actor = mDestroyCommands[i];
+
+		// Child actors (and repeated requests) aren't in our list
+		int index = actor->mWorldIndex;
+		if (index < 0)
+		{
+			continue;
+		}
+
+		actor->mWorldIndex = -1;
 		actor->EndPlay();
+
+		// Swap-remove from the dense list
+		int last = static_cast<int>(mActors.size()) - 1;
+		if (index != last)
+		{
+			mActors[index] = std::move(mActors[last]);
+			mActors[index]->mWorldIndex = index;
+		}
+		mActors.pop_back();
 	}
-	mActors.clear();
+	mDestroyCommands.clear();
 }
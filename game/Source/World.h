@@ -5,7 +5,7 @@
 
 #pragma once
 #include <memory>
-#include <unordered_set>
+#include <vector>
 #include "Actor.h"
 
 class World
@@ -14,11 +14,34 @@ public:
 	World();
 	~World();
 
+	// Spawns and destroys are recorded and only applied
+	// at the sync points at the start and end of Tick
 	void AddActor(ActorPtr actor);
+	void DestroyActor(ActorPtr actor);
 
 	void Tick(float deltaTime);
 	
 	void RemoveAllActors();
+
+	// Actors with a changed transform queue themselves here, and the
+	// pass sends them each a single OnUpdatedTransform per frame
+	void QueueTransformUpdate(Actor* actor);
+	void CancelTransformUpdate(Actor* actor);
+	void UpdateTransforms();
 private:
-	std::unordered_set<ActorPtr> mActors;
+	// Applies any recorded spawn and destroy commands
+	void FlushCommands();
+
+	// Actors waiting on the transform pass. Parents always queue
+	// before their children when they're marked dirty together.
+	// Declared before the actor lists so it outlives them, since a
+	// dying actor may still cancel its update here.
+	std::vector<Actor*> mTransformQueue;
+
+	// Dense list of live actors, removed with swap-remove
+	std::vector<ActorPtr> mActors;
+
+	// Command buffers filled in between sync points
+	std::vector<ActorPtr> mSpawnCommands;
+	std::vector<ActorPtr> mDestroyCommands;
 };